@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <vector>
+#if defined(_WIN32)
+#include <direct.h>
+#endif
+#include "P528Drvr.h"
+
+/*=============================================================================
+ |
+ |  Description:  DATASET mode of the P.528 driver.  Writes one data table,
+ |                in the format of the TABLE mode, for every frequency and
+ |                time percentage of a grid.  The tables of a frequency are
+ |                evaluated as one parallel batch, so each terminal pair is
+ |                prepared once and shared by every distance and time
+ |                percentage.  A table is written under a temporary name
+ |                and renamed once complete, so that an interrupted run can
+ |                be resumed with the tables it already finished.
+ |
+ *===========================================================================*/
+
+extern p528batchfunc dllP528_BatchParallel;
+
+// Grid used when -f or -p is not given
+static const double DEFAULT_F__MHZ[] = { 125, 300, 600, 1200, 2400, 5100, 9400, 15500 };
+static const double DEFAULT_P[] = { 1, 5, 10, 50, 95 };
+
+static bool Exists(const char* path) {
+    struct stat info;
+    return stat(path, &info) == 0;
+}
+
+static int MakeDirectory(const char* path) {
+    if (Exists(path))
+        return SUCCESS;
+
+#if defined(_WIN32)
+    int rtn = _mkdir(path);
+#else
+    int rtn = mkdir(path, 0777);
+#endif
+    return (rtn == 0) ? SUCCESS : DRVRERR__DATASET_DIRECTORY;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Name of the table file of a frequency and time percentage
+ |
+ |        Input:  params        - Structure with user input parameters
+ |                f__mhz        - Frequency, in MHz
+ |                p             - Time percentage
+ |
+ |      Outputs:  file_name     - File name, in the output directory
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void GetTableFileName(const DrvrParams* params, double f__mhz, double p, char (&file_name)[512]) {
+    snprintf(file_name, sizeof(file_name), "%s/P528_%gMHz_%gpct.%s", params->out_file, f__mhz, p,
+        (params->format == FORMAT_BINARY) ? "bin" : "csv");
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes a table to a temporary file, then renames it to its
+ |                final name
+ |
+ *===========================================================================*/
+static int WriteTableFile(const DrvrParams* params, double f__mhz, double p, const double* A__db,
+    const double* A_fs__db) {
+    char file_name[512];
+    char partial_name[520];
+    GetTableFileName(params, f__mhz, p, file_name);
+    snprintf(partial_name, sizeof(partial_name), "%s.partial", file_name);
+
+    FILE* fp;
+    if (fopen_s(&fp, partial_name, (params->format == FORMAT_BINARY) ? "wb" : "w") != 0) {
+        printf_s("DrvrErr %i: Unable to write %s.\n", DRVRERR__DATASET_FILE, partial_name);
+        return DRVRERR__DATASET_FILE;
+    }
+
+    WriteTable(fp, params->format, f__mhz, p, params->T_pol, A__db, A_fs__db);
+
+    if (fclose(fp) != 0) {
+        printf_s("DrvrErr %i: Unable to write %s.\n", DRVRERR__DATASET_FILE, partial_name);
+        return DRVRERR__DATASET_FILE;
+    }
+
+    remove(file_name);  // rename() does not replace files on Windows
+    if (rename(partial_name, file_name) != 0) {
+        printf_s("DrvrErr %i: Unable to rename %s.\n", DRVRERR__DATASET_FILE, partial_name);
+        return DRVRERR__DATASET_FILE;
+    }
+
+    return SUCCESS;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes the index of the dataset, listing the table file
+ |                of each frequency and time percentage
+ |
+ *===========================================================================*/
+static int WriteIndex(const DrvrParams* params, const double* f__mhz, int f_count, const double* p, int p_count) {
+    char file_name[512];
+    snprintf(file_name, sizeof(file_name), "%s/index.csv", params->out_file);
+
+    FILE* fp;
+    if (fopen_s(&fp, file_name, "w") != 0) {
+        printf_s("DrvrErr %i: Unable to write %s.\n", DRVRERR__DATASET_FILE, file_name);
+        return DRVRERR__DATASET_FILE;
+    }
+
+    fprintf_s(fp, "f__mhz,p,T_pol,file\n");
+    for (int i = 0; i < f_count; i++) {
+        for (int k = 0; k < p_count; k++) {
+            char table_name[512];
+            GetTableFileName(params, f__mhz[i], p[k], table_name);
+
+            // relative to the index
+            fprintf_s(fp, "%g,%g,%i,%s\n", f__mhz[i], p[k], params->T_pol, table_name + strlen(params->out_file) + 1);
+        }
+    }
+
+    fclose(fp);
+    return SUCCESS;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Generates the data tables of a grid of frequencies and
+ |                time percentages
+ |
+ |        Input:  params        - Structure with user input parameters
+ |
+ |      Returns:  SUCCESS, or error code encountered
+ |
+ *===========================================================================*/
+int CallP528_DATASET(DrvrParams* params) {
+    const double* f__mhz = params->f_list__mhz;
+    int f_count = params->f_count;
+    if (f_count == 0) {
+        f__mhz = DEFAULT_F__MHZ;
+        f_count = sizeof(DEFAULT_F__MHZ) / sizeof(DEFAULT_F__MHZ[0]);
+    }
+
+    const double* p = params->p_list;
+    int p_count = params->p_count;
+    if (p_count == 0) {
+        p = DEFAULT_P;
+        p_count = sizeof(DEFAULT_P) / sizeof(DEFAULT_P[0]);
+    }
+
+    if (MakeDirectory(params->out_file) != SUCCESS) {
+        printf_s("DrvrErr %i: Unable to create the output directory %s.\n", DRVRERR__DATASET_DIRECTORY, params->out_file);
+        return DRVRERR__DATASET_DIRECTORY;
+    }
+
+    int rtn = WriteIndex(params, f__mhz, f_count, p, p_count);
+    if (rtn)
+        return rtn;
+
+    std::vector<double> d__km, h_1__meter, h_2__meter, f__mhz_paths, p_paths;
+    std::vector<int> T_pol;
+    std::vector<double> A__db, A_fs__db;
+
+    double total_seconds = 0;
+    int total_paths = 0;
+
+    for (int i = 0; i < f_count; i++) {
+        // time percentages of this frequency still to be written
+        std::vector<double> p_todo;
+        for (int k = 0; k < p_count; k++) {
+            char file_name[512];
+            GetTableFileName(params, f__mhz[i], p[k], file_name);
+
+            if (!params->is_resume || !Exists(file_name))
+                p_todo.push_back(p[k]);
+        }
+
+        if (p_todo.empty()) {
+            printf_s("%g MHz: all %i tables already written\n", f__mhz[i], p_count);
+            continue;
+        }
+
+        // one batch for every table of the frequency, table after table
+        int n = (int)p_todo.size() * TABLE_PATHS;
+        d__km.resize(n);
+        h_1__meter.resize(n);
+        h_2__meter.resize(n);
+        f__mhz_paths.resize(n);
+        T_pol.resize(n);
+        p_paths.resize(n);
+        A__db.resize(n);
+        A_fs__db.resize(n);
+
+        for (size_t k = 0; k < p_todo.size(); k++) {
+            int offset = (int)k * TABLE_PATHS;
+            GetTablePaths(f__mhz[i], p_todo[k], params->T_pol, &d__km[offset], &h_1__meter[offset],
+                &h_2__meter[offset], &f__mhz_paths[offset], &T_pol[offset], &p_paths[offset]);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        rtn = dllP528_BatchParallel(n, d__km.data(), h_1__meter.data(), h_2__meter.data(), f__mhz_paths.data(),
+            T_pol.data(), p_paths.data(), A__db.data(), A_fs__db.data(), nullptr, nullptr, nullptr, nullptr, 1);
+        auto stop = std::chrono::steady_clock::now();
+
+        // no table of the frequency is written, so that -resume evaluates them again
+        if (rtn != SUCCESS && rtn != SUCCESS_WITH_WARNINGS) {
+            printf_s("P.528 Returned Error Code: %i, at %g MHz\n", rtn, f__mhz[i]);
+            return rtn;
+        }
+
+        for (size_t k = 0; k < p_todo.size(); k++) {
+            int offset = (int)k * TABLE_PATHS;
+            rtn = WriteTableFile(params, f__mhz[i], p_todo[k], &A__db[offset], &A_fs__db[offset]);
+            if (rtn)
+                return rtn;
+        }
+
+        double seconds = std::chrono::duration<double>(stop - start).count();
+        total_seconds += seconds;
+        total_paths += n;
+
+        printf_s("%g MHz: wrote %i of %i tables\n", f__mhz[i], (int)p_todo.size(), p_count);
+        PrintThroughput(stdout, n, seconds);
+    }
+
+    PrintThroughput(stdout, total_paths, total_seconds);
+
+    return SUCCESS;
+}
\ No newline at end of file
@@ -1,27 +1,39 @@
 #include <ctime>
+#include <chrono>
+#include <vector>
 #include <iostream>
+#include <stdlib.h>
 #include <string.h>
+#if defined(_WIN32)
 #include <Windows.h>
+#endif
 #include "P528Drvr.h"
 
 /*=============================================================================
  |
  |  Description:  This driver allows the user to execute the P.528 model
- |                DLL and generate results.  For full details and examples
- |                on how to use it, please see the readme.txt file.
+ |                DLL and generate results.  On Windows, the DLL is loaded
+ |                at run time.  Elsewhere, the driver is linked against the
+ |                P.528 library.  For full details and examples on how to
+ |                use it, please see the readme.txt file.
  |
  *===========================================================================*/
 
  // Local globals
+#if defined(_WIN32)
 HINSTANCE hLib;
+#endif
 p528func dllP528;
+p528batchfunc dllP528_BatchParallel;
+p528threadsfunc dllP528_SetThreadCount;
+p528curvefunc dllP528_AdaptiveCurve;
 
 int dllVerMajor = NOT_SET;
 int dllVerMinor = NOT_SET;
 int drvrVerMajor = NOT_SET;
 int drvrVerMinor = NOT_SET;
 
-wchar_t buf[TIME_SIZE];
+char buf[TIME_SIZE];
 
 /*=============================================================================
  |
@@ -34,7 +46,11 @@ int main(int argc, char** argv) {
 
     // Get the time
     time_t t = time(NULL);
-    _wctime_s(buf, TIME_SIZE, &t);
+#if defined(_WIN32)
+    ctime_s(buf, TIME_SIZE, &t);
+#else
+    ctime_r(&t, buf);
+#endif
 
     rtn = ParseArguments(argc, argv, &params);
     if (rtn == DRVR__RETURN_SUCCESS)
@@ -58,29 +74,44 @@ int main(int argc, char** argv) {
     if (rtn)
         return rtn;
 
+    rtn = dllP528_SetThreadCount(params.threads);
+    if (rtn)
+        return rtn;
+
     switch (params.mode) {
     case MODE_POINT:
         rtn = CallP528_POINT(&params);
         break;
     case MODE_CURVE:
-        rtn = CallP528_CURVE(&params);
+        if (params.tolerance__db == NOT_SET)
+            rtn = CallP528_CURVE(&params);
+        else
+            rtn = CallP528_AdaptiveCURVE(&params);
         break;
     case MODE_TABLE:
         rtn = CallP528_TABLE(&params);
         break;
+    case MODE_STREAM:
+        rtn = CallP528_STREAM(&params);
+        break;
+    case MODE_DATASET:
+        rtn = CallP528_DATASET(&params);
+        break;
     case MODE_VERSION:
         printf_s("*******************************************************\n");
         printf_s("Institute for Telecommunications Sciences - Boulder, CO\n");
         printf_s("\tP.528 Driver Version: %i.%i\n", drvrVerMajor, drvrVerMinor);
         printf_s("\tP.528 DLL Version: %i.%i\n", dllVerMajor, dllVerMinor);
-        wprintf_s(L"Time: %s", buf);
+        printf_s("Time: %s", buf);
         printf_s("*******************************************************\n");
         break;
     default:
         Help();
     }
 
+#if defined(_WIN32)
     FreeModule(hLib);
+#endif
 
     return rtn;
 }
@@ -97,81 +128,132 @@ int main(int argc, char** argv) {
  |
  *===========================================================================*/
 int CallP528_TABLE(DrvrParams* params) {
-    Result result;
-
     FILE* fp;
-    int err = fopen_s(&fp, params->out_file, "w");
+    int err = fopen_s(&fp, params->out_file, (params->format == FORMAT_BINARY) ? "wb" : "w");
     if (err != 0) {
         printf_s("Error opening output file.  Exiting.\n");
         return err;
     }
     else {
-        fprintf_s(fp, "%fMHz / Lb(%f) dB\n", params->f__mhz, params->p);
-        fprintf_s(fp, ",h2(m),1000,1000,1000,1000,1000,10000,10000,10000,10000,10000,10000,20000,20000,20000,20000,20000,20000,20000\n");
-        fprintf_s(fp, ",h1(m),1.5,15,30,60,1000,1.5,15,30,60,1000,10000,1.5,15,30,60,1000,10000,20000\n");
-        fprintf_s(fp, "D (km),FSL\n");
-
-        for (int d__km = 0; d__km < CURVE_POINTS; d__km++) {
-            fprintf_s(fp, "%i", d__km);
-
-            dllP528(d__km, 1.5, 1000, params->f__mhz, params->T_pol, params->p, &result);    // FSL
-            fprintf_s(fp, ",%.3f", result.A_fs__db);
-            fprintf_s(fp, ",%.3f", result.A__db);
-
-            dllP528(d__km, 15, 1000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
+        // the whole table is evaluated as one batch
+        std::vector<double> d__km(TABLE_PATHS), h_1__meter(TABLE_PATHS), h_2__meter(TABLE_PATHS);
+        std::vector<double> f__mhz(TABLE_PATHS), p(TABLE_PATHS);
+        std::vector<int> T_pol(TABLE_PATHS);
+        std::vector<double> A__db(TABLE_PATHS), A_fs__db(TABLE_PATHS);
 
-            dllP528(d__km, 30, 1000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
+        GetTablePaths(params->f__mhz, params->p, params->T_pol, d__km.data(), h_1__meter.data(), h_2__meter.data(),
+            f__mhz.data(), T_pol.data(), p.data());
 
-            dllP528(d__km, 60, 1000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
+        auto start = std::chrono::steady_clock::now();
+        dllP528_BatchParallel(TABLE_PATHS, d__km.data(), h_1__meter.data(), h_2__meter.data(), f__mhz.data(),
+            T_pol.data(), p.data(), A__db.data(), A_fs__db.data(), nullptr, nullptr, nullptr, nullptr, 1);
+        auto stop = std::chrono::steady_clock::now();
 
-            dllP528(d__km, 1000, 1000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
+        WriteTable(fp, params->format, params->f__mhz, params->p, params->T_pol, A__db.data(), A_fs__db.data());
 
-            dllP528(d__km, 1.5, 10000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
-
-            dllP528(d__km, 15, 10000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
-
-            dllP528(d__km, 30, 10000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
-
-            dllP528(d__km, 60, 10000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
-
-            dllP528(d__km, 1000, 10000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
-
-            dllP528(d__km, 10000, 10000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
-
-            dllP528(d__km, 1.5, 20000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
-
-            dllP528(d__km, 15, 20000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
-
-            dllP528(d__km, 30, 20000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
+        fclose(fp);
 
-            dllP528(d__km, 60, 20000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
+        PrintThroughput(stdout, TABLE_PATHS, std::chrono::duration<double>(stop - start).count());
+    }
 
-            dllP528(d__km, 1000, 20000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
+    return SUCCESS;
+}
 
-            dllP528(d__km, 10000, 20000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f", result.A__db);
+/*=============================================================================
+ |
+ |  Description:  Lays out the paths of a data table, row by row, as the
+ |                inputs of a batch.  Each row is a distance, from 0 to
+ |                CURVE_POINTS - 1 km, and each column a pair of terminal
+ |                heights.
+ |
+ |        Input:  f__mhz        - Frequency, in MHz
+ |                p             - Time percentage
+ |                T_pol         - Polarization
+ |
+ |      Outputs:  d__km, h_1__meter, h_2__meter, f__mhz_out, T_pol_out,
+ |                p_out         - Batch inputs, TABLE_PATHS of each
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void GetTablePaths(double f__mhz, double p, int T_pol, double* d__km, double* h_1__meter, double* h_2__meter,
+    double* f__mhz_out, int* T_pol_out, double* p_out) {
+    // terminal heights of the table columns
+    const double h_1__columns[TABLE_COLUMNS] = { 1.5, 15, 30, 60, 1000, 1.5, 15, 30, 60, 1000, 10000, 1.5, 15, 30, 60, 1000, 10000, 20000 };
+    const double h_2__columns[TABLE_COLUMNS] = { 1000, 1000, 1000, 1000, 1000, 10000, 10000, 10000, 10000, 10000, 10000, 20000, 20000, 20000, 20000, 20000, 20000, 20000 };
+
+    for (int i = 0; i < CURVE_POINTS; i++) {
+        for (int j = 0; j < TABLE_COLUMNS; j++) {
+            int k = i * TABLE_COLUMNS + j;
+
+            d__km[k] = i;
+            h_1__meter[k] = h_1__columns[j];
+            h_2__meter[k] = h_2__columns[j];
+            f__mhz_out[k] = f__mhz;
+            T_pol_out[k] = T_pol;
+            p_out[k] = p;
+        }
+    }
+}
 
-            dllP528(d__km, 20000, 20000, params->f__mhz, params->T_pol, params->p, &result);
-            fprintf_s(fp, ",%.3f\n", result.A__db);
+/*=============================================================================
+ |
+ |  Description:  Writes a data table, evaluated from the paths laid out by
+ |                GetTablePaths()
+ |
+ |        Input:  fp            - Output file
+ |                format        - Output format (CSV, BINARY)
+ |                f__mhz        - Frequency, in MHz
+ |                p             - Time percentage
+ |                T_pol         - Polarization
+ |                A__db         - Basic transmission loss of each path
+ |                A_fs__db      - Free space loss of each path
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void WriteTable(FILE* fp, int format, double f__mhz, double p, int T_pol, const double* A__db, const double* A_fs__db) {
+    Writer writer;
+    OpenWriter(&writer, fp);
+
+    if (format == FORMAT_BINARY) {
+        // distance, FSL, then the loss of each column
+        BinaryHeader header = { { 'P', '5', '2', '8' }, MODE_TABLE, SUCCESS, CURVE_POINTS, TABLE_COLUMNS + 2,
+            T_pol, f__mhz, p, NOT_SET, NOT_SET };
+        WriteBinary(&writer, &header, sizeof(header));
+
+        for (int d = 0; d < CURVE_POINTS; d++) {
+            double row[TABLE_COLUMNS + 2];
+            row[0] = d;
+            row[1] = A_fs__db[d * TABLE_COLUMNS];
+            for (int j = 0; j < TABLE_COLUMNS; j++)
+                row[j + 2] = A__db[d * TABLE_COLUMNS + j];
+            WriteBinary(&writer, row, sizeof(row));
+        }
+    }
+    else {
+        WriteFixed(&writer, f__mhz, 6);
+        WriteText(&writer, "MHz / Lb(");
+        WriteFixed(&writer, p, 6);
+        WriteText(&writer, ") dB\n");
+        WriteText(&writer, ",h2(m),1000,1000,1000,1000,1000,10000,10000,10000,10000,10000,10000,20000,20000,20000,20000,20000,20000,20000\n");
+        WriteText(&writer, ",h1(m),1.5,15,30,60,1000,1.5,15,30,60,1000,10000,1.5,15,30,60,1000,10000,20000\n");
+        WriteText(&writer, "D (km),FSL\n");
+
+        for (int d = 0; d < CURVE_POINTS; d++) {
+            WriteInt(&writer, d);
+
+            WriteChar(&writer, ',');
+            WriteFixed(&writer, A_fs__db[d * TABLE_COLUMNS], 3);    // FSL, of the first column
+            for (int j = 0; j < TABLE_COLUMNS; j++) {
+                WriteChar(&writer, ',');
+                WriteFixed(&writer, A__db[d * TABLE_COLUMNS + j], 3);
+            }
+            WriteChar(&writer, '\n');
         }
     }
 
-    return SUCCESS;
+    CloseWriter(&writer);
 }
 
 /*=============================================================================
@@ -184,75 +266,227 @@ int CallP528_TABLE(DrvrParams* params) {
  |
  *===========================================================================*/
 int CallP528_CURVE(DrvrParams* params) {
-    Result result;
     int rtn;
 
+    double d__km[CURVE_POINTS];
     double A__dbs[CURVE_POINTS];
     double A_fs__dbs[CURVE_POINTS];
     int warnings[CURVE_POINTS];
 
-    // Gather data points
-    for (int d__km = 0; d__km < CURVE_POINTS; d__km++) {
-        rtn = dllP528(d__km, params->h_1__meter, params->h_2__meter, params->f__mhz, params->T_pol, params->p, &result);
+    for (int i = 0; i < CURVE_POINTS; i++)
+        d__km[i] = i;
 
-        A__dbs[d__km] = result.A__db;
-        A_fs__dbs[d__km] = result.A_fs__db;
-        warnings[d__km] = result.warnings;
+    std::vector<double> h_1__meter(CURVE_POINTS, params->h_1__meter), h_2__meter(CURVE_POINTS, params->h_2__meter);
+    std::vector<double> f__mhz(CURVE_POINTS, params->f__mhz), p(CURVE_POINTS, params->p);
+    std::vector<int> T_pol(CURVE_POINTS, params->T_pol);
 
-        if (rtn != SUCCESS && rtn != SUCCESS_WITH_WARNINGS)
-            break;
-    }
+    // Gather data points, as one batch sharing the terminal geometries.  The batch returns the error of the first
+    // distance that failed
+    auto start = std::chrono::steady_clock::now();
+    rtn = dllP528_BatchParallel(CURVE_POINTS, d__km, h_1__meter.data(), h_2__meter.data(), f__mhz.data(), T_pol.data(),
+        p.data(), A__dbs, A_fs__dbs, nullptr, nullptr, warnings, nullptr, 1);
+    auto stop = std::chrono::steady_clock::now();
 
     // Print results to file
     FILE* fp;
-    int err = fopen_s(&fp, params->out_file, "w");
+    int err = fopen_s(&fp, params->out_file, (params->format == FORMAT_BINARY) ? "wb" : "w");
     if (err != 0) {
         printf("Error opening output file.  Exiting.\n");
         return err;
     }
     else {
-        fprintf_s(fp, "p528_x86.dll Version,%i.%i\n", dllVerMajor, dllVerMinor);
-        fprintf_s(fp, "P528Drvr_x86.exe Version,%i.%i\n", drvrVerMajor, drvrVerMinor);
-        fwprintf_s(fp, L"Date Generated,%s", buf);
-        fprintf_s(fp, "\n");
-        fprintf_s(fp, "Inputs\n");
-        fprintf_s(fp, "h_1__meter,%f\n", params->h_1__meter);
-        fprintf_s(fp, "h_2__meter,%f\n", params->h_2__meter);
-        fprintf_s(fp, "f__mhz,%f\n", params->f__mhz);
-        fprintf_s(fp, "p,%f\n", params->p);
-        fprintf_s(fp, "T_pol,%i\n", params->T_pol);
-        fprintf_s(fp, "\n");
+        Writer writer;
+        OpenWriter(&writer, fp);
 
-        if (rtn != SUCCESS && rtn != SUCCESS_WITH_WARNINGS) {
-            fprintf_s(fp, "P.528 returned error,%i\n", rtn);
+        bool is_error = (rtn != SUCCESS && rtn != SUCCESS_WITH_WARNINGS);
+
+        if (params->format == FORMAT_BINARY) {
+            // distance, FSL, loss and warnings
+            BinaryHeader header = { { 'P', '5', '2', '8' }, MODE_CURVE, rtn, is_error ? 0 : CURVE_POINTS, 4,
+                params->T_pol, params->f__mhz, params->p, params->h_1__meter, params->h_2__meter };
+            WriteBinary(&writer, &header, sizeof(header));
+
+            for (int i = 0; i < header.rows; i++) {
+                double row[4] = { d__km[i], A_fs__dbs[i], A__dbs[i], (double)warnings[i] };
+                WriteBinary(&writer, row, sizeof(row));
+            }
         }
         else {
-            fprintf_s(fp, "Results\n");
+            WriteText(&writer, LIB_NAME " Version,");
+            WriteInt(&writer, dllVerMajor);
+            WriteChar(&writer, '.');
+            WriteInt(&writer, dllVerMinor);
+            WriteText(&writer, "\n" DRVR_NAME " Version,");
+            WriteInt(&writer, drvrVerMajor);
+            WriteChar(&writer, '.');
+            WriteInt(&writer, drvrVerMinor);
+            WriteText(&writer, "\nDate Generated,");
+            WriteText(&writer, buf);
+            WriteText(&writer, "\n");
+            WriteText(&writer, "Inputs\n");
+            WriteText(&writer, "h_1__meter,");
+            WriteFixed(&writer, params->h_1__meter, 6);
+            WriteText(&writer, "\nh_2__meter,");
+            WriteFixed(&writer, params->h_2__meter, 6);
+            WriteText(&writer, "\nf__mhz,");
+            WriteFixed(&writer, params->f__mhz, 6);
+            WriteText(&writer, "\np,");
+            WriteFixed(&writer, params->p, 6);
+            WriteText(&writer, "\nT_pol,");
+            WriteInt(&writer, params->T_pol);
+            WriteText(&writer, "\n\n");
+
+            if (is_error) {
+                WriteText(&writer, "P.528 returned error,");
+                WriteInt(&writer, rtn);
+                WriteChar(&writer, '\n');
+            }
+            else {
+                WriteText(&writer, "Results\n");
 
-            fprintf_s(fp, "Distance (km)");
-            for (int d__km = 0; d__km < CURVE_POINTS; d__km++)
-                fprintf_s(fp, ",%i", d__km);
-            fprintf_s(fp, "\n");
+                WriteText(&writer, "Distance (km)");
+                for (int i = 0; i < CURVE_POINTS; i++) {
+                    WriteChar(&writer, ',');
+                    WriteInt(&writer, i);
+                }
+                WriteChar(&writer, '\n');
 
-            fprintf_s(fp, "Free Space Loss (dB),%.3f", A_fs__dbs[0]);
-            for (int i = 1; i < CURVE_POINTS; i++)
-                fprintf_s(fp, ",%.3f", A_fs__dbs[i]);
-            fprintf_s(fp, "\n");
+                WriteText(&writer, "Free Space Loss (dB)");
+                for (int i = 0; i < CURVE_POINTS; i++) {
+                    WriteChar(&writer, ',');
+                    WriteFixed(&writer, A_fs__dbs[i], 3);
+                }
+                WriteChar(&writer, '\n');
 
-            fprintf_s(fp, "Basic Transmission Loss (dB),%.3f", A__dbs[0]);
-            for (int i = 1; i < CURVE_POINTS; i++)
-                fprintf_s(fp, ",%.3f", A__dbs[i]);
-            fprintf_s(fp, "\n");
+                WriteText(&writer, "Basic Transmission Loss (dB)");
+                for (int i = 0; i < CURVE_POINTS; i++) {
+                    WriteChar(&writer, ',');
+                    WriteFixed(&writer, A__dbs[i], 3);
+                }
+                WriteChar(&writer, '\n');
 
-            fprintf_s(fp, "Warnings,0x%x", warnings[0]);
-            for (int i = 1; i < CURVE_POINTS; i++)
-                fprintf_s(fp, ",0x%x", warnings[i]);
-            fprintf_s(fp, "\n");
+                WriteText(&writer, "Warnings");
+                for (int i = 0; i < CURVE_POINTS; i++) {
+                    WriteChar(&writer, ',');
+                    WriteHex(&writer, warnings[i]);
+                }
+                WriteChar(&writer, '\n');
+            }
         }
 
+        CloseWriter(&writer);
         fclose(fp);
+
+        PrintThroughput(stdout, CURVE_POINTS, std::chrono::duration<double>(stop - start).count());
+    }
+
+    return rtn;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Generates an adaptive P.528 loss-vs-distance curve, from 0
+ |                to CURVE_POINTS - 1 km, with distances chosen so that
+ |                linear interpolation is within the -tol tolerance
+ |
+ |        Input:  params        - Structure with user input parameters
+ |
+ |      Returns:  P.528 DLL return code
+ |
+ *===========================================================================*/
+int CallP528_AdaptiveCURVE(DrvrParams* params) {
+    std::vector<double> d__km(ADAPTIVE_CURVE_POINTS), A__db(ADAPTIVE_CURVE_POINTS);
+    int points, warnings;
+
+    auto start = std::chrono::steady_clock::now();
+    int rtn = dllP528_AdaptiveCurve(params->h_1__meter, params->h_2__meter, params->f__mhz, params->T_pol, params->p,
+        CURVE_POINTS - 1, params->tolerance__db, ADAPTIVE_CURVE_POINTS, d__km.data(), A__db.data(), &points, &warnings);
+    auto stop = std::chrono::steady_clock::now();
+
+    FILE* fp;
+    int err = fopen_s(&fp, params->out_file, (params->format == FORMAT_BINARY) ? "wb" : "w");
+    if (err != 0) {
+        printf("Error opening output file.  Exiting.\n");
+        return err;
+    }
+
+    Writer writer;
+    OpenWriter(&writer, fp);
+
+    bool is_error = (rtn != SUCCESS && rtn != SUCCESS_WITH_WARNINGS);
+
+    if (params->format == FORMAT_BINARY) {
+        // distance and loss
+        BinaryHeader header = { { 'P', '5', '2', '8' }, MODE_CURVE, rtn, is_error ? 0 : points, 2,
+            params->T_pol, params->f__mhz, params->p, params->h_1__meter, params->h_2__meter };
+        WriteBinary(&writer, &header, sizeof(header));
+
+        for (int i = 0; i < header.rows; i++) {
+            double row[2] = { d__km[i], A__db[i] };
+            WriteBinary(&writer, row, sizeof(row));
+        }
+    }
+    else {
+        WriteText(&writer, LIB_NAME " Version,");
+        WriteInt(&writer, dllVerMajor);
+        WriteChar(&writer, '.');
+        WriteInt(&writer, dllVerMinor);
+        WriteText(&writer, "\n" DRVR_NAME " Version,");
+        WriteInt(&writer, drvrVerMajor);
+        WriteChar(&writer, '.');
+        WriteInt(&writer, drvrVerMinor);
+        WriteText(&writer, "\nDate Generated,");
+        WriteText(&writer, buf);
+        WriteText(&writer, "\n");
+        WriteText(&writer, "Inputs\n");
+        WriteText(&writer, "h_1__meter,");
+        WriteFixed(&writer, params->h_1__meter, 6);
+        WriteText(&writer, "\nh_2__meter,");
+        WriteFixed(&writer, params->h_2__meter, 6);
+        WriteText(&writer, "\nf__mhz,");
+        WriteFixed(&writer, params->f__mhz, 6);
+        WriteText(&writer, "\np,");
+        WriteFixed(&writer, params->p, 6);
+        WriteText(&writer, "\nT_pol,");
+        WriteInt(&writer, params->T_pol);
+        WriteText(&writer, "\ntolerance__db,");
+        WriteFixed(&writer, params->tolerance__db, 6);
+        WriteText(&writer, "\n\n");
+
+        if (is_error) {
+            WriteText(&writer, "P.528 returned error,");
+            WriteInt(&writer, rtn);
+            WriteChar(&writer, '\n');
+        }
+        else {
+            WriteText(&writer, "Results\n");
+
+            // distances are bisected down to 1 meter
+            WriteText(&writer, "Distance (km)");
+            for (int i = 0; i < points; i++) {
+                WriteChar(&writer, ',');
+                WriteFixed(&writer, d__km[i], 4);
+            }
+            WriteChar(&writer, '\n');
+
+            WriteText(&writer, "Basic Transmission Loss (dB)");
+            for (int i = 0; i < points; i++) {
+                WriteChar(&writer, ',');
+                WriteFixed(&writer, A__db[i], 3);
+            }
+            WriteChar(&writer, '\n');
+
+            WriteText(&writer, "Warnings,");
+            WriteHex(&writer, warnings);
+            WriteChar(&writer, '\n');
+        }
     }
 
+    CloseWriter(&writer);
+    fclose(fp);
+
+    PrintThroughput(stdout, points, std::chrono::duration<double>(stop - start).count());
+
     return rtn;
 }
 
@@ -291,9 +525,9 @@ int CallP528_POINT(DrvrParams* params) {
             return err;
         }
         else {
-            fprintf_s(fp, "p528_x86.dll Version,%i.%i\n", dllVerMajor, dllVerMinor);
-            fprintf_s(fp, "P528Drvr_x86.exe Version,%i.%i\n", drvrVerMajor, drvrVerMinor);
-            fwprintf_s(fp, L"Date Generated,%s", buf);
+            fprintf_s(fp, LIB_NAME " Version,%i.%i\n", dllVerMajor, dllVerMinor);
+            fprintf_s(fp, DRVR_NAME " Version,%i.%i\n", drvrVerMajor, drvrVerMinor);
+            fprintf_s(fp, "Date Generated,%s", buf);
             fprintf_s(fp, "\n");
             fprintf_s(fp, "Inputs\n");
             fprintf_s(fp, "h_1__meter,%f\n", params->h_1__meter);
@@ -322,6 +556,22 @@ int CallP528_POINT(DrvrParams* params) {
     return rtn;
 }
 
+/*=============================================================================
+ |
+ |  Description:  Prints the wall-clock throughput of a CURVE, TABLE or
+ |                STREAM run
+ |
+ |        Input:  fp            - Stream to print to
+ |                n             - Number of paths evaluated
+ |                seconds       - Wall-clock time of the evaluation, in sec
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void PrintThroughput(FILE* fp, int n, double seconds) {
+    fprintf_s(fp, "Evaluated %i paths in %.3f s (%.0f paths/s)\n", n, seconds, (seconds > 0) ? n / seconds : 0);
+}
+
 /*=============================================================================
  |
  |  Description:  Loads the P.528 DLL
@@ -332,7 +582,8 @@ int CallP528_POINT(DrvrParams* params) {
  |
  *===========================================================================*/
 int LoadDLL() {
-    hLib = LoadLibrary(TEXT("p528_x86.dll"));
+#if defined(_WIN32)
+    hLib = LoadLibrary(TEXT(LIB_NAME));
 
     if (hLib == NULL)
         return DRVRERR__DLL_LOADING;
@@ -344,12 +595,27 @@ int LoadDLL() {
 
     // Grab the functions in the DLL
     dllP528 = (p528func)GetProcAddress((HMODULE)hLib, "P528");
-    if (dllP528 == nullptr)
+    dllP528_BatchParallel = (p528batchfunc)GetProcAddress((HMODULE)hLib, "P528_BatchParallel");
+    dllP528_SetThreadCount = (p528threadsfunc)GetProcAddress((HMODULE)hLib, "P528_SetThreadCount");
+    dllP528_AdaptiveCurve = (p528curvefunc)GetProcAddress((HMODULE)hLib, "P528_AdaptiveCurve");
+    if (dllP528 == nullptr || dllP528_BatchParallel == nullptr || dllP528_SetThreadCount == nullptr ||
+        dllP528_AdaptiveCurve == nullptr)
         return DRVRERR__GETP528_FUNC_LOADING;
+#else
+    // the library is linked in, and shares the version of the driver
+    dllP528 = P528;
+    dllP528_BatchParallel = P528_BatchParallel;
+    dllP528_SetThreadCount = P528_SetThreadCount;
+    dllP528_AdaptiveCurve = P528_AdaptiveCurve;
+
+    dllVerMajor = drvrVerMajor = VERSION_MAJOR;
+    dllVerMinor = drvrVerMinor = VERSION_MINOR;
+#endif
 
     return SUCCESS;
 }
 
+#if defined(_WIN32)
 /*=============================================================================
  |
  |  Description:  Get the version information of the P.528 DLL
@@ -363,13 +629,13 @@ void GetDLLVersionInfo() {
     DWORD  verHandle = NULL;
     UINT   size = 0;
     LPBYTE lpBuffer = NULL;
-    DWORD  verSize = GetFileVersionInfoSize(TEXT("p528_x86.dll"), &verHandle);
+    DWORD  verSize = GetFileVersionInfoSize(TEXT(LIB_NAME), &verHandle);
 
     if (verSize != NULL)
     {
         LPSTR verData = new char[verSize];
 
-        if (GetFileVersionInfo(TEXT("p528_x86.dll"), verHandle, verSize, verData))
+        if (GetFileVersionInfo(TEXT(LIB_NAME), verHandle, verSize, verData))
         {
             if (VerQueryValue(verData, TEXT("\\"), (VOID FAR * FAR*) & lpBuffer, &size))
             {
@@ -432,6 +698,7 @@ void GetDrvrVersionInfo()
 
     return;
 }
+#endif
 
 /*=============================================================================
  |
@@ -478,8 +745,12 @@ int ParseArguments(int argc, char** argv, DrvrParams* params)
             i++;
         }
         else if (Match("-f", argv[i])) {
-            if (sscanf_s(argv[i + 1], "%lf", &(params->f__mhz)) != 1)
+            params->f_count = ParseList(argv[i + 1], params->f_list__mhz);
+            if (params->f_count == 0)
                 return ParseErrorMsgHelper("-f [frequency]", DRVRERR__PARSE_F_FREQUENCY);
+            if (params->f_count < 0)
+                return ParseErrorMsgHelper("-f [frequencies]", DRVRERR__PARSE_F_LIST);
+            params->f__mhz = params->f_list__mhz[0];
             i++;
         }
         else if (Match("-d", argv[i])) {
@@ -488,15 +759,48 @@ int ParseArguments(int argc, char** argv, DrvrParams* params)
             i++;
         }
         else if (Match("-p", argv[i])) {
-            if (sscanf_s(argv[i + 1], "%lf", &(params->p)) != 1)
+            params->p_count = ParseList(argv[i + 1], params->p_list);
+            if (params->p_count == 0)
                 return ParseErrorMsgHelper("-p [percentage]", DRVRERR__PARSE_P_PERCENTAGE);
+            if (params->p_count < 0)
+                return ParseErrorMsgHelper("-p [percentages]", DRVRERR__PARSE_P_LIST);
+            params->p = params->p_list[0];
             i++;
         }
+        else if (Match("-tol", argv[i])) {
+            if (sscanf_s(argv[i + 1], "%lf", &(params->tolerance__db)) != 1 || !(params->tolerance__db > 0))
+                return ParseErrorMsgHelper("-tol [tolerance]", DRVRERR__PARSE_TOLERANCE);
+            i++;
+        }
+        else if (Match("-resume", argv[i])) {
+            params->is_resume = true;
+        }
         else if (Match("-tpol", argv[i])) {
             if (sscanf_s(argv[i + 1], "%i", &(params->T_pol)) != 1)
                 return ParseErrorMsgHelper("-tpol [polarization]", DRVRERR__PARSE_TPOL_POLARIZATION);
             i++;
         }
+        else if (Match("-threads", argv[i])) {
+            if (sscanf_s(argv[i + 1], "%i", &(params->threads)) != 1 || params->threads < 0)
+                return ParseErrorMsgHelper("-threads [threads]", DRVRERR__PARSE_THREADS);
+            i++;
+        }
+        else if (Match("-i", argv[i])) {
+            sprintf_s(params->in_file, "%s", argv[i + 1]);
+            i++;
+        }
+        else if (Match("-format", argv[i])) {
+            Lowercase(argv[i + 1]);
+
+            if (Match("csv", argv[i + 1]))
+                params->format = FORMAT_CSV;
+            else if (Match("binary", argv[i + 1]))
+                params->format = FORMAT_BINARY;
+            else
+                return ParseErrorMsgHelper("-format [format]", DRVRERR__PARSE_FORMAT);
+
+            i++;
+        }
         else if (Match("-o", argv[i])) {
             sprintf_s(params->out_file, "%s", argv[i + 1]);
             i++;
@@ -511,6 +815,10 @@ int ParseArguments(int argc, char** argv, DrvrParams* params)
                 params->mode = MODE_CURVE;
             else if (Match("table", argv[i + 1]))
                 params->mode = MODE_TABLE;
+            else if (Match("stream", argv[i + 1]))
+                params->mode = MODE_STREAM;
+            else if (Match("dataset", argv[i + 1]))
+                params->mode = MODE_DATASET;
             else
                 return ParseErrorMsgHelper("-mode [mode]", DRVRERR__PARSE_MODE_VALUE);
 
@@ -538,7 +846,10 @@ int ParseArguments(int argc, char** argv, DrvrParams* params)
  |  Description:  Validate that the required inputs are present for the
  |                mode specified by the user.  This function DOES NOT
  |                check the validity of the parameter values - only that
- |                required parameters have been specified by the user
+ |                required parameters have been specified by the user.
+ |                The exception is the -f and -p lists of DATASET mode,
+ |                which are checked against the range of the model, so
+ |                that no table is written from failed paths
  |
  |        Input:  params        - Structure with user input parameters
  |
@@ -546,6 +857,40 @@ int ParseArguments(int argc, char** argv, DrvrParams* params)
  |
  *===========================================================================*/
 int ValidateInputs(DrvrParams* params) {
+    if (params->mode == MODE_STREAM)    // every path input comes from the records
+        return SUCCESS;
+
+    if (params->mode == MODE_DATASET) {  // the frequencies and percentages have defaults
+        if (params->T_pol == NOT_SET)
+            return Validate_RequiredErrMsgHelper("-tpol", DRVRERR__VALIDATION_TPOL);
+
+        if (strlen(params->out_file) == 0)
+            return Validate_RequiredErrMsgHelper("-o", DRVRERR__VALIDATION_OUT_FILE);
+
+        for (int i = 0; i < params->f_count; i++) {
+            if (!(params->f_list__mhz[i] >= F__MHZ_MIN && params->f_list__mhz[i] <= F__MHZ_MAX)) {
+                printf_s("DrvrError %i: Option -f value %g is outside %i - %i MHz\n", DRVRERR__VALIDATION_F,
+                    params->f_list__mhz[i], F__MHZ_MIN, F__MHZ_MAX);
+                return DRVRERR__VALIDATION_F;
+            }
+        }
+
+        for (int i = 0; i < params->p_count; i++) {
+            if (!(params->p_list[i] >= P_MIN && params->p_list[i] <= P_MAX)) {
+                printf_s("DrvrError %i: Option -p value %g is outside %i - %i%%\n", DRVRERR__VALIDATION_P,
+                    params->p_list[i], P_MIN, P_MAX);
+                return DRVRERR__VALIDATION_P;
+            }
+        }
+
+        return SUCCESS;
+    }
+
+    if (params->f_count > 1 || params->p_count > 1) {
+        printf_s("DrvrError %i: Options -f and -p take a list of values only in DATASET mode\n", DRVRERR__VALIDATION_LIST);
+        return DRVRERR__VALIDATION_LIST;
+    }
+
     if (params->f__mhz == NOT_SET)
         return Validate_RequiredErrMsgHelper("-f", DRVRERR__VALIDATION_F);
 
@@ -595,6 +940,35 @@ int Validate_RequiredErrMsgHelper(const char* opt, int err) {
     return err;
 }
 
+/*=============================================================================
+ |
+ |  Description:  Parses a comma-separated list of values
+ |
+ |        Input:  text      - List of values
+ |
+ |      Outputs:  values    - Values, LIST_SIZE at most
+ |
+ |      Returns:  Number of values, 0 if the first value could not be
+ |                parsed, or -1 if a later value could not be parsed
+ |
+ *===========================================================================*/
+int ParseList(const char* text, double* values) {
+    int count = 0;
+
+    while (true) {
+        char* end;
+        double value = strtod(text, &end);
+        if (end == text || (*end != ',' && *end != '\0') || count == LIST_SIZE)
+            return (count == 0) ? 0 : -1;
+
+        values[count++] = value;
+        if (*end == '\0')
+            return count;
+
+        text = end + 1;
+    }
+}
+
 /*=============================================================================
  |
  |  Description:  Convert the char array to lower case
@@ -636,22 +1010,30 @@ bool Match(const char* opt, char* arg) {
  *===========================================================================*/
 void Help() {
     printf_s("\n");
-    printf_s("Usage: P528Drvr_x86.exe [Options]\n");
+    printf_s("Usage: " DRVR_NAME " [Options]\n");
     printf_s("Options (not case sensitive)\n");
     printf_s("\t-h    :: Displays help\n");
     printf_s("\t-v    :: Displays version information\n");
     printf_s("\t-h1   :: Height of low terminal, in meters\n");
     printf_s("\t-h2   :: Height of high terminal, in meters\n");
-    printf_s("\t-f    :: Frequency, in MHz\n");
-    printf_s("\t-p    :: Percentage\n");
+    printf_s("\t-f    :: Frequency, in MHz.  A comma-separated list in DATASET mode\n");
+    printf_s("\t-p    :: Percentage.  A comma-separated list in DATASET mode\n");
     printf_s("\t-tpol :: Polarization\n");
     printf_s("\t-d    :: Path distance, in km\n");
-    printf_s("\t-o    :: Output file name\n");
-    printf_s("\t-mode :: Mode of operation [POINT, CURVE, TABLE]\n");
+    printf_s("\t-o    :: Output file name, or output directory in DATASET mode\n");
+    printf_s("\t-tol  :: Interpolation tolerance of an adaptive CURVE, in dB\n");
+    printf_s("\t-resume :: Keeps the tables already written by an earlier DATASET run\n");
+    printf_s("\t-i    :: Input file name of STREAM mode, standard input if not given\n");
+    printf_s("\t-format :: Output format of CURVE and TABLE modes, and record format of STREAM mode [CSV (default), BINARY]\n");
+    printf_s("\t-threads :: Threads used by CURVE, TABLE, STREAM and DATASET modes, 0 (default) for all\n");
+    printf_s("\t-mode :: Mode of operation [POINT, CURVE, TABLE, STREAM, DATASET]\n");
     printf_s("\n");
     printf_s("Examples:\n");
-    printf_s("\tP528Drvr_x86.exe -mode POINT -h1 10 -h2 20000 -f 3000 -p 50 -tpol 1 -d 600\n");
-    printf_s("\tP528Drvr_x86.exe -mode CURVE -h1 15 -h2 15000 -f 450 -p 10 -tpol 0 -o curve.csv\n");
-    printf_s("\tP528Drvr_x86.exe -mode TABLE -f 6500 -p 90 -tpol 1 -o table.csv\n");
+    printf_s("\t" DRVR_NAME " -mode POINT -h1 10 -h2 20000 -f 3000 -p 50 -tpol 1 -d 600\n");
+    printf_s("\t" DRVR_NAME " -mode CURVE -h1 15 -h2 15000 -f 450 -p 10 -tpol 0 -o curve.csv\n");
+    printf_s("\t" DRVR_NAME " -mode CURVE -h1 15 -h2 15000 -f 450 -p 10 -tpol 0 -tol 0.1 -o curve.csv\n");
+    printf_s("\t" DRVR_NAME " -mode TABLE -f 6500 -p 90 -tpol 1 -o table.csv\n");
+    printf_s("\t" DRVR_NAME " -mode STREAM -i paths.csv -o results.csv\n");
+    printf_s("\t" DRVR_NAME " -mode DATASET -f 125,300,600 -p 5,50,95 -tpol 0 -o tables\n");
     printf_s("\n");
 };
\ No newline at end of file
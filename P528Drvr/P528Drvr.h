@@ -1,6 +1,32 @@
 
+#if !defined(_WIN32)
+#include <stdio.h>
+#include <errno.h>
+
+// The library is linked in directly, and the secure CRT functions map to their standard counterparts
+#define __stdcall
+#define printf_s                                    printf
+#define fprintf_s                                   fprintf
+#define sscanf_s                                    sscanf
+#define sprintf_s(buffer, ...)                      snprintf(buffer, sizeof(buffer), __VA_ARGS__)
+
+inline int fopen_s(FILE** fp, const char* file_name, const char* mode)
+{
+    *fp = fopen(file_name, mode);
+    return (*fp == NULL) ? errno : 0;
+}
+#endif
+
 typedef int(__stdcall *p528func)(double d__km, double h_1__meter, double h_2__meter, 
     double f__mhz, int T_pol, double p, struct Result* result);
+typedef int(__stdcall *p528batchfunc)(int n, const double* d__km, const double* h_1__meter, const double* h_2__meter,
+    const double* f__mhz, const int* T_pol, const double* p,
+    double* A__db, double* A_fs__db, double* A_a__db, int* propagation_mode, int* warnings, int* rtn,
+    int stride);
+typedef int(__stdcall *p528threadsfunc)(int threads);
+typedef int(__stdcall *p528curvefunc)(double h_1__meter, double h_2__meter, double f__mhz, int T_pol, double p,
+    double d_max__km, double tolerance__db, int max_points, double* d__km, double* A__db, int* points,
+    int* warnings);
 
 //
 // CONSTANTS
@@ -10,8 +36,38 @@ typedef int(__stdcall *p528func)(double d__km, double h_1__meter, double h_2__me
 #define     MODE_CURVE                              1
 #define     MODE_TABLE                              2
 #define     MODE_VERSION                            3
+#define     MODE_STREAM                             4
+#define     MODE_DATASET                            5
 #define     TIME_SIZE                               26
 #define     CURVE_POINTS                            1801
+#define     TABLE_COLUMNS                           18
+#define     TABLE_PATHS                             (CURVE_POINTS * TABLE_COLUMNS)
+#define     ADAPTIVE_CURVE_POINTS                   100000  // distances of an adaptive curve, at most
+#define     LIST_SIZE                               64      // values of -f and -p, at most
+#define     F__MHZ_MIN                              100     // range of -f in DATASET mode, as in the model
+#define     F__MHZ_MAX                              30000
+#define     P_MIN                                   1       // range of -p in DATASET mode, as in the model
+#define     P_MAX                                   99
+
+#define     FORMAT_CSV                              0
+#define     FORMAT_BINARY                           1
+#define     STREAM_CHUNK                            1024    // records evaluated per batch, at most
+#define     STREAM_CHUNKS                           4       // chunks being read, evaluated or written at once
+#define     STREAM__END                             -2
+#define     WRITER_BUFFER                           (1 << 20)   // bytes
+#define     WRITER_VALUE_SIZE                       400         // bytes, enough for DBL_MAX as "%.6f"
+
+#if defined(_WIN32)
+#define     LIB_NAME                                "p528_x86.dll"
+#define     DRVR_NAME                               "P528Drvr_x86.exe"
+#else
+#define     LIB_NAME                                "libp528.so"
+#define     DRVR_NAME                               "P528Drvr"
+
+// Without version resources, the driver reports the version of the library it was built with
+#define     VERSION_MAJOR                           5
+#define     VERSION_MINOR                           1
+#endif
 
 //
 // GENERAL ERRORS AND RETURN VALUES
@@ -35,6 +91,11 @@ typedef int(__stdcall *p528func)(double d__km, double h_1__meter, double h_2__me
 #define     DRVRERR__PARSE_P_PERCENTAGE             1014
 #define     DRVRERR__PARSE_MODE_VALUE               1015
 #define     DRVRERR__PARSE_TPOL_POLARIZATION        1016
+#define     DRVRERR__PARSE_THREADS                  1017
+#define     DRVRERR__PARSE_FORMAT                   1018
+#define     DRVRERR__PARSE_F_LIST                   1019
+#define     DRVRERR__PARSE_P_LIST                   1020
+#define     DRVRERR__PARSE_TOLERANCE                1021
 // Validation Errors (1100-1199)
 #define     DRVRERR__VALIDATION_MODE                1100
 #define     DRVRERR__VALIDATION_F                   1101
@@ -44,6 +105,12 @@ typedef int(__stdcall *p528func)(double d__km, double h_1__meter, double h_2__me
 #define     DRVRERR__VALIDATION_H2                  1105
 #define     DRVRERR__VALIDATION_OUT_FILE            1106
 #define     DRVRERR__VALIDATION_TPOL                1107
+#define     DRVRERR__VALIDATION_LIST                1108
+// Stream Errors (1200-1299)
+#define     DRVRERR__STREAM_RECORD                  1200
+// Dataset Errors (1300-1399)
+#define     DRVRERR__DATASET_DIRECTORY              1300
+#define     DRVRERR__DATASET_FILE                   1301
 
 //
 // WARNINGS
@@ -53,6 +120,7 @@ typedef int(__stdcall *p528func)(double d__km, double h_1__meter, double h_2__me
 #define WARNING__DFRAC_TROPO_REGION         0x01
 #define WARNING__HEIGHT_LIMIT_H_1           0x02
 #define WARNING__HEIGHT_LIMIT_H_2           0x04
+#define WARNING__CURVE_POINT_LIMIT          0x08
 
 //
 // DATA STRUCTURES
@@ -78,9 +146,64 @@ struct DrvrParams {
     double d__km = NOT_SET;       // Path distance (km), 0 <= d__km
     int T_pol = NOT_SET;          // Polarization
 
-    int mode = NOT_SET;           // Mode (POINT, CURVE, TABLE)
+    double f_list__mhz[LIST_SIZE] = { 0 };  // Frequencies of the DATASET mode, f__mhz is the first
+    double p_list[LIST_SIZE] = { 0 };       // Time percentages of the DATASET mode, p is the first
+    int f_count = 0;
+    int p_count = 0;
+    bool is_resume = false;                 // Keep the DATASET tables that are already complete
+    double tolerance__db = NOT_SET;         // Interpolation tolerance of an adaptive CURVE, in dB
+
+    int mode = NOT_SET;           // Mode (POINT, CURVE, TABLE, STREAM, DATASET)
+    int threads = 0;              // Threads used by the CURVE, TABLE, STREAM and DATASET modes, 0 for every hardware thread
+    int format = FORMAT_CSV;      // Record format of the STREAM mode (CSV, BINARY)
 
-    char out_file[256] = { 0 };   // Output file
+    char in_file[256] = { 0 };    // Input file of the STREAM mode, standard input if not set
+    char out_file[256] = { 0 };   // Output file, or directory of the DATASET mode
+};
+
+// Binary record of the STREAM mode input, in native byte order
+struct StreamInputRecord {
+    double d__km;
+    double h_1__meter;
+    double h_2__meter;
+    double f__mhz;
+    double T_pol;
+    double p;
+};
+
+// Binary record of the STREAM mode output, in native byte order
+struct StreamOutputRecord {
+    int rtn;                    // P.528 return code of the path
+    int propagation_mode;
+    int warnings;
+    int reserved;               // always 0
+
+    double A__db;
+    double A_fs__db;
+    double A_a__db;
+};
+
+// Header of the binary CURVE and TABLE outputs, in native byte order.  The header is followed by rows x columns
+// doubles, row by row.
+struct BinaryHeader {
+    char magic[4];              // "P528"
+    int mode;                   // MODE_CURVE or MODE_TABLE
+    int rtn;                    // P.528 return code.  No rows follow an error
+    int rows;
+    int columns;
+    int T_pol;
+
+    double f__mhz;
+    double p;
+    double h_1__meter;          // NOT_SET in TABLE mode
+    double h_2__meter;          // NOT_SET in TABLE mode
+};
+
+// Buffered output, see Writer.cpp
+struct Writer {
+    FILE* fp = nullptr;
+    char* buffer = nullptr;
+    size_t length = 0;          // bytes held in the buffer
 };
 
 //
@@ -99,4 +222,35 @@ int Validate_RequiredErrMsgHelper(const char* opt, int err);
 int LoadDLL();
 int CallP528_POINT(DrvrParams* params);
 int CallP528_CURVE(DrvrParams* params);
+int CallP528_AdaptiveCURVE(DrvrParams* params);
 int CallP528_TABLE(DrvrParams* params);
+int CallP528_STREAM(DrvrParams* params);
+int CallP528_DATASET(DrvrParams* params);
+void GetTablePaths(double f__mhz, double p, int T_pol, double* d__km, double* h_1__meter, double* h_2__meter,
+    double* f__mhz_out, int* T_pol_out, double* p_out);
+void WriteTable(FILE* fp, int format, double f__mhz, double p, int T_pol, const double* A__db, const double* A_fs__db);
+int ParseList(const char* text, double* values);
+void PrintThroughput(FILE* fp, int n, double seconds);
+void OpenWriter(Writer* writer, FILE* fp);
+void CloseWriter(Writer* writer);
+void FlushWriter(Writer* writer);
+void WriteText(Writer* writer, const char* text);
+void WriteChar(Writer* writer, char c);
+void WriteInt(Writer* writer, int value);
+void WriteHex(Writer* writer, int value);
+void WriteFixed(Writer* writer, double value, int precision);
+void WriteGeneral(Writer* writer, double value);
+void WriteBinary(Writer* writer, const void* data, size_t size);
+
+#if !defined(_WIN32)
+extern "C" int P528(double d__km, double h_1__meter, double h_2__meter,
+    double f__mhz, int T_pol, double p, struct Result* result);
+extern "C" int P528_BatchParallel(int n, const double* d__km, const double* h_1__meter, const double* h_2__meter,
+    const double* f__mhz, const int* T_pol, const double* p,
+    double* A__db, double* A_fs__db, double* A_a__db, int* propagation_mode, int* warnings, int* rtn,
+    int stride);
+extern "C" int P528_AdaptiveCurve(double h_1__meter, double h_2__meter, double f__mhz, int T_pol, double p,
+    double d_max__km, double tolerance__db, int max_points, double* d__km, double* A__db, int* points,
+    int* warnings);
+extern "C" int P528_SetThreadCount(int threads);
+#endif
@@ -0,0 +1,347 @@
+#include <ctype.h>
+#include <string.h>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#endif
+#include "P528Drvr.h"
+
+/*=============================================================================
+ |
+ |  Description:  STREAM mode of the P.528 driver.  Path records are read
+ |                from a file or standard input, evaluated in batches, and
+ |                written in input order as each batch completes.  Reading,
+ |                evaluation and writing run on their own threads, and share
+ |                a fixed set of STREAM_CHUNKS chunks, so that memory use is
+ |                bounded and a slow reader or writer stalls the others.
+ |
+ *===========================================================================*/
+
+extern p528batchfunc dllP528_BatchParallel;
+
+// A chunk of path records, in the column layout of the batch API
+struct StreamChunk {
+    int n = 0;
+
+    double d__km[STREAM_CHUNK];
+    double h_1__meter[STREAM_CHUNK];
+    double h_2__meter[STREAM_CHUNK];
+    double f__mhz[STREAM_CHUNK];
+    int T_pol[STREAM_CHUNK];
+    double p[STREAM_CHUNK];
+
+    double A__db[STREAM_CHUNK];
+    double A_fs__db[STREAM_CHUNK];
+    double A_a__db[STREAM_CHUNK];
+    int propagation_mode[STREAM_CHUNK];
+    int warnings[STREAM_CHUNK];
+    int rtn[STREAM_CHUNK];
+};
+
+// Chunks move from free, to filling, to ready, to done, and back to free
+struct StreamPipeline {
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    std::vector<StreamChunk*> free;
+    StreamChunk* filling = nullptr;     // chunk being read into, if any
+    std::deque<StreamChunk*> ready;     // read, waiting to be evaluated
+    std::deque<StreamChunk*> done;      // evaluated, waiting to be written
+
+    bool is_read = false;               // all records have been read
+    bool is_evaluated = false;          // all records have been evaluated
+    int err = SUCCESS;                  // error reading the records
+};
+
+/*=============================================================================
+ |
+ |  Description:  Reads the next path record.  CSV records are lines of
+ |                "d__km,h_1__meter,h_2__meter,f__mhz,T_pol,p".  Empty lines
+ |                and lines starting with '#' are skipped.
+ |
+ |        Input:  fp            - Input stream
+ |                format        - Record format (CSV, BINARY)
+ |
+ | Input/Output:  line          - Number of lines read, for CSV records
+ |
+ |      Outputs:  record        - Path record
+ |
+ |      Returns:  SUCCESS, STREAM__END, or error code
+ |
+ *===========================================================================*/
+static int ReadStreamRecord(FILE* fp, int format, int* line, StreamInputRecord* record) {
+    if (format == FORMAT_BINARY) {
+        if (fread(record, sizeof(*record), 1, fp) != 1)
+            return STREAM__END;
+    }
+    else {
+        char buffer[512];
+        char* text;
+        do {
+            if (fgets(buffer, sizeof(buffer), fp) == NULL)
+                return STREAM__END;
+            (*line)++;
+
+            text = buffer;
+            while (isspace((unsigned char)*text))
+                text++;
+        } while (*text == '\0' || *text == '#');
+
+        int T_pol;
+        if (sscanf_s(text, "%lf,%lf,%lf,%lf,%i,%lf", &record->d__km, &record->h_1__meter, &record->h_2__meter,
+            &record->f__mhz, &T_pol, &record->p) != 6) {
+            fprintf_s(stderr, "DrvrErr %i: Unable to parse the record on line %i.\n", DRVRERR__STREAM_RECORD, *line);
+            return DRVRERR__STREAM_RECORD;
+        }
+        record->T_pol = T_pol;
+    }
+
+    return SUCCESS;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes the results of an evaluated chunk
+ |
+ |        Input:  writer        - Output stream
+ |                format        - Record format (CSV, BINARY)
+ |                chunk         - Evaluated chunk
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void WriteStreamChunk(Writer* writer, int format, const StreamChunk* chunk) {
+    for (int i = 0; i < chunk->n; i++) {
+        if (format == FORMAT_BINARY) {
+            StreamOutputRecord record = { chunk->rtn[i], chunk->propagation_mode[i], chunk->warnings[i], 0,
+                chunk->A__db[i], chunk->A_fs__db[i], chunk->A_a__db[i] };
+            WriteBinary(writer, &record, sizeof(record));
+        }
+        else {
+            WriteGeneral(writer, chunk->d__km[i]);
+            WriteChar(writer, ',');
+            WriteGeneral(writer, chunk->h_1__meter[i]);
+            WriteChar(writer, ',');
+            WriteGeneral(writer, chunk->h_2__meter[i]);
+            WriteChar(writer, ',');
+            WriteGeneral(writer, chunk->f__mhz[i]);
+            WriteChar(writer, ',');
+            WriteInt(writer, chunk->T_pol[i]);
+            WriteChar(writer, ',');
+            WriteGeneral(writer, chunk->p[i]);
+            WriteChar(writer, ',');
+            WriteInt(writer, chunk->rtn[i]);
+            WriteChar(writer, ',');
+            WriteInt(writer, chunk->propagation_mode[i]);
+            WriteChar(writer, ',');
+            WriteHex(writer, chunk->warnings[i]);
+            WriteChar(writer, ',');
+            WriteFixed(writer, chunk->A__db[i], 3);
+            WriteChar(writer, ',');
+            WriteFixed(writer, chunk->A_fs__db[i], 3);
+            WriteChar(writer, ',');
+            WriteFixed(writer, chunk->A_a__db[i], 3);
+            WriteChar(writer, '\n');
+        }
+    }
+
+    // downstream consumers see each chunk as soon as it is evaluated
+    FlushWriter(writer);
+    fflush(writer->fp);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Reader thread.  Records are appended to the filling chunk,
+ |                which is handed on when it is full, or taken early by the
+ |                evaluation thread when it would otherwise sit idle.
+ |
+ *===========================================================================*/
+static void ReadStream(FILE* fp, int format, StreamPipeline* pipe) {
+    int line = 0;
+    StreamInputRecord record;
+
+    while (true) {
+        // read outside of the lock, since the input may block for a long time
+        int rtn = ReadStreamRecord(fp, format, &line, &record);
+
+        std::unique_lock<std::mutex> lock(pipe->mutex);
+
+        if (rtn != SUCCESS) {
+            if (pipe->filling != nullptr && pipe->filling->n > 0)
+                pipe->ready.push_back(pipe->filling);
+            else if (pipe->filling != nullptr)
+                pipe->free.push_back(pipe->filling);
+            pipe->filling = nullptr;
+
+            pipe->is_read = true;
+            pipe->err = (rtn == STREAM__END) ? SUCCESS : rtn;
+            pipe->changed.notify_all();
+            return;
+        }
+
+        // wait for a free chunk when the last one was handed on
+        if (pipe->filling == nullptr) {
+            pipe->changed.wait(lock, [&] { return !pipe->free.empty(); });
+            pipe->filling = pipe->free.back();
+            pipe->free.pop_back();
+            pipe->filling->n = 0;
+        }
+
+        StreamChunk* chunk = pipe->filling;
+        int i = chunk->n++;
+        chunk->d__km[i] = record.d__km;
+        chunk->h_1__meter[i] = record.h_1__meter;
+        chunk->h_2__meter[i] = record.h_2__meter;
+        chunk->f__mhz[i] = record.f__mhz;
+        chunk->T_pol[i] = (int)record.T_pol;
+        chunk->p[i] = record.p;
+
+        if (chunk->n == STREAM_CHUNK) {
+            pipe->ready.push_back(chunk);
+            pipe->filling = nullptr;
+        }
+        pipe->changed.notify_all();
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writer thread.  Writes evaluated chunks in order and
+ |                returns them to the free list.
+ |
+ *===========================================================================*/
+static void WriteStream(FILE* fp, int format, StreamPipeline* pipe) {
+    Writer writer;
+    OpenWriter(&writer, fp);
+
+    while (true) {
+        StreamChunk* chunk;
+        {
+            std::unique_lock<std::mutex> lock(pipe->mutex);
+            pipe->changed.wait(lock, [&] { return !pipe->done.empty() || pipe->is_evaluated; });
+
+            if (pipe->done.empty())
+                break;
+
+            chunk = pipe->done.front();
+            pipe->done.pop_front();
+        }
+
+        WriteStreamChunk(&writer, format, chunk);
+
+        std::lock_guard<std::mutex> lock(pipe->mutex);
+        pipe->free.push_back(chunk);
+        pipe->changed.notify_all();
+    }
+
+    CloseWriter(&writer);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Evaluates a stream of path records.  The calling thread
+ |                evaluates the chunks, while a reader thread parses the
+ |                input and a writer thread formats the output.
+ |
+ |        Input:  params        - Structure with user input parameters
+ |
+ |      Returns:  SUCCESS, or error code encountered
+ |
+ *===========================================================================*/
+int CallP528_STREAM(DrvrParams* params) {
+    FILE* fp_in = stdin;
+    FILE* fp_out = stdout;
+    const char* mode_in = (params->format == FORMAT_BINARY) ? "rb" : "r";
+    const char* mode_out = (params->format == FORMAT_BINARY) ? "wb" : "w";
+
+#if defined(_WIN32)
+    if (params->format == FORMAT_BINARY) {
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+    }
+#endif
+
+    if (strlen(params->in_file) > 0 && fopen_s(&fp_in, params->in_file, mode_in) != 0) {
+        fprintf_s(stderr, "Error opening input file.  Exiting.\n");
+        return DRVRERR__STREAM_RECORD;
+    }
+    if (strlen(params->out_file) > 0 && fopen_s(&fp_out, params->out_file, mode_out) != 0) {
+        fprintf_s(stderr, "Error opening output file.  Exiting.\n");
+        if (fp_in != stdin)
+            fclose(fp_in);
+        return DRVRERR__STREAM_RECORD;
+    }
+
+    if (params->format == FORMAT_CSV)
+        fprintf_s(fp_out, "d__km,h_1__meter,h_2__meter,f__mhz,T_pol,p,rtn,propagation_mode,warnings,A__db,A_fs__db,A_a__db\n");
+
+    std::vector<StreamChunk> chunks(STREAM_CHUNKS);
+    StreamPipeline pipe;
+    for (StreamChunk& chunk : chunks)
+        pipe.free.push_back(&chunk);
+
+    auto start = std::chrono::steady_clock::now();
+    long long n = 0;
+
+    std::thread reader(ReadStream, fp_in, params->format, &pipe);
+    std::thread writer(WriteStream, fp_out, params->format, &pipe);
+
+    while (true) {
+        StreamChunk* chunk;
+        {
+            std::unique_lock<std::mutex> lock(pipe.mutex);
+            pipe.changed.wait(lock, [&] {
+                return !pipe.ready.empty() || (pipe.filling != nullptr && pipe.filling->n > 0) || pipe.is_read; });
+
+            if (!pipe.ready.empty()) {
+                chunk = pipe.ready.front();
+                pipe.ready.pop_front();
+            }
+            else if (pipe.filling != nullptr && pipe.filling->n > 0) {
+                // nothing else to do, so evaluate the records read so far
+                chunk = pipe.filling;
+                pipe.filling = nullptr;
+                pipe.changed.notify_all();
+            }
+            else
+                break;
+        }
+
+        // per path errors are reported in the rtn column
+        dllP528_BatchParallel(chunk->n, chunk->d__km, chunk->h_1__meter, chunk->h_2__meter, chunk->f__mhz,
+            chunk->T_pol, chunk->p, chunk->A__db, chunk->A_fs__db, chunk->A_a__db, chunk->propagation_mode,
+            chunk->warnings, chunk->rtn, 1);
+        n += chunk->n;
+
+        std::lock_guard<std::mutex> lock(pipe.mutex);
+        pipe.done.push_back(chunk);
+        pipe.changed.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pipe.mutex);
+        pipe.is_evaluated = true;
+        pipe.changed.notify_all();
+    }
+
+    reader.join();
+    writer.join();
+    auto stop = std::chrono::steady_clock::now();
+
+    if (fp_in != stdin)
+        fclose(fp_in);
+    if (fp_out != stdout)
+        fclose(fp_out);
+
+    // results may be on standard output, so the throughput goes to standard error
+    PrintThroughput(stderr, (int)n, std::chrono::duration<double>(stop - start).count());
+
+    return pipe.err;
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include <string.h>
+#include <charconv>
+#include "P528Drvr.h"
+
+/*=============================================================================
+ |
+ |  Description:  Buffered output of the P.528 driver.  Values are formatted
+ |                with std::to_chars into a large buffer, which is written to
+ |                the file in blocks of WRITER_BUFFER bytes.  The text is
+ |                identical to the corresponding printf format.
+ |
+ *===========================================================================*/
+
+// Writes out the buffer when it cannot hold size more bytes
+static void Reserve(Writer* writer, size_t size) {
+    if (writer->length + size > WRITER_BUFFER)
+        FlushWriter(writer);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Starts buffered output to a file
+ |
+ |        Input:  fp            - Output file
+ |
+ |      Outputs:  writer        - Buffered writer
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void OpenWriter(Writer* writer, FILE* fp) {
+    writer->fp = fp;
+    writer->buffer = new char[WRITER_BUFFER];
+    writer->length = 0;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes out the buffered output and releases the buffer.
+ |                The file is not closed.
+ |
+ | Input/Output:  writer        - Buffered writer
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void CloseWriter(Writer* writer) {
+    FlushWriter(writer);
+
+    delete[] writer->buffer;
+    writer->buffer = nullptr;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes out the buffered output
+ |
+ | Input/Output:  writer        - Buffered writer
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void FlushWriter(Writer* writer) {
+    if (writer->length > 0)
+        fwrite(writer->buffer, 1, writer->length, writer->fp);
+    writer->length = 0;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes a string, as printf "%s"
+ |
+ *===========================================================================*/
+void WriteText(Writer* writer, const char* text) {
+    size_t size = strlen(text);
+
+    if (size > WRITER_BUFFER / 2) {
+        FlushWriter(writer);
+        fwrite(text, 1, size, writer->fp);
+        return;
+    }
+
+    Reserve(writer, size);
+    memcpy(writer->buffer + writer->length, text, size);
+    writer->length += size;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes a single character
+ |
+ *===========================================================================*/
+void WriteChar(Writer* writer, char c) {
+    Reserve(writer, 1);
+    writer->buffer[writer->length++] = c;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes an integer, as printf "%i"
+ |
+ *===========================================================================*/
+void WriteInt(Writer* writer, int value) {
+    Reserve(writer, WRITER_VALUE_SIZE);
+    char* end = std::to_chars(writer->buffer + writer->length, writer->buffer + WRITER_BUFFER, value).ptr;
+    writer->length = end - writer->buffer;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes an integer in hexadecimal, as printf "0x%x"
+ |
+ *===========================================================================*/
+void WriteHex(Writer* writer, int value) {
+    WriteText(writer, "0x");
+
+    Reserve(writer, WRITER_VALUE_SIZE);
+    char* end = std::to_chars(writer->buffer + writer->length, writer->buffer + WRITER_BUFFER,
+        (unsigned)value, 16).ptr;
+    writer->length = end - writer->buffer;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes a value in fixed-point notation, as printf "%.nf"
+ |
+ |        Input:  value         - Value
+ |                precision     - Digits after the decimal point
+ |
+ *===========================================================================*/
+void WriteFixed(Writer* writer, double value, int precision) {
+    Reserve(writer, WRITER_VALUE_SIZE);
+    char* end = std::to_chars(writer->buffer + writer->length, writer->buffer + WRITER_BUFFER, value,
+        std::chars_format::fixed, precision).ptr;
+    writer->length = end - writer->buffer;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes a value with 6 significant digits, as printf "%g"
+ |
+ *===========================================================================*/
+void WriteGeneral(Writer* writer, double value) {
+    Reserve(writer, WRITER_VALUE_SIZE);
+    char* end = std::to_chars(writer->buffer + writer->length, writer->buffer + WRITER_BUFFER, value,
+        std::chars_format::general, 6).ptr;
+    writer->length = end - writer->buffer;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes raw bytes, for binary output
+ |
+ |        Input:  data          - Bytes to write
+ |                size          - Number of bytes
+ |
+ *===========================================================================*/
+void WriteBinary(Writer* writer, const void* data, size_t size) {
+    if (size > WRITER_BUFFER / 2) {
+        FlushWriter(writer);
+        fwrite(data, 1, size, writer->fp);
+        return;
+    }
+
+    Reserve(writer, size);
+    memcpy(writer->buffer + writer->length, data, size);
+    writer->length += size;
+}
\ No newline at end of file
@@ -1,9 +1,14 @@
 #include <vector>
 #include <algorithm>
+#include <functional>
 
 using namespace std;
 
+#if defined(_WIN32)
 #define DLLEXPORT extern "C" __declspec(dllexport)
+#else
+#define DLLEXPORT extern "C" __attribute__((visibility("default")))
+#endif
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 
@@ -34,6 +39,28 @@ using namespace std;
 #define POLARIZATION__VERTICAL              1
 
 #define Y_pi_99_INDEX                       16
+#define TIME_PERCENTAGES__COUNT             17      // size of data::P
+
+// Ray optics quantities searched by reflection angle
+#define RAY_OPTICS__D                       0
+#define RAY_OPTICS__DELTA_R                 1
+
+#define RAY_OPTICS_TABLE__SIZE              128
+#define RAY_OPTICS_TABLE__PSI_MAX           1.5     // ray optics is not monotone near psi = PI/2
+#define RAY_OPTICS_TABLE__POLISH            3
+
+// Terminal geometry cache
+#define TERMINAL_CACHE__SHARDS              16      // independently locked shards, for concurrent writers
+#define TERMINAL_CACHE__WAYS                4       // slots searched per lookup
+#define TERMINAL_CACHE__CAPACITY            4096    // default number of slots
+
+#define BATCH__LANE_GROUP                   16      // line-of-sight distances of a context evaluated together
+
+// Adaptive curves
+#define ADAPTIVE_CURVE__SEED_STEP__KM       50      // spacing of the coarse grid of seed distances
+#define ADAPTIVE_CURVE__MIN_STEP__KM        0.001   // intervals are not bisected below this width
+
+#define TROPOSCATTER__LANES                 4       // distances evaluated together by the troposcatter kernel
 
 //
 // RETURN CODES
@@ -51,6 +78,17 @@ using namespace std;
 #define ERROR_VALIDATION__POLARIZATION      9
 #define ERROR_HEIGHT_AND_DISTANCE           10
 #define SUCCESS_WITH_WARNINGS               11
+#define ERROR_VALIDATION__LINE_WINDOW       12
+#define ERROR_VALIDATION__ATTENUATION_ENGINE 13
+#define ERROR_VALIDATION__HORIZON_RAY_TABLES 14
+#define ERROR_VALIDATION__TERMINAL_CACHE    15
+#define ERROR_VALIDATION__PERCENT_COUNT     16
+#define ERROR_VALIDATION__BATCH             17
+#define ERROR_VALIDATION__THREAD_COUNT      18
+#define ERROR_VALIDATION__THREAD_AFFINITY   19
+#define ERROR_VALIDATION__ADAPTIVE_CURVE    20
+#define ERROR_VALIDATION__FREQUENCY_COUNT   21
+#define ERROR_VALIDATION__GRAZING_HEIGHT_SEARCH 23
 
 //
 // WARNINGS
@@ -60,6 +98,7 @@ using namespace std;
 #define WARNING__DFRAC_TROPO_REGION         0x01
 #define WARNING__HEIGHT_LIMIT_H_1           0x02
 #define WARNING__HEIGHT_LIMIT_H_2           0x04
+#define WARNING__CURVE_POINT_LIMIT          0x08
 
 //
 // CLASSES
@@ -105,6 +144,23 @@ struct Terminal
     double A_a__db;             // Median atmospheric absorption loss, in dB
 };
 
+struct TerminalCacheStatistics
+{
+    long long hits;             // Lookups answered from the cache
+    long long misses;           // Lookups that traced the terminal geometry
+    int capacity;               // Number of slots, possibly rounded from the requested capacity
+};
+
+struct BatchStatistics
+{
+    int paths;                  // Paths in the batch
+    int contexts;               // Distinct terminal heights, frequencies and polarizations, each prepared once
+    int groups;                 // Distinct contexts and distances, each evaluated once before the time variability
+    int lane_groups;            // Tasks of groups evaluated together, whose line-of-sight rays share the ray trace kernel
+    double paths_per_context;   // Deduplication ratio of the contexts
+    double paths_per_group;     // Deduplication ratio of the groups
+};
+
 struct LineOfSightParams
 {
     // Heights
@@ -148,6 +204,23 @@ struct TroposcatterParams
     double M_s;                 // Troposcatter Line Slope
 };
 
+// Troposcatter terms that do not depend on the path distance, from InitializeTroposcatter()
+struct TroposcatterTerms
+{
+    // Terminals
+    double d_r1__km;            // Ray traced horizon distance of the low terminal
+    double d_r2__km;            // Ray traced horizon distance of the high terminal
+    double h_e1__km;            // Effective height of the low terminal
+    double h_e2__km;            // Effective height of the high terminal
+    double X_A1__km;            // Square root of X_A1 of Eqn 11-24
+    double X_A2__km;            // Square root of X_A2 of Eqn 11-24
+
+    // Scattering
+    double kappa;               // Free space wave number, from Eqn 11-29
+    double epsilon_1;           // From Eqn 11-20
+    double epsilon_2;           // From Eqn 11-21
+};
+
 struct Result {
     int propagation_mode;       // Mode of propagation
     int warnings;               // Warning messages
@@ -160,6 +233,65 @@ struct Result {
     double theta_h1__rad;	    // Elevation angle of the ray at the low terminal, in rad
 };
 
+struct MedianResult
+{
+    int propagation_mode;       // Mode of propagation
+    int warnings;               // Warning messages
+
+    double d__km;               // Path distance used in calculations
+    double A_fs__db;            // Free space path loss
+    double A_a__db;             // Atmospheric absorption loss, in dB
+    double A_T__db;             // Terrain attenuation, in dB.  Negative for line-of-sight paths with two-ray gain
+
+    double theta_h1__rad;	    // Elevation angle of the ray at the low terminal, in rad
+
+    // Variability
+    double f_theta_h;           // Angular distance factor of the long-term variability
+    double K__db;               // K-value of the Nakagami-Rice distribution
+    double Y_e_50__db;          // 50% of the long-term variability distribution
+};
+
+struct RayOpticsTable
+{
+    bool is_monotone;           // Flag if the sampled quantities can be used to bracket searches
+
+    vector<double> psi__rad;    // Reflection angles, increasing, in rad
+    vector<double> d__km;       // Path distance at each reflection angle, decreasing
+    vector<double> delta_r__km; // Ray length path difference at each reflection angle, increasing
+};
+
+struct P528Context
+{
+    // Inputs
+    double h_1__meter;          // Height of the low terminal, in meters
+    double h_2__meter;          // Height of the high terminal, in meters
+    double f__mhz;              // Frequency, in MHz
+    int T_pol;                  // Polarization
+
+    // Geometry
+    Terminal terminal_1;        // Low terminal geometry
+    Terminal terminal_2;        // High terminal geometry
+    Path path;                  // Path distances
+    RayOpticsTable ray_optics;  // Ray optics sampled over reflection angle
+
+    // Smooth earth diffraction line
+    double A_dML__db;           // Diffraction loss at d_ML, in dB
+    double M_d;                 // Slope of the diffraction line, after the transhorizon search
+    double A_d0;                // Intercept of the diffraction line, after the transhorizon search
+
+    // Line of sight
+    double psi_limit;           // Angular limit separating FS and 2-Ray, in rad
+    double A_d_0__db;           // Loss at d_0, in dB
+
+    // Transhorizon
+    int CASE;                   // Case as defined in Step 6.5
+    double d_crx__km;           // Diffraction-troposcatter crossover distance, in km
+    int warnings;               // Warning flags from the transhorizon search
+    double K_LOS;               // K-value of the LOS region, used for transhorizon variability
+    LineOfSightParams los_params;   // LOS parameters at d_ML - 1, used to find K_LOS
+    TroposcatterTerms troposcatter; // Troposcatter terms of the terminal pair and frequency
+};
+
 //
 // FUNCTIONS
 ///////////////////////////////////////////////
@@ -168,16 +300,36 @@ struct Result {
 void GetPathLoss(double psi, Path *path, double f__mhz, double psi_limit, 
     double A_dML__db, double A_d_0__db, int T_pol, LineOfSightParams* params, double *R_Tg);
 void RayOptics(Terminal *terminal_1, Terminal *terminal_2, double psi, LineOfSightParams *result);
+void BuildRayOpticsTable(Terminal *terminal_1, Terminal *terminal_2, RayOpticsTable *table);
 void TerminalGeometry(double f__mhz, Terminal *terminal);
-void Troposcatter(Path *path, Terminal *terminal_1, Terminal *terminal_2, 
-    double d__km, double f__mhz, TroposcatterParams *tropo_params);
-void TranshorizonSearch(Path* path, Terminal *terminal_1, Terminal *terminal_2, 
-    double f__mhz, double A_dML__db, double *M_d, double *A_d0, 
+void GetTerminalGeometry(double f__mhz, Terminal *terminal);
+void TerminalGeometrySweep(double h_r__km, const double* f__mhz, int N, Terminal* terminals);
+void InitializeTroposcatter(Terminal* terminal_1, Terminal* terminal_2, double f__mhz, TroposcatterTerms* terms);
+void TroposcatterDistances(const TroposcatterTerms* terms, const double* d__km, int N, double M_d, double A_d0,
+    TroposcatterParams* tropo, double* A_d__db);
+void TroposcatterLanes_AVX2(const TroposcatterTerms* terms, const double* d__km, int lanes,
+    TroposcatterParams* tropo);
+void TranshorizonSearch(Path* path, const TroposcatterTerms* terms, double A_dML__db, double *M_d, double *A_d0, 
     double* d_crx__km, int* MODE, int* warnings);
 double LinearInterpolation(double x1, double y1, double x2, double y2, double x);
 void ReflectionCoefficients(double psi, double f__mhz, int T_pol, double* R_g, double* phi_g);
-void LineOfSight(Path* path, Terminal* terminal_1, Terminal* terminal_2, LineOfSightParams* los_params, double f__mhz, double A_dML__db,
-    double p, double d__km, int T_pol, Result *result, double *K_LOS);
+void InitializeLineOfSight(Path* path, Terminal* terminal_1, Terminal* terminal_2, RayOpticsTable* table,
+    double f__mhz, double A_dML__db, int T_pol, double* psi_limit, double* A_d_0__db);
+void LineOfSight(Path* path, Terminal* terminal_1, Terminal* terminal_2, RayOpticsTable* table,
+    LineOfSightParams* los_params, double f__mhz, double A_dML__db,
+    double psi_limit, double A_d_0__db, double d__km, int T_pol, MedianResult *median);
+double LineOfSightK(Path* path, Terminal* terminal_1, Terminal* terminal_2, RayOpticsTable* table,
+    LineOfSightParams* los_params, double f__mhz, double A_dML__db, double psi_limit, double A_d_0__db, double d__km,
+    int T_pol);
+void LineOfSightPath(Path* path, Terminal* terminal_1, Terminal* terminal_2, RayOpticsTable* table,
+    LineOfSightParams* los_params, double f__mhz, double A_dML__db,
+    double psi_limit, double A_d_0__db, double d__km, int T_pol, double *R_Tg);
+double FindDistanceAtDeltaR(double delta_r__km, RayOpticsTable *table, Terminal *terminal_1, Terminal *terminal_2,
+    double terminate);
+void LineOfSightMedian(Terminal* terminal_1, Terminal* terminal_2, LineOfSightParams* los_params, double f__mhz,
+    double d__km, double R_Tg, double A_gas__db, double a__km, MedianResult *median);
+void TimeVariability(Terminal *terminal_1, Terminal *terminal_2, double d__km, double f__mhz,
+    MedianResult *median, double p, Result *result);
 double SmoothEarthDiffraction(double d_1__km, double d_2__km, double f__mhz, double d_0__km, int T_pol);
 double InverseComplementaryCumulativeDistributionFunction(double q);
 void LongTermVariability(double d_r1__km, double d_r2__km, double d__km, double f__mhz, double time_percentage, 
@@ -185,6 +337,29 @@ void LongTermVariability(double d_r1__km, double d_r2__km, double d__km, double
 double CombineDistributions(double A_M, double A_i, double B_M, double B_i, double p);
 int ValidateInputs(double d__km, double h_1__meter, double h_2__meter, double f__mhz, 
     int T_pol, double p, int* warnings);
+int ValidateTerminalInputs(double h_1__meter, double h_2__meter, double f__mhz,
+    int T_pol, int* warnings);
+void InitializeContext(double h_1__meter, double h_2__meter, double f__mhz, int T_pol,
+    P528Context* context);
+void InitializeContextFrequency(P528Context* context);
+void InitializeTranshorizon(P528Context* context);
+void EvaluateMedian(P528Context* context, double d__km, MedianResult* median,
+    TroposcatterParams* tropo, LineOfSightParams* los_params);
+void TranshorizonPath(P528Context* context, double d__km, MedianResult* median,
+    TroposcatterParams* tropo, LineOfSightParams* los_params);
+void TranshorizonMedian(P528Context* context, double d__km, double A_gas__db, double a__km,
+    MedianResult* median);
+void EvaluateMedianLanes(P528Context* context, int N, const double* d__km, MedianResult* medians,
+    LineOfSightParams* los_params);
+int EvaluateContext(P528Context* context, double d__km, double p, Result* result,
+    TroposcatterParams* tropo, LineOfSightParams* los_params);
+int GetExecutorThreads();
+void ParallelFor(int N, const vector<double>& cost, const function<void(int)>& task);
+int EvaluateContextMultiP(P528Context* context, double d__km, const double* p, int N, Result* results,
+    TroposcatterParams* tropo, LineOfSightParams* los_params);
+int ValidateContextMultiP(P528Context* context, double d__km, const double* p, int N, Result* results);
+int TimeVariabilityMultiP(P528Context* context, double d__km, MedianResult* median, const double* p, int N,
+    Result* results);
 
 
 // Public Functions
@@ -193,5 +368,38 @@ DLLEXPORT int P528(double d__km, double h_1__meter, double h_2__meter, double f_
 DLLEXPORT int P528_Ex(double d__km, double h_1__meter, double h_2__meter, double f__mhz,
     int T_pol, double p, Result* result, Terminal* terminal_1, Terminal* terminal_2,
     TroposcatterParams* tropo, Path* path, LineOfSightParams* los_params);
+DLLEXPORT int P528_PrepareContext(double h_1__meter, double h_2__meter, double f__mhz,
+    int T_pol, P528Context** context);
+DLLEXPORT int P528_EvaluateContext(P528Context* context, double d__km, double p, Result* result);
+DLLEXPORT void P528_ReleaseContext(P528Context* context);
+DLLEXPORT int P528_MultiP(double d__km, double h_1__meter, double h_2__meter, double f__mhz,
+    int T_pol, const double* p, int N, Result* results);
+DLLEXPORT int P528_EvaluateContextMultiP(P528Context* context, double d__km, const double* p, int N,
+    Result* results);
+DLLEXPORT int P528_Batch(int n, const double* d__km, const double* h_1__meter, const double* h_2__meter,
+    const double* f__mhz, const int* T_pol, const double* p,
+    double* A__db, double* A_fs__db, double* A_a__db, int* propagation_mode, int* warnings, int* rtn,
+    int stride);
+DLLEXPORT int P528_BatchParallel(int n, const double* d__km, const double* h_1__meter, const double* h_2__meter,
+    const double* f__mhz, const int* T_pol, const double* p,
+    double* A__db, double* A_fs__db, double* A_a__db, int* propagation_mode, int* warnings, int* rtn,
+    int stride);
+DLLEXPORT int P528_BatchParallel_Ex(int n, const double* d__km, const double* h_1__meter, const double* h_2__meter,
+    const double* f__mhz, const int* T_pol, const double* p,
+    double* A__db, double* A_fs__db, double* A_a__db, int* propagation_mode, int* warnings, int* rtn,
+    int stride, BatchStatistics* stats);
+DLLEXPORT int P528_AdaptiveCurve(double h_1__meter, double h_2__meter, double f__mhz, int T_pol, double p,
+    double d_max__km, double tolerance__db, int max_points, double* d__km, double* A__db, int* points,
+    int* warnings);
+DLLEXPORT int P528_FrequencySweep(double d__km, double h_1__meter, double h_2__meter, const double* f__mhz, int N,
+    int T_pol, double p, Result* results);
+DLLEXPORT int P528_SetThreadCount(int threads);
+DLLEXPORT int P528_SetThreadAffinity(int use_affinity);
+DLLEXPORT int P528_SetLineWindowTolerance(double tolerance);
+DLLEXPORT int P528_SetAttenuationEngine(int engine);
+DLLEXPORT int P528_SetHorizonRayTables(int use_tables);
+DLLEXPORT int P528_SetGrazingHeightSearch(int mode);
+DLLEXPORT int P528_SetTerminalCacheCapacity(int capacity);
+DLLEXPORT void P528_GetTerminalCacheStatistics(TerminalCacheStatistics* stats);
 DLLEXPORT double FindKForYpiAt99Percent(double Y_pi_99__db);
 DLLEXPORT double NakagamiRice(double K, double q);
\ No newline at end of file
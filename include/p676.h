@@ -1,19 +1,81 @@
 #include <vector>
 #include <algorithm>
+#include <memory>
 
 using namespace std;
 
+#if defined(_WIN32)
 #define DLLEXPORT extern "C" __declspec(dllexport)
+#else
+#define DLLEXPORT extern "C" __attribute__((visibility("default")))
+#endif
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 
 #define PI                                  3.1415926535897932384
 #define a_0__km                             6371.0
 
+#define LAYER_CACHE__CAPACITY               64      // Layer profiles kept by the ray trace cache
+
+// Instruction sets of the spectral line kernels
+#define LINE_KERNEL__SCALAR                 0
+#define LINE_KERNEL__AVX2                   1
+#define LINE_KERNEL__AVX512                 2
+
+#define LINE_TABLE__PADDING                 8       // Line tables are padded to a multiple of the widest kernel
+
+#define RAY_TRACE__LANES                    4       // Rays traced together by the vector ray trace kernel
+
+#define LINE_WINDOW__CAPACITY               64      // Line windows kept, one per frequency and tolerance
+#define LINE_WINDOW__H_MAX__KM              100     // Line window errors are bounded up to this height, in km
+#define LINE_WINDOW__H_STEP__KM             0.1     // Height step of the reference atmosphere samples, in km
+
+// Specific attenuation engines
+#define ATTENUATION_ENGINE__LINE_BY_LINE    0
+#define ATTENUATION_ENGINE__APPROXIMATE     1
+
+#define APPROXIMATE__CAPACITY               64      // Fits kept by the approximate engine, one per frequency
+#define APPROXIMATE__NEAR__GHZ              20      // Lines this close to the frequency are summed exactly, in GHz
+#define APPROXIMATE__TERMS                  7       // Pressure terms of the far-wing fit
+#define APPROXIMATE__ORDER                  6       // Coefficients of each pressure term, in powers of ln(theta)
+
+// Atmospheric states covered by the fit.  Outside of them, the line-by-line engine is used
+#define APPROXIMATE__P_MIN__HPA             10
+#define APPROXIMATE__P_MAX__HPA             1100
+#define APPROXIMATE__T_MIN__KELVIN          180
+#define APPROXIMATE__T_MAX__KELVIN          320
+#define APPROXIMATE__E_RATIO_MAX            0.04    // Largest ratio of water vapour to dry pressure
+
+#define HORIZON_RAY__H_MIN__KM              0.1     // Lower heights are traced directly, in km
+#define HORIZON_RAY__H_MAX__KM              100     // Height of the horizon ray tables, in km
+#define HORIZON_RAY__CAPACITY               16      // Horizon ray tables kept, one per frequency and atmosphere
+
+// Grazing height searches
+#define GRAZING_HEIGHT__BISECTION           0
+#define GRAZING_HEIGHT__EXACT               1
+
+#define GRAZING_HEIGHT__TOLERANCE           0.001   // Tolerance of the ray invariant at the grazing height, in km
+#define GRAZING_HEIGHT__ITERATIONS          60      // Most steps of the grazing height search
+#define GRAZING_HEIGHT__EXACT_TOLERANCE__KM 1e-6    // Width of the bracket of the exact grazing height, in km
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define LINE_KERNEL__X86
+#endif
+
+// MSVC allows intrinsics of any instruction set, while GCC and Clang need them enabled per function
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2                         __attribute__((target("avx2,fma")))
+#define TARGET_AVX512                       __attribute__((target("avx512f,avx512dq")))
+#else
+#define TARGET_AVX2
+#define TARGET_AVX512
+#endif
+
 // Function pointers
 using Temperature = double(*)(double);
 using DryPressure = double(*)(double);
 using WetPressure = double(*)(double);
+using GaseousAttenuation = double(*)(double, double, double, double);
 
 struct SlantPathAttenuationResult
 {
@@ -29,6 +91,22 @@ struct RayTraceConfig
     Temperature temperature;
     DryPressure dry_pressure;
     WetPressure wet_pressure;
+    GaseousAttenuation specific_attenuation;
+};
+
+struct LayerProfile
+{
+    int i_lower;                            // Index of the lowest layer
+    int i_upper;                            // Index of the highest layer
+
+    // Per layer, starting at i_lower
+    vector<double> h__km;                   // Height of the bottom of the layer, in km
+    vector<double> delta__km;               // Layer thickness, in km
+    vector<double> T__kelvin;               // Temperature at the middle of the layer, in Kelvin
+    vector<double> p__hPa;                  // Dry pressure at the middle of the layer, in hPa
+    vector<double> e__hPa;                  // Water vapour pressure at the middle of the layer, in hPa
+    vector<double> n;                       // Refractive index
+    vector<double> gamma;                   // Specific attenuation, in dB/km
 };
 
 class OxygenData
@@ -55,23 +133,159 @@ public:
     const static vector<double> b_6;
 };
 
+// Spectral lines as a structure-of-arrays, with the per-line constants of Equations 3, 6 and 7 precomputed
+struct OxygenLineTable
+{
+    vector<double> f_0;                     // Line centre frequency, in GHz
+    vector<double> inv_f_0;                 // 1 / f_0
+    vector<double> S;                       // a_1 * 1e-7
+    vector<double> x_S;                     // a_2
+    vector<double> W;                       // a_3 * 1e-4
+    vector<double> x_W;                     // 0.8 - a_4
+    vector<double> d_0;                     // a_5
+    vector<double> d_1;                     // a_6
+};
+
+struct WaterVapourLineTable
+{
+    vector<double> f_0;                     // Line centre frequency, in GHz
+    vector<double> inv_f_0;                 // 1 / f_0
+    vector<double> S;                       // 0.1 * b_1
+    vector<double> x_S;                     // b_2
+    vector<double> W;                       // 1e-4 * b_3
+    vector<double> x_p;                     // b_4
+    vector<double> W_e;                     // b_5
+    vector<double> x_e;                     // b_6
+    vector<double> D;                       // 2.1316e-12 * f_0^2
+};
+
+// Lines needed at one frequency to keep each line sum within a relative error tolerance
+struct LineWindow
+{
+    double f__ghz;                          // Frequency, in GHz
+    double tolerance;                       // Bound on the relative error of each line sum
+
+    OxygenLineTable oxygen;                 // Oxygen lines kept
+    WaterVapourLineTable water_vapour;      // Water vapour lines kept
+
+    // The dropped lines are folded into the kept sum as a factor of (1 + rho)
+    double rho_o;                           // Residual of the dropped oxygen lines
+    double rho_w;                           // Residual of the dropped water vapour lines
+
+    // Largest relative error of each line sum over the reference atmosphere
+    double error_o;
+    double error_w;
+};
+
+// Far-wing line sums at one frequency, fitted against the line-by-line sums
+struct AttenuationFit
+{
+    double f__ghz;                          // Frequency, in GHz
+
+    OxygenLineTable oxygen;                 // Oxygen lines near the frequency, summed exactly
+    WaterVapourLineTable water_vapour;      // Water vapour lines near the frequency, summed exactly
+
+    // Coefficients of the remaining lines, for each pressure term in powers of ln(theta)
+    double c[APPROXIMATE__TERMS][APPROXIMATE__ORDER];
+};
+
+// Cumulative results of a horizontal ray launched from the bottom of its layers, at each layer interface
+struct HorizonRayTable
+{
+    shared_ptr<const LayerProfile> profile; // Layers from the surface to HORIZON_RAY__H_MAX__KM, or from a grazing height
+
+    // Per interface, from the bottom.  Bending includes the refraction at the interface
+    vector<double> A_gas__db;               // Median gaseous absorption, in dB
+    vector<double> bending__rad;            // Bending angle, in rad
+    vector<double> a__km;                   // Ray length, in km
+    vector<double> delta_L__km;             // Excess atmospheric path length, in km
+};
+
 double LineShapeFactor(double f__ghz, double f_i__ghz, double delta_f__ghz, double delta);
 double NonresonantDebyeAttenuation(double f__ghz, double e__hPa, double p__hPa, double theta);
 double RefractiveIndex(double p__hPa, double T__kelvin, double e__hPa);
-void GetLayerProperties(double f__ghz, double h_i__km, RayTraceConfig config,
-    double* n, double* gamma);
 
 double SpecificAttenuation(double f__ghz, double T__kelvin, double e__hPa, double p__hPa);
 double OxygenRefractivity(double f__ghz, double T__kelvin, double e__hPa, double p__hPa);
 double WaterVapourRefractivity(double f__ghz, double T__kelvin, double e__hPa, double p__hPa);
 double OxygenSpecificAttenuation(double f__ghz, double T__kelvin, double e__hPa, double P__hPa);
 double WaterVapourSpecificAttenuation(double f__ghz, double T__kelvin, double e__hPa, double p__hPa);
+void SpecificAttenuationSweep(int N, const double* f__ghz, double T__kelvin, double e__hPa, double p__hPa,
+    double* gamma);
+void OxygenRefractivitySweep(int N, const double* f__ghz, double T__kelvin, double e__hPa, double p__hPa,
+    double* N_o);
+void WaterVapourRefractivitySweep(int N, const double* f__ghz, double T__kelvin, double e__hPa, double p__hPa,
+    double* N_w);
+
+OxygenLineTable BuildOxygenLineTable(const vector<int>& indices);
+WaterVapourLineTable BuildWaterVapourLineTable(const vector<int>& indices);
+const OxygenLineTable& GetOxygenLineTable();
+const WaterVapourLineTable& GetWaterVapourLineTable();
+double OxygenLineTerm(const OxygenLineTable& lines, int i, double f__ghz, double theta, double e__hPa, double p__hPa);
+double WaterVapourLineTerm(const WaterVapourLineTable& lines, int i, double f__ghz, double theta, double e__hPa, double p__hPa);
+int GetLineKernel();
+double OxygenLineSum(const OxygenLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa);
+double WaterVapourLineSum(const WaterVapourLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa);
+double OxygenLineSum_AVX2(const OxygenLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa);
+double WaterVapourLineSum_AVX2(const WaterVapourLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa);
+double OxygenLineSum_AVX512(const OxygenLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa);
+double WaterVapourLineSum_AVX512(const WaterVapourLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa);
+void OxygenLineSweep(const OxygenLineTable& lines, int N, const double* f__ghz, double theta, double e__hPa,
+    double p__hPa, double* sums);
+void WaterVapourLineSweep(const WaterVapourLineTable& lines, int N, const double* f__ghz, double theta,
+    double e__hPa, double p__hPa, double* sums);
+void OxygenLineSweep_AVX2(const OxygenLineTable& lines, int N, const double* f__ghz, double theta,
+    double e__hPa, double p__hPa, double* sums);
+void WaterVapourLineSweep_AVX2(const WaterVapourLineTable& lines, int N, const double* f__ghz,
+    double theta, double e__hPa, double p__hPa, double* sums);
+void OxygenLineSweep_AVX512(const OxygenLineTable& lines, int N, const double* f__ghz, double theta,
+    double e__hPa, double p__hPa, double* sums);
+void WaterVapourLineSweep_AVX512(const WaterVapourLineTable& lines, int N, const double* f__ghz,
+    double theta, double e__hPa, double p__hPa, double* sums);
+void SetLineWindowTolerance(double tolerance);
+double GetLineWindowTolerance();
+void ComputeLineWindow(double f__ghz, double tolerance, LineWindow* window);
+shared_ptr<const LineWindow> GetLineWindow(double f__ghz, double tolerance);
+void SetAttenuationEngine(int engine);
+int GetAttenuationEngine();
+void ComputeAttenuationFit(double f__ghz, AttenuationFit* fit);
+shared_ptr<const AttenuationFit> GetAttenuationFit(double f__ghz);
+double ApproximateSpecificAttenuation(double f__ghz, double T__kelvin, double e__hPa, double p__hPa);
+
 double WaterVapourDensityToPartialPressure(double rho__g_m3, double T__kelvin);
 
+double LayerThickness(double m, int i);
+void ComputeLayerProfile(double f__ghz, double h_1__km, double h_2__km, RayTraceConfig config,
+    LayerProfile* profile);
+shared_ptr<const LayerProfile> GetLayerProfile(double f__ghz, double h_1__km, double h_2__km,
+    RayTraceConfig config);
+
+void SetHorizonRayTables(bool use_tables);
+bool GetHorizonRayTables();
+void TraceHorizonRay(shared_ptr<const LayerProfile> profile, double h_max__km, HorizonRayTable* table);
+void ComputeHorizonRayTable(double f__ghz, RayTraceConfig config, HorizonRayTable* table);
+shared_ptr<const HorizonRayTable> GetHorizonRayTable(double f__ghz, RayTraceConfig config);
+void HorizonRay(const HorizonRayTable& table, double h__km, SlantPathAttenuationResult* result);
+
 void RayTrace(double f__ghz, double h_1__km, double h_2__km, double beta_1__rad,
     RayTraceConfig config, SlantPathAttenuationResult* result);
+void RayTraceProfile(const LayerProfile& profile, double beta_1__rad, SlantPathAttenuationResult* result,
+    double* layer_a__km);
+void RayTraceLanes(int N, const LayerProfile* const* profiles, const double* beta_1__rad,
+    SlantPathAttenuationResult* results, double* const* layer_a__km);
+void RayTraceLanes_AVX2(const LayerProfile* const* profiles, const double* beta_1__rad, int lanes,
+    SlantPathAttenuationResult* results, double* const* layer_a__km);
+void LayerAbsorption(const LayerProfile& profile, const double* layer_a__km, int N, const double* f__ghz,
+    RayTraceConfig config, double* A_gas__db);
 
+void SetGrazingHeightSearch(int mode);
+int GetGrazingHeightSearch();
 int SlantPathAttenuation(double f__ghz, double h_1__km, double h_2__km, double beta_1__rad,
     SlantPathAttenuationResult* result);
+int SlantPathAttenuationLanes(double f__ghz, double h_1__km, double h_2__km, const double* beta_1__rad, int N,
+    SlantPathAttenuationResult* results);
+int SlantPathAttenuationSweep(const double* f__ghz, int N, double h_1__km, double h_2__km, double beta_1__rad,
+    SlantPathAttenuationResult* results);
+int SlantPathGeometry(double h_1__km, double h_2__km, double beta_1__rad, SlantPathAttenuationResult* result);
 
 double GlobalWetPressure(double h__km);
\ No newline at end of file
@@ -0,0 +1,355 @@
+#include <math.h>
+#include <algorithm>
+#include "../../include/p528.h"
+
+// A sampled distance of an adaptive curve
+struct CurvePoint
+{
+    double d__km;
+    double A__db;
+    bool is_valid;              // false if the loss is not defined at this distance
+    bool is_settled;            // the interval from this point to the next meets the tolerance
+    double error__db;           // interpolation error found when the parent interval was checked
+    bool has_midpoint;          // the loss at the midpoint of the interval to the next point is known
+    bool is_midpoint_valid;
+    double d_mid__km;           // that midpoint, a quarter point of the parent interval
+    double A_mid__db;
+};
+
+/*=============================================================================
+ |
+ |  Description:  Distances where the loss curve of a context may not be
+ |                smooth: the ends of the curve, the distances d_0, d_ML
+ |                and d_crx where the method changes, a coarse grid, and,
+ |                within line of sight, every quarter period of the two-ray
+ |                lobes, where the ray length path difference is a multiple
+ |                of lambda / 4.  Lobes are sampled from d_0 towards the
+ |                terminals, until they become narrower than
+ |                ADAPTIVE_CURVE__MIN_STEP__KM.  The ends and the
+ |                breakpoints are always kept, first, and the grid is
+ |                thinned so that the grid and the lobes leave at least half
+ |                of max_points to the refinement.
+ |
+ |        Input:  context           - Struct containing the prepared path
+ |                d_max__km         - Largest distance of the curve, in km
+ |                max_points        - Most distances to return
+ |
+ |      Outputs:  d__km             - Seed distances, unsorted, max_points
+ |                                    at most
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void GetSeedDistances(P528Context* context, double d_max__km, int max_points, vector<double>* d__km)
+{
+    d__km->push_back(0);
+    d__km->push_back(d_max__km);
+
+    double breakpoints__km[] = { context->path.d_0__km, context->path.d_ML__km, context->d_crx__km };
+    for (double d : breakpoints__km)
+        if (d > 0 && d < d_max__km)
+            d__km->push_back(d);
+
+    // the loss is not defined at 0 km between equal heights
+    d__km->push_back(MIN(ADAPTIVE_CURVE__MIN_STEP__KM, d_max__km));
+
+    if ((int)d__km->size() > max_points)
+        d__km->resize(max_points);
+
+    // leave at least half of the points to the refinement
+    int grid_points = max_points / 2 - (int)d__km->size();
+    if (grid_points > 0)
+    {
+        double step__km = ADAPTIVE_CURVE__SEED_STEP__KM
+            * MAX(1.0, ceil(d_max__km / (ADAPTIVE_CURVE__SEED_STEP__KM * (grid_points + 1))));
+        for (double d = step__km; d < d_max__km; d += step__km)
+            d__km->push_back(d);
+    }
+
+    double lambda__km = 0.2997925 / context->f__mhz;                    // [Eqn 6-1]
+    double terminate = lambda__km / 1e6;
+    double d_last__km = context->path.d_0__km;
+    for (int k = 2; (int)d__km->size() < max_points / 2; k++)
+    {
+        double d = FindDistanceAtDeltaR(k * lambda__km / 4, &context->ray_optics, &context->terminal_1,
+            &context->terminal_2, terminate);
+
+        if (d < ADAPTIVE_CURVE__MIN_STEP__KM || d_last__km - d < ADAPTIVE_CURVE__MIN_STEP__KM)
+            break;
+
+        if (d < d_max__km)
+            d__km->push_back(d);
+        d_last__km = d;
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Evaluates the loss at the distances of a set of points, in
+ |                parallel
+ |
+ |        Input:  context           - Struct containing the prepared path
+ |                p                 - Time percentage
+ |
+ | Input/Output:  points            - Points, whose loss is set
+ |                warnings          - Warning flags of the points
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void EvaluatePoints(P528Context* context, double p, vector<CurvePoint>* points, int* warnings)
+{
+    int N = (int)points->size();
+    vector<int> point_warnings(N);
+
+    // transhorizon paths cost more with distance
+    vector<double> cost(N);
+    for (int i = 0; i < N; i++)
+        cost[i] = 1 + (*points)[i].d__km;
+
+    ParallelFor(N, cost, [&](int i)
+    {
+        CurvePoint* point = &(*points)[i];
+
+        Result result;
+        TroposcatterParams tropo;
+        LineOfSightParams los_params;
+
+        // a zero length path between equal heights has no loss to sample
+        int rtn = ValidateContextMultiP(context, point->d__km, &p, 1, &result);
+        if (rtn == SUCCESS || rtn == SUCCESS_WITH_WARNINGS)
+            rtn = EvaluateContext(context, point->d__km, p, &result, &tropo, &los_params);
+
+        point->is_valid = (rtn == SUCCESS || rtn == SUCCESS_WITH_WARNINGS);
+        point->A__db = result.A__db;
+        point_warnings[i] = result.warnings;
+    });
+
+    for (int i = 0; i < N; i++)
+        if ((*points)[i].is_valid)
+            *warnings |= point_warnings[i];
+}
+
+/*=============================================================================
+ |
+ |  Description:  Samples the loss-vs-distance curve of a path, choosing the
+ |                distances so that linear interpolation between them is
+ |                within a tolerance.  The curve is seeded at the distances
+ |                where it may not be smooth (see GetSeedDistances()), then
+ |                each interval is bisected until, at its midpoint and
+ |                its two quarter points, the loss is within half the
+ |                tolerance of the line between its ends, and twice each
+ |                second difference of the five losses is too, or until it
+ |                is narrower than ADAPTIVE_CURVE__MIN_STEP__KM.  An
+ |                interval within the tolerance is kept whole, so that
+ |                every returned interval has been checked at its own
+ |                points, and the quarter points of a bisected interval are
+ |                the midpoints of its halves.  The quarter points find the
+ |                nulls that a midpoint misses where a lobe and a null
+ |                cancel, and the second differences find the kinks whose
+ |                error the curvature on either side hides from the line.
+ |                Half the tolerance also bounds the error of an interval
+ |                with a single kink.  The points
+ |                checked in a round of bisection are evaluated in
+ |                parallel.  Each loss is identical to calling P528() at its
+ |                distance.
+ |
+ |        Input:  h_1__meter        - Height of the low terminal, in meters
+ |                h_2__meter        - Height of the high terminal, in meters
+ |                f__mhz            - Frequency, in MHz
+ |                T_pol             - Code indicating either polarization
+ |                                      + 0 : POLARIZATION__HORIZONTAL
+ |                                      + 1 : POLARIZATION__VERTICAL
+ |                p                 - Time percentage
+ |                d_max__km         - Largest path distance, in km
+ |                tolerance__db     - Interpolation tolerance, in dB
+ |                max_points        - Size of the output arrays
+ |
+ |      Outputs:  d__km             - Path distances, increasing, in km
+ |                A__db             - Basic transmission loss at each
+ |                                    distance, in dB
+ |                points            - Number of distances returned
+ |                warnings          - Warning flags of all distances, and
+ |                                    WARNING__CURVE_POINT_LIMIT if the
+ |                                    tolerance was not met everywhere
+ |                                    within max_points distances
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_AdaptiveCurve(double h_1__meter, double h_2__meter, double f__mhz, int T_pol, double p,
+    double d_max__km, double tolerance__db, int max_points, double* d__km, double* A__db, int* points,
+    int* warnings)
+{
+    *points = 0;
+    *warnings = WARNING__NO_WARNINGS;
+
+    int err = ValidateInputs(d_max__km, h_1__meter, h_2__meter, f__mhz, T_pol, p, warnings);
+    if (err != SUCCESS && err != ERROR_HEIGHT_AND_DISTANCE)
+        return err;
+
+    if (!(tolerance__db > 0) || max_points < 2)
+        return ERROR_VALIDATION__ADAPTIVE_CURVE;
+
+    P528Context context;
+    InitializeContext(h_1__meter, h_2__meter, f__mhz, T_pol, &context);
+    InitializeTranshorizon(&context);
+
+    // seed the curve
+    vector<double> seeds__km;
+    GetSeedDistances(&context, d_max__km, max_points, &seeds__km);
+    sort(seeds__km.begin(), seeds__km.end());
+    seeds__km.erase(unique(seeds__km.begin(), seeds__km.end()), seeds__km.end());
+
+    vector<CurvePoint> curve(seeds__km.size());
+    for (size_t i = 0; i < curve.size(); i++)
+        curve[i] = { seeds__km[i], 0, false, false, HUGE_VAL, false, false, 0, 0 };
+    EvaluatePoints(&context, p, &curve, warnings);
+
+    // bisect unsettled intervals, one round at a time
+    while (true)
+    {
+        vector<CurvePoint> probes;
+        vector<int> intervals;          // index of the point starting each bisected interval
+
+        for (size_t i = 0; i + 1 < curve.size(); i++)
+        {
+            CurvePoint* a = &curve[i];
+            CurvePoint* b = &curve[i + 1];
+
+            // intervals next to an undefined loss are not refined
+            if (a->is_settled || !a->is_valid || !b->is_valid)
+                continue;
+
+            if (b->d__km - a->d__km < 2 * ADAPTIVE_CURVE__MIN_STEP__KM)
+            {
+                a->is_settled = true;
+                continue;
+            }
+
+            intervals.push_back((int)i);
+        }
+
+        if (intervals.empty())
+            break;
+
+        // keep to the size of the output, bisecting the intervals with the largest errors first
+        int budget = max_points - (int)curve.size();
+        if (budget < (int)intervals.size())
+        {
+            *warnings |= WARNING__CURVE_POINT_LIMIT;
+            if (budget <= 0)
+                break;
+
+            stable_sort(intervals.begin(), intervals.end(),
+                [&](int a, int b) { return curve[a].error__db > curve[b].error__db; });
+            intervals.resize(budget);
+            sort(intervals.begin(), intervals.end());
+        }
+
+        // the quarter points, and the midpoint unless it is known from the parent interval
+        vector<int> first_probe(intervals.size());
+        for (size_t k = 0; k < intervals.size(); k++)
+        {
+            const CurvePoint* a = &curve[intervals[k]];
+            double w__km = curve[intervals[k] + 1].d__km - a->d__km;
+
+            first_probe[k] = (int)probes.size();
+            probes.push_back({ a->d__km + w__km / 4, 0, false, false, HUGE_VAL, false, false, 0, 0 });
+            probes.push_back({ a->d__km + 3 * w__km / 4, 0, false, false, HUGE_VAL, false, false, 0, 0 });
+            if (a->has_midpoint)
+                probes.push_back({ a->d_mid__km, a->A_mid__db, a->is_midpoint_valid, false, HUGE_VAL,
+                    false, false, 0, 0 });
+            else
+                probes.push_back({ a->d__km + w__km / 2, 0, false, false, HUGE_VAL, false, false, 0, 0 });
+        }
+
+        vector<CurvePoint> unknown;
+        vector<int> unknown_probes;
+        for (size_t k = 0; k < intervals.size(); k++)
+        {
+            int n = curve[intervals[k]].has_midpoint ? 2 : 3;
+            for (int j = 0; j < n; j++)
+            {
+                unknown.push_back(probes[first_probe[k] + j]);
+                unknown_probes.push_back(first_probe[k] + j);
+            }
+        }
+
+        EvaluatePoints(&context, p, &unknown, warnings);
+        for (size_t j = 0; j < unknown.size(); j++)
+            probes[unknown_probes[j]] = unknown[j];
+
+        // bisect the intervals beyond the tolerance, and settle the others whole
+        vector<CurvePoint> refined;
+        refined.reserve(curve.size() + intervals.size());
+
+        size_t k = 0;
+        for (size_t i = 0; i < curve.size(); i++)
+        {
+            refined.push_back(curve[i]);
+
+            if (k < intervals.size() && intervals[k] == (int)i)
+            {
+                const CurvePoint* q_1 = &probes[first_probe[k]];
+                const CurvePoint* q_3 = &probes[first_probe[k] + 1];
+                CurvePoint mid = probes[first_probe[k] + 2];
+                k++;
+
+                double A_a__db = curve[i].A__db;
+                double A_b__db = curve[i + 1].A__db;
+                bool is_valid = q_1->is_valid && mid.is_valid && q_3->is_valid;
+                double error__db = 0;
+                if (is_valid)
+                {
+                    // distance from the line between the ends
+                    error__db = MAX(fabs(q_1->A__db - (3 * A_a__db + A_b__db) / 4),
+                        MAX(fabs(mid.A__db - (A_a__db + A_b__db) / 2), fabs(q_3->A__db - (A_a__db + 3 * A_b__db) / 4)));
+
+                    // twice the second differences, the midpoint error of a curve of that curvature, which also
+                    //      see a kink whose error the curvature on either side hides from the line
+                    double A__db[] = { A_a__db, q_1->A__db, mid.A__db, q_3->A__db, A_b__db };
+                    for (int j = 1; j < 4; j++)
+                        error__db = MAX(error__db, 2 * fabs(A__db[j - 1] - 2 * A__db[j] + A__db[j + 1]));
+                }
+
+                // the second differences see at least half of the error at a kink anywhere in the interval
+                if (is_valid && error__db <= tolerance__db / 2)
+                {
+                    refined.back().is_settled = true;
+                    continue;
+                }
+
+                refined.back().error__db = error__db;
+                refined.back().has_midpoint = true;
+                refined.back().is_midpoint_valid = q_1->is_valid;
+                refined.back().d_mid__km = q_1->d__km;
+                refined.back().A_mid__db = q_1->A__db;
+
+                mid.error__db = error__db;
+                mid.has_midpoint = true;
+                mid.is_midpoint_valid = q_3->is_valid;
+                mid.d_mid__km = q_3->d__km;
+                mid.A_mid__db = q_3->A__db;
+                refined.push_back(mid);
+            }
+        }
+
+        curve.swap(refined);
+    }
+
+    for (const CurvePoint& point : curve)
+    {
+        if (!point.is_valid)
+            continue;
+
+        d__km[*points] = point.d__km;
+        A__db[*points] = point.A__db;
+        (*points)++;
+    }
+
+    if (*warnings == WARNING__NO_WARNINGS)
+        return SUCCESS;
+    else
+        return SUCCESS_WITH_WARNINGS;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "../../include/p528.h"
+#include "../../include/p676.h"
+
+/*=============================================================================
+ |
+ |  Description:  Selects the engine used for the specific attenuation of
+ |                each ray trace layer.  The line-by-line engine, the
+ |                default, sums every oxygen and water vapour line.  The
+ |                approximate engine sums only the lines near the frequency
+ |                exactly, and takes the rest from a fit that is calibrated
+ |                against the line-by-line engine once per frequency.
+ |                Contexts prepared before a change keep the engine they
+ |                were prepared with.
+ |
+ |        Input:  engine            - Code indicating the engine
+ |                                      + 0 : ATTENUATION_ENGINE__LINE_BY_LINE
+ |                                      + 1 : ATTENUATION_ENGINE__APPROXIMATE
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_SetAttenuationEngine(int engine)
+{
+    if (engine != ATTENUATION_ENGINE__LINE_BY_LINE &&
+        engine != ATTENUATION_ENGINE__APPROXIMATE)
+        return ERROR_VALIDATION__ATTENUATION_ENGINE;
+
+    SetAttenuationEngine(engine);
+
+    return SUCCESS;
+}
\ No newline at end of file
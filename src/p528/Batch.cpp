@@ -0,0 +1,549 @@
+#include <math.h>
+#include <tuple>
+#include <memory>
+#include "../../include/p528.h"
+
+/*=============================================================================
+ |
+ |  Description:  Writes the results of one path of a batch to the output
+ |                columns that are not null
+ |
+ |        Input:  k                 - Index in the output columns
+ |                result            - Result of the path
+ |                rtn_i             - Return code of the path
+ |
+ |      Outputs:  A__db, A_fs__db, A_a__db, propagation_mode, warnings, rtn
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void StoreBatchResult(long long k, const Result& result, int rtn_i,
+    double* A__db, double* A_fs__db, double* A_a__db, int* propagation_mode, int* warnings, int* rtn)
+{
+    if (A__db != nullptr)
+        A__db[k] = result.A__db;
+    if (A_fs__db != nullptr)
+        A_fs__db[k] = result.A_fs__db;
+    if (A_a__db != nullptr)
+        A_a__db[k] = result.A_a__db;
+    if (propagation_mode != nullptr)
+        propagation_mode[k] = result.propagation_mode;
+    if (warnings != nullptr)
+        warnings[k] = result.warnings;
+    if (rtn != nullptr)
+        rtn[k] = rtn_i;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Folds the return code of a path into the return code of
+ |                its batch, in path order.  The first error is kept, and
+ |                otherwise any warnings are reported.
+ |
+ |        Input:  rtn_batch         - Return code of the previous paths
+ |                rtn_i             - Return code of the path
+ |
+ |      Returns:  rtn_batch         - Return code of the batch
+ |
+ *===========================================================================*/
+static int CombineBatchReturn(int rtn_batch, int rtn_i)
+{
+    if (rtn_i != SUCCESS && rtn_i != SUCCESS_WITH_WARNINGS)
+    {
+        if (rtn_batch == SUCCESS || rtn_batch == SUCCESS_WITH_WARNINGS)
+            return rtn_i;
+    }
+    else if (rtn_i == SUCCESS_WITH_WARNINGS && rtn_batch == SUCCESS)
+        return SUCCESS_WITH_WARNINGS;
+
+    return rtn_batch;
+}
+
+// Number of ray trace layers from the surface to a height, from Equation 16
+static double LayersToHeight(double h__km)
+{
+    return 100 * log(1e4 * h__km * (exp(1. / 100.) - 1) + 1);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Estimates the cost of preparing the context of a terminal
+ |                pair, in microseconds.  The terminal geometries and
+ |                transhorizon search are dominated by ray traces from the
+ |                surface, whose layers grow with the terminal heights.
+ |
+ |        Input:  h_1__km           - Height of the low terminal, in km
+ |                h_2__km           - Height of the high terminal, in km
+ |
+ |      Returns:  cost              - Estimated cost
+ |
+ *===========================================================================*/
+static double EstimateContextCost(double h_1__km, double h_2__km)
+{
+    return 500 + LayersToHeight(h_1__km) + LayersToHeight(h_2__km);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Estimates the cost of evaluating a path with a prepared
+ |                context, in microseconds.  Line-of-sight paths reuse the
+ |                layer profile between the terminals, while each
+ |                transhorizon distance traces a ray to a new common volume
+ |                height, which rises with the distance past the smooth
+ |                earth horizon.
+ |
+ |        Input:  h_1__km           - Height of the low terminal, in km
+ |                h_2__km           - Height of the high terminal, in km
+ |                d__km             - Path distance, in km
+ |
+ |      Returns:  cost              - Estimated cost
+ |
+ *===========================================================================*/
+static double EstimatePathCost(double h_1__km, double h_2__km, double d__km)
+{
+    double d_ML__km = sqrt(2 * a_e__km * h_1__km) + sqrt(2 * a_e__km * h_2__km);
+    if (d__km < d_ML__km)
+        return 100;
+
+    double h_v__km = pow(d__km - d_ML__km, 2) / (8 * a_e__km);
+    return 30 + LayersToHeight(h_v__km);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Evaluates P.528 for a batch of paths, reading inputs from
+ |                and writing outputs to caller-owned columns.  Consecutive
+ |                paths with the same terminal heights, frequency and
+ |                polarization share one prepared context.  Results are
+ |                identical to calling P528() for each path.
+ |
+ |        Input:  n                 - Number of paths
+ |                d__km             - Path distances, in km
+ |                h_1__meter        - Heights of the low terminal, in meters
+ |                h_2__meter        - Heights of the high terminal, in meters
+ |                f__mhz            - Frequencies, in MHz
+ |                T_pol             - Codes indicating either polarization
+ |                                      + 0 : POLARIZATION__HORIZONTAL
+ |                                      + 1 : POLARIZATION__VERTICAL
+ |                p                 - Time percentages
+ |                stride            - Distance between consecutive outputs
+ |                                    in each output column, in elements
+ |
+ |      Outputs:  A__db             - Basic transmission losses, in dB
+ |                A_fs__db          - Free space basic transmission losses,
+ |                                    in dB
+ |                A_a__db           - Median atmospheric absorption losses,
+ |                                    in dB
+ |                propagation_mode  - Modes of propagation
+ |                warnings          - Warning flags
+ |                rtn               - Return code of each path
+ |
+ |                Any output column may be null, and is then skipped.
+ |
+ |      Returns:  rtn               - SUCCESS, SUCCESS_WITH_WARNINGS if any
+ |                                    path has warnings, or the error code
+ |                                    of the first path that failed
+ |
+ *===========================================================================*/
+int P528_Batch(int n, const double* d__km, const double* h_1__meter, const double* h_2__meter,
+    const double* f__mhz, const int* T_pol, const double* p,
+    double* A__db, double* A_fs__db, double* A_a__db, int* propagation_mode, int* warnings, int* rtn,
+    int stride)
+{
+    if (n < 0 || stride < 1)
+        return ERROR_VALIDATION__BATCH;
+
+    int rtn_batch = SUCCESS;
+
+    P528Context context;
+    bool has_context = false;           // context holds the terminal inputs of the previous path
+    bool is_prepared = false;           // context is prepared, as the terminal inputs are valid
+    bool is_transhorizon = false;       // context is prepared beyond the LOS region
+
+    TroposcatterParams tropo;
+    LineOfSightParams los_params;
+    Result result;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (!has_context || context.h_1__meter != h_1__meter[i] || context.h_2__meter != h_2__meter[i] ||
+            context.f__mhz != f__mhz[i] || context.T_pol != T_pol[i])
+        {
+            context.h_1__meter = h_1__meter[i];
+            context.h_2__meter = h_2__meter[i];
+            context.f__mhz = f__mhz[i];
+            context.T_pol = T_pol[i];
+            has_context = true;
+
+            // invalid terminal inputs are reported by EvaluateContext()
+            int terminal_warnings = WARNING__NO_WARNINGS;
+            is_prepared = ValidateTerminalInputs(h_1__meter[i], h_2__meter[i], f__mhz[i], T_pol[i],
+                &terminal_warnings) == SUCCESS;
+            is_transhorizon = false;
+
+            if (is_prepared)
+                InitializeContext(h_1__meter[i], h_2__meter[i], f__mhz[i], T_pol[i], &context);
+        }
+
+        // the transhorizon parameters are only needed beyond the LOS region
+        if (is_prepared && !is_transhorizon && context.path.d_ML__km - d__km[i] <= 0.001)
+        {
+            InitializeTranshorizon(&context);
+            is_transhorizon = true;
+        }
+
+        int rtn_i = EvaluateContext(&context, d__km[i], p[i], &result, &tropo, &los_params);
+
+        rtn_batch = CombineBatchReturn(rtn_batch, rtn_i);
+        StoreBatchResult((long long)i * stride, result, rtn_i, A__db, A_fs__db, A_a__db, propagation_mode,
+            warnings, rtn);
+    }
+
+    return rtn_batch;
+}
+
+// Paths of a batch that share a context and distance, and so differ only in time percentage
+struct BatchGroup
+{
+    int context;                // index of the context
+    double d__km;               // path distance, in km
+    vector<int> paths;          // indices of the paths in the batch
+};
+
+// Contexts and groups of a batch, ordered by terminal heights, frequency, polarization and distance
+struct BatchPlan
+{
+    vector<unique_ptr<P528Context>> contexts;
+    vector<double> d_max__km;   // largest distance of each context, to decide if it needs the transhorizon setup
+    vector<int> is_prepared;    // flag for each context, set once it is prepared, as its terminal inputs are valid
+    vector<BatchGroup> groups;
+};
+
+/*=============================================================================
+ |
+ |  Description:  Plans a batch by sorting its paths by terminal heights,
+ |                frequency, polarization and distance.  Paths with the
+ |                same terminal inputs share a context, and paths that also
+ |                have the same distance share a group, whose time-
+ |                independent results are computed once.
+ |
+ |        Input:  paths             - Indices of the paths to plan, none
+ |                                    of which has a NaN input in the key
+ |                d__km             - Path distances, in km
+ |                h_1__meter        - Heights of the low terminal, in meters
+ |                h_2__meter        - Heights of the high terminal, in meters
+ |                f__mhz            - Frequencies, in MHz
+ |                T_pol             - Codes indicating either polarization
+ |
+ |      Outputs:  plan              - Batch plan, with the inputs of each
+ |                                    context set, but not yet prepared
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void PlanBatch(const vector<int>& paths, const double* d__km, const double* h_1__meter,
+    const double* h_2__meter, const double* f__mhz, const int* T_pol, BatchPlan* plan)
+{
+    auto key = [&](int i) { return make_tuple(h_1__meter[i], h_2__meter[i], f__mhz[i], T_pol[i], d__km[i]); };
+
+    int n = (int)paths.size();
+    vector<int> order(paths);
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return key(a) < key(b); });
+
+    for (int k = 0; k < n; k++)
+    {
+        int i = order[k];
+        bool is_new_context = (k == 0) ||
+            h_1__meter[i] != h_1__meter[order[k - 1]] || h_2__meter[i] != h_2__meter[order[k - 1]] ||
+            f__mhz[i] != f__mhz[order[k - 1]] || T_pol[i] != T_pol[order[k - 1]];
+
+        if (is_new_context)
+        {
+            unique_ptr<P528Context> context(new P528Context);
+            context->h_1__meter = h_1__meter[i];
+            context->h_2__meter = h_2__meter[i];
+            context->f__mhz = f__mhz[i];
+            context->T_pol = T_pol[i];
+
+            plan->contexts.push_back(move(context));
+            plan->d_max__km.push_back(d__km[i]);
+            plan->is_prepared.push_back(0);
+        }
+
+        int c = (int)plan->contexts.size() - 1;
+        plan->d_max__km[c] = MAX(plan->d_max__km[c], d__km[i]);
+
+        if (is_new_context || d__km[i] != plan->groups.back().d__km)
+            plan->groups.push_back({ c, d__km[i], {} });
+
+        plan->groups.back().paths.push_back(i);
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Evaluates P.528 for a batch of paths in parallel, with
+ |                the same inputs and outputs as P528_Batch().  The batch is
+ |                planned by PlanBatch(), so that the context of each
+ |                distinct terminal pair, frequency and polarization is
+ |                prepared once, and the time-independent results of each
+ |                distinct path distance of a context are computed once.
+ |                The line-of-sight groups of a context are evaluated in
+ |                lane groups of up to BATCH__LANE_GROUP distances, whose
+ |                rays between the terminals are traced together by the
+ |                vector ray trace kernel.  Contexts, and then lane groups,
+ |                run on the executor's work-stealing thread pool, most
+ |                expensive first, using estimates of their costs.  Results
+ |                are scattered back to the order of the inputs, and are
+ |                identical to calling P528() for each path, for any number
+ |                of threads.  Paths with a NaN distance, height or
+ |                frequency cannot be sorted, and are evaluated one at a
+ |                time by P528().
+ |
+ |        Input:  n                 - Number of paths
+ |                d__km             - Path distances, in km
+ |                h_1__meter        - Heights of the low terminal, in meters
+ |                h_2__meter        - Heights of the high terminal, in meters
+ |                f__mhz            - Frequencies, in MHz
+ |                T_pol             - Codes indicating either polarization
+ |                                      + 0 : POLARIZATION__HORIZONTAL
+ |                                      + 1 : POLARIZATION__VERTICAL
+ |                p                 - Time percentages
+ |                stride            - Distance between consecutive outputs
+ |                                    in each output column, in elements
+ |
+ |      Outputs:  A__db             - Basic transmission losses, in dB
+ |                A_fs__db          - Free space basic transmission losses,
+ |                                    in dB
+ |                A_a__db           - Median atmospheric absorption losses,
+ |                                    in dB
+ |                propagation_mode  - Modes of propagation
+ |                warnings          - Warning flags
+ |                rtn               - Return code of each path
+ |                stats             - Deduplication statistics of the batch
+ |
+ |                Any output column may be null, and is then skipped.
+ |
+ |      Returns:  rtn               - SUCCESS, SUCCESS_WITH_WARNINGS if any
+ |                                    path has warnings, or the error code
+ |                                    of the first path that failed
+ |
+ *===========================================================================*/
+int P528_BatchParallel_Ex(int n, const double* d__km, const double* h_1__meter, const double* h_2__meter,
+    const double* f__mhz, const int* T_pol, const double* p,
+    double* A__db, double* A_fs__db, double* A_a__db, int* propagation_mode, int* warnings, int* rtn,
+    int stride, BatchStatistics* stats)
+{
+    // statistics are collected here, and only written out if requested
+    BatchStatistics batch_stats;
+    batch_stats.paths = 0;
+    batch_stats.contexts = 0;
+    batch_stats.groups = 0;
+    batch_stats.lane_groups = 0;
+    batch_stats.paths_per_context = 0;
+    batch_stats.paths_per_group = 0;
+
+    if (stats != nullptr)
+        *stats = batch_stats;
+
+    if (n < 0 || stride < 1)
+        return ERROR_VALIDATION__BATCH;
+
+    // a NaN input has no place in the sort order of the plan, so those paths are evaluated on their own
+    vector<int> planned_paths;
+    vector<int> unplanned_paths;
+    for (int i = 0; i < n; i++)
+    {
+        if (isnan(d__km[i]) || isnan(h_1__meter[i]) || isnan(h_2__meter[i]) || isnan(f__mhz[i]))
+            unplanned_paths.push_back(i);
+        else
+            planned_paths.push_back(i);
+    }
+
+    BatchPlan plan;
+    PlanBatch(planned_paths, d__km, h_1__meter, h_2__meter, f__mhz, T_pol, &plan);
+
+    batch_stats.paths = n;
+    batch_stats.contexts = (int)plan.contexts.size();
+    batch_stats.groups = (int)plan.groups.size();
+    if (!planned_paths.empty())
+    {
+        batch_stats.paths_per_context = (double)planned_paths.size() / batch_stats.contexts;
+        batch_stats.paths_per_group = (double)planned_paths.size() / batch_stats.groups;
+    }
+
+    vector<int> rtns(n);
+
+    for (int i : unplanned_paths)
+    {
+        Result result;
+        rtns[i] = P528(d__km[i], h_1__meter[i], h_2__meter[i], f__mhz[i], T_pol[i], p[i], &result);
+        StoreBatchResult((long long)i * stride, result, rtns[i], A__db, A_fs__db, A_a__db, propagation_mode,
+            warnings, rtn);
+    }
+
+    /////////////////////////////////////////////
+    // Prepare each context
+    //
+
+    vector<double> cost(plan.contexts.size());
+    for (size_t c = 0; c < plan.contexts.size(); c++)
+        cost[c] = EstimateContextCost(plan.contexts[c]->h_1__meter / 1000, plan.contexts[c]->h_2__meter / 1000);
+
+    ParallelFor((int)plan.contexts.size(), cost, [&](int c)
+    {
+        P528Context* context = plan.contexts[c].get();
+
+        // invalid terminal inputs are reported by EvaluateContext()
+        int terminal_warnings = WARNING__NO_WARNINGS;
+        if (ValidateTerminalInputs(context->h_1__meter, context->h_2__meter, context->f__mhz, context->T_pol,
+            &terminal_warnings) != SUCCESS)
+            return;
+
+        InitializeContext(context->h_1__meter, context->h_2__meter, context->f__mhz, context->T_pol, context);
+
+        // the transhorizon parameters are only needed beyond the LOS region
+        if (context->path.d_ML__km - plan.d_max__km[c] <= 0.001)
+            InitializeTranshorizon(context);
+
+        plan.is_prepared[c] = 1;
+    });
+
+    //
+    // Prepare each context
+    /////////////////////////////////////////////
+
+    /////////////////////////////////////////////
+    // Evaluate each lane group
+    //
+
+    // the groups of a context are sorted by distance, so its line-of-sight groups come first.  these are
+    //      evaluated BATCH__LANE_GROUP at a time, so that their rays share the ray trace kernel, while each
+    //      transhorizon group is evaluated on its own
+    vector<int> lane_groups;    // first group of each lane group, followed by the end of the last one
+    for (int g = 0; g < (int)plan.groups.size(); g++)
+    {
+        const BatchGroup& group = plan.groups[g];
+        P528Context* context = plan.contexts[group.context].get();
+
+        bool is_los = plan.is_prepared[group.context] && context->path.d_ML__km - group.d__km > 0.001;
+        bool is_continued = g > 0 && is_los && plan.groups[g - 1].context == group.context &&
+            g - lane_groups.back() < BATCH__LANE_GROUP;
+
+        if (!is_continued)
+            lane_groups.push_back(g);
+    }
+    int L = (int)lane_groups.size();
+    lane_groups.push_back((int)plan.groups.size());
+
+    batch_stats.lane_groups = L;
+
+    cost.assign(L, 0);
+    for (int k = 0; k < L; k++)
+    {
+        for (int g = lane_groups[k]; g < lane_groups[k + 1]; g++)
+        {
+            P528Context* context = plan.contexts[plan.groups[g].context].get();
+            cost[k] += EstimatePathCost(context->h_1__meter / 1000, context->h_2__meter / 1000, plan.groups[g].d__km);
+        }
+    }
+
+    ParallelFor(L, cost, [&](int k)
+    {
+        P528Context* context = plan.contexts[plan.groups[lane_groups[k]].context].get();
+
+        TroposcatterParams tropo;
+        LineOfSightParams los_params;
+
+        // paths that fail validation return early, and are evaluated one at a time
+        vector<double> d_valid__km;
+        vector<vector<int>> valid_paths;
+        vector<vector<double>> valid_p;
+        for (int g = lane_groups[k]; g < lane_groups[k + 1]; g++)
+        {
+            const BatchGroup& group = plan.groups[g];
+
+            vector<int> paths;
+            vector<double> p_paths;
+            for (int i : group.paths)
+            {
+                int input_warnings = WARNING__NO_WARNINGS;
+                if (ValidateInputs(group.d__km, context->h_1__meter, context->h_2__meter, context->f__mhz,
+                    context->T_pol, p[i], &input_warnings) == SUCCESS)
+                {
+                    paths.push_back(i);
+                    p_paths.push_back(p[i]);
+                }
+                else
+                {
+                    Result result;
+                    rtns[i] = EvaluateContext(context, group.d__km, p[i], &result, &tropo, &los_params);
+                    StoreBatchResult((long long)i * stride, result, rtns[i], A__db, A_fs__db, A_a__db,
+                        propagation_mode, warnings, rtn);
+                }
+            }
+
+            if (!paths.empty())
+            {
+                d_valid__km.push_back(group.d__km);
+                valid_paths.push_back(move(paths));
+                valid_p.push_back(move(p_paths));
+            }
+        }
+
+        if (d_valid__km.empty())
+            return;
+
+        // the time-independent results of every distance, with their rays traced together
+        int N = (int)d_valid__km.size();
+        vector<MedianResult> medians(N);
+        vector<LineOfSightParams> los_params_lanes(N);
+        EvaluateMedianLanes(context, N, d_valid__km.data(), medians.data(), los_params_lanes.data());
+
+        // the time percentages of each distance share its time-independent results
+        for (int j = 0; j < N; j++)
+        {
+            vector<Result> results(valid_paths[j].size());
+            ValidateContextMultiP(context, d_valid__km[j], valid_p[j].data(), (int)valid_p[j].size(), results.data());
+            TimeVariabilityMultiP(context, d_valid__km[j], &medians[j], valid_p[j].data(), (int)valid_p[j].size(),
+                results.data());
+
+            for (size_t m = 0; m < valid_paths[j].size(); m++)
+            {
+                int i = valid_paths[j][m];
+                rtns[i] = (results[m].warnings == WARNING__NO_WARNINGS) ? SUCCESS : SUCCESS_WITH_WARNINGS;
+                StoreBatchResult((long long)i * stride, results[m], rtns[i], A__db, A_fs__db, A_a__db,
+                    propagation_mode, warnings, rtn);
+            }
+        }
+    });
+
+    //
+    // Evaluate each lane group
+    /////////////////////////////////////////////
+
+    // the return code does not depend on the order the paths were evaluated in
+    int rtn_batch = SUCCESS;
+    for (int i = 0; i < n; i++)
+        rtn_batch = CombineBatchReturn(rtn_batch, rtns[i]);
+
+    if (stats != nullptr)
+        *stats = batch_stats;
+
+    return rtn_batch;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Evaluates P.528 for a batch of paths in parallel.  See
+ |                P528_BatchParallel_Ex().
+ |
+ *===========================================================================*/
+int P528_BatchParallel(int n, const double* d__km, const double* h_1__meter, const double* h_2__meter,
+    const double* f__mhz, const int* T_pol, const double* p,
+    double* A__db, double* A_fs__db, double* A_a__db, int* propagation_mode, int* warnings, int* rtn,
+    int stride)
+{
+    return P528_BatchParallel_Ex(n, d__km, h_1__meter, h_2__meter, f__mhz, T_pol, p,
+        A__db, A_fs__db, A_a__db, propagation_mode, warnings, rtn, stride, nullptr);
+}
\ No newline at end of file
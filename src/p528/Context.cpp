@@ -0,0 +1,685 @@
+#include <math.h>
+#include "../../include/p528.h"
+#include "../../include/p676.h"
+
+/*=============================================================================
+ |
+ |  Description:  This function computes the distance- and time-
+ |                independent parts of Annex 2, Section 3 of
+ |                Recommendation ITU-R P.528-5, "Propagation curves for
+ |                aeronautical mobile and radionavigation services using
+ |                the VHF, UHF and SHF bands".  Input values are assumed
+ |                to have already been validated.  Transhorizon paths also
+ |                require InitializeTranshorizon().
+ |
+ |        Input:  h_1__meter        - Height of the low terminal, in meters
+ |                h_2__meter        - Height of the high terminal, in meters
+ |                f__mhz            - Frequency, in MHz
+ |                T_pol             - Code indicating either polarization
+ |                                      + 0 : POLARIZATION__HORIZONTAL
+ |                                      + 1 : POLARIZATION__VERTICAL
+ |
+ |      Outputs:  context           - Struct containing the prepared path
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void InitializeContext(double h_1__meter, double h_2__meter, double f__mhz, int T_pol,
+    P528Context* context)
+{
+    context->h_1__meter = h_1__meter;
+    context->h_2__meter = h_2__meter;
+    context->f__mhz = f__mhz;
+    context->T_pol = T_pol;
+
+    Terminal* terminal_1 = &context->terminal_1;
+    Terminal* terminal_2 = &context->terminal_2;
+
+    /////////////////////////////////////////////
+    // Compute terminal geometries
+    //
+
+    // Step 1 for low terminal
+    terminal_1->h_r__km = h_1__meter / 1000;
+    GetTerminalGeometry(f__mhz, terminal_1);
+
+    // Step 1 for high terminal
+    terminal_2->h_r__km = h_2__meter / 1000;
+    GetTerminalGeometry(f__mhz, terminal_2);
+
+    //
+    // Compute terminal geometries
+    /////////////////////////////////////////////
+
+    // Sample the ray optics of the terminal pair for the line-of-sight searches
+    BuildRayOpticsTable(terminal_1, terminal_2, &context->ray_optics);
+
+    InitializeContextFrequency(context);
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function computes the parts of InitializeContext()
+ |                that follow the terminal geometries and the ray optics.
+ |                Of the context, only the terminal absorption and these
+ |                parts depend on the frequency, so a context at another
+ |                frequency can reuse the geometry of an existing one.
+ |
+ | Input/Output:  context           - Struct containing the prepared path,
+ |                                    with its inputs, terminal geometries
+ |                                    and ray optics set
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void InitializeContextFrequency(P528Context* context)
+{
+    Terminal* terminal_1 = &context->terminal_1;
+    Terminal* terminal_2 = &context->terminal_2;
+    Path* path = &context->path;
+    double f__mhz = context->f__mhz;
+    int T_pol = context->T_pol;
+
+    // Step 2
+    path->d_ML__km = terminal_1->d_r__km + terminal_2->d_r__km;                     // [Eqn 3-1]
+
+    /////////////////////////////////////////////
+    // Smooth earth diffraction line calculations
+    //
+
+    // Step 3.1
+    double d_3__km = path->d_ML__km + 0.5 * pow(pow(a_e__km, 2) / f__mhz, THIRD);   // [Eqn 3-2]
+    double d_4__km = path->d_ML__km + 1.5 * pow(pow(a_e__km, 2) / f__mhz, THIRD);   // [Eqn 3-3]
+
+    // Step 3.2
+    double A_3__db = SmoothEarthDiffraction(terminal_1->d_r__km, terminal_2->d_r__km, f__mhz, d_3__km, T_pol);
+    double A_4__db = SmoothEarthDiffraction(terminal_1->d_r__km, terminal_2->d_r__km, f__mhz, d_4__km, T_pol);
+
+    // Step 3.3
+    double M_d = (A_4__db - A_3__db) / (d_4__km - d_3__km);     // [Eqn 3-4]
+    double A_d0 = A_4__db - M_d * d_4__km;                      // [Eqn 3-5]
+
+    // Step 3.4
+    context->A_dML__db = (M_d * path->d_ML__km) + A_d0;         // [Eqn 3-6]
+    path->d_d__km = -(A_d0 / M_d);                              // [Eqn 3-7]
+
+    //
+    // End smooth earth diffraction line calculations
+    /////////////////////////////////////////////////
+
+    context->M_d = M_d;
+    context->A_d0 = A_d0;
+
+    // Line-of-sight parameters that do not depend on the path distance
+    InitializeLineOfSight(path, terminal_1, terminal_2, &context->ray_optics, f__mhz, -context->A_dML__db, T_pol,
+        &context->psi_limit, &context->A_d_0__db);
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function completes a context from InitializeContext()
+ |                with the parameters only needed for transhorizon paths:
+ |                K_LOS and the Step 6 search for the crossover between the
+ |                diffraction and troposcatter models
+ |
+ | Input/Output:  context           - Struct containing the prepared path
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void InitializeTranshorizon(P528Context* context)
+{
+    Terminal* terminal_1 = &context->terminal_1;
+    Terminal* terminal_2 = &context->terminal_2;
+    Path* path = &context->path;
+
+    // get K_LOS, which does not depend on the time percentage
+    context->K_LOS = LineOfSightK(path, terminal_1, terminal_2, &context->ray_optics, &context->los_params,
+        context->f__mhz, -context->A_dML__db, context->psi_limit, context->A_d_0__db, path->d_ML__km - 1, context->T_pol);
+
+    InitializeTroposcatter(terminal_1, terminal_2, context->f__mhz, &context->troposcatter);
+
+    // Step 6.  Search past horizon to find crossover point between Diffraction and Troposcatter models
+    context->warnings = WARNING__NO_WARNINGS;
+    TranshorizonSearch(path, &context->troposcatter, context->A_dML__db, &context->M_d, &context->A_d0,
+        &context->d_crx__km, &context->CASE, &context->warnings);
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function computes the distance-dependent, but time-
+ |                independent, parts of Annex 2, Section 3 of
+ |                Recommendation ITU-R P.528-5, "Propagation curves for
+ |                aeronautical mobile and radionavigation services using
+ |                the VHF, UHF and SHF bands", for a path prepared by
+ |                InitializeContext() and InitializeTranshorizon().  The
+ |                time variability is applied by TimeVariability().
+ |                The context is not modified, so it may be shared by
+ |                concurrent callers.
+ |
+ |        Input:  context           - Struct containing the prepared path
+ |                d__km             - Path distance, in km.  Assumed to
+ |                                    have already been validated
+ |
+ |      Outputs:  median            - Struct containing the time-
+ |                                    independent results of the path
+ |                tropo             - Troposcatter parameters
+ |                los_params        - Line-of-sight parameters
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void EvaluateMedian(P528Context* context, double d__km, MedianResult* median,
+    TroposcatterParams* tropo, LineOfSightParams* los_params)
+{
+    Terminal* terminal_1 = &context->terminal_1;
+    Terminal* terminal_2 = &context->terminal_2;
+    Path* path = &context->path;
+    double f__mhz = context->f__mhz;
+
+    // Step 4.  If the path is in the Line-of-Sight range, call LOS and then exit
+    if (path->d_ML__km - d__km > 0.001)
+    {
+        LineOfSight(path, terminal_1, terminal_2, &context->ray_optics, los_params, f__mhz, -context->A_dML__db,
+            context->psi_limit, context->A_d_0__db, d__km, context->T_pol, median);
+    }
+    else
+    {
+        TranshorizonPath(context, d__km, median, tropo, los_params);
+
+        SlantPathAttenuationResult result_v;
+        SlantPathAttenuation(f__mhz / 1000, 0, tropo->h_v__km, PI / 2, &result_v);
+
+        TranshorizonMedian(context, d__km, result_v.A_gas__db, result_v.a__km, median);
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function computes the time-independent results of a
+ |                transhorizon path, the parts of EvaluateMedian() before
+ |                the ray to the common volume is traced: the terrain
+ |                attenuation and the variability parameters
+ |
+ |        Input:  context           - Struct containing the prepared path
+ |                d__km             - Path distance, in km
+ |
+ |      Outputs:  median            - Struct containing the time-
+ |                                    independent results of the path,
+ |                                    completed by TranshorizonMedian()
+ |                tropo             - Troposcatter parameters, including
+ |                                    the height of the common volume
+ |                los_params        - Line-of-sight parameters
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void TranshorizonPath(P528Context* context, double d__km, MedianResult* median,
+    TroposcatterParams* tropo, LineOfSightParams* los_params)
+{
+    Terminal* terminal_1 = &context->terminal_1;
+    Terminal* terminal_2 = &context->terminal_2;
+    double f__mhz = context->f__mhz;
+
+    double K_LOS = context->K_LOS;
+    *los_params = context->los_params;
+
+    // Step 6.  Crossover point between Diffraction and Troposcatter models, from InitializeContext()
+    int CASE = context->CASE;
+    double d_crx__km = context->d_crx__km;
+    double M_d = context->M_d;
+    double A_d0 = context->A_d0;
+    median->warnings = context->warnings;
+
+    /////////////////////////////////////////////
+    // Compute terrain attenuation, A_T__db
+    //
+
+    // Step 7.1 and 7.2
+    double A_d__db;
+    TroposcatterDistances(&context->troposcatter, &d__km, 1, M_d, A_d0, tropo, &A_d__db);
+
+    // Step 7.3
+    double A_T__db;
+    if (d__km < d_crx__km)
+    {
+        // always in diffraction if less than d_crx
+        A_T__db = A_d__db;
+        median->propagation_mode = PROP_MODE__DIFFRACTION;
+    }
+    else
+    {
+        if (CASE == CASE_1)
+        {
+            // select the lower loss mode of propagation
+            if (tropo->A_s__db <= A_d__db)
+            {
+                A_T__db = tropo->A_s__db;
+                median->propagation_mode = PROP_MODE__SCATTERING;
+            }
+            else
+            {
+                A_T__db = A_d__db;
+                median->propagation_mode = PROP_MODE__DIFFRACTION;
+            }
+        }
+        else // CASE_2
+        {
+            A_T__db = tropo->A_s__db;
+            median->propagation_mode = PROP_MODE__SCATTERING;
+        }
+    }
+
+    median->A_T__db = A_T__db;
+
+    //
+    // Compute terrain attenuation, A_T__db
+    /////////////////////////////////////////////
+
+    /////////////////////////////////////////////
+    // Compute variability
+    //
+
+    // f_theta_h is unity for transhorizon paths
+    median->f_theta_h = 1;
+
+    // compute the 50% of the long-term variability distribution
+    double dummy;
+    LongTermVariability(terminal_1->d_r__km, terminal_2->d_r__km, d__km, f__mhz, 50, median->f_theta_h, -A_T__db, &median->Y_e_50__db, &dummy);
+
+    // K-value of the Nakagami-Rice distribution
+    double ANGLE = 0.02617993878;   // 1.5 deg
+    if (tropo->theta_s >= ANGLE)        // theta_s > 1.5 deg
+        median->K__db = 20;
+    else if (tropo->theta_s <= 0.0)
+        median->K__db = K_LOS;
+    else
+        median->K__db = (tropo->theta_s * (20.0 - K_LOS) / ANGLE) + K_LOS;
+
+    //
+    // Compute variability
+    /////////////////////////////////////////////
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function completes the time-independent results of a
+ |                transhorizon path from TranshorizonPath() with the ray
+ |                traced from the surface to the common volume: the
+ |                atmospheric absorption and free-space loss
+ |
+ |        Input:  context           - Struct containing the prepared path
+ |                d__km             - Path distance, in km
+ |                A_gas__db         - Gaseous absorption along the ray
+ |                                    traced from the surface to the
+ |                                    common volume, in dB
+ |                a__km             - Length of the traced ray, in km
+ |
+ | Input/Output:  median            - Struct containing the time-
+ |                                    independent results of the path
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void TranshorizonMedian(P528Context* context, double d__km, double A_gas__db, double a__km,
+    MedianResult* median)
+{
+    Terminal* terminal_1 = &context->terminal_1;
+    Terminal* terminal_2 = &context->terminal_2;
+    double f__mhz = context->f__mhz;
+
+    /////////////////////////////////////////////
+    // Atmospheric absorption for transhorizon path
+    //
+
+    median->A_a__db = terminal_1->A_a__db + terminal_2->A_a__db + 2 * A_gas__db;    // [Eqn 3-17]
+
+    //
+    // Atmospheric absorption for transhorizon path
+    /////////////////////////////////////////////
+
+    /////////////////////////////////////////////
+    // Compute free-space loss
+    //
+
+    double r_fs__km = terminal_1->a__km + terminal_2->a__km + 2 * a__km;            // [Eqn 3-18]
+    median->A_fs__db = 20.0 * log10(f__mhz) + 20.0 * log10(r_fs__km) + 32.45;       // [Eqn 3-19]
+
+    //
+    // Compute free-space loss
+    /////////////////////////////////////////////
+
+    median->d__km = d__km;
+    median->theta_h1__rad = -terminal_1->theta__rad;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Computes the same results as EvaluateMedian() for several
+ |                distances of a context.  The rays between the terminals
+ |                of the line-of-sight distances are traced together by
+ |                SlantPathAttenuationLanes(), so that they share the
+ |                vector lanes of the ray trace kernel, while transhorizon
+ |                distances are evaluated one at a time.
+ |                The context is not modified, so it may be shared by
+ |                concurrent callers.
+ |
+ |        Input:  context           - Struct containing the prepared path
+ |                N                 - Number of distances
+ |                d__km             - Path distances, in km.  Assumed to
+ |                                    have already been validated
+ |
+ |      Outputs:  medians           - Structs containing the time-
+ |                                    independent results of each path
+ |                los_params        - Line-of-sight parameters of each path
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void EvaluateMedianLanes(P528Context* context, int N, const double* d__km, MedianResult* medians,
+    LineOfSightParams* los_params)
+{
+    Terminal* terminal_1 = &context->terminal_1;
+    Terminal* terminal_2 = &context->terminal_2;
+    double f__mhz = context->f__mhz;
+
+    // line-of-sight distances, with the reflection coefficient and elevation angle of their rays
+    vector<int> los;
+    vector<double> R_Tg;
+    vector<double> beta_1__rad;
+
+    TroposcatterParams tropo;
+    for (int i = 0; i < N; i++)
+    {
+        if (context->path.d_ML__km - d__km[i] > 0.001)
+        {
+            double R_Tg_i;
+            LineOfSightPath(&context->path, terminal_1, terminal_2, &context->ray_optics, &los_params[i], f__mhz,
+                -context->A_dML__db, context->psi_limit, context->A_d_0__db, d__km[i], context->T_pol, &R_Tg_i);
+
+            los.push_back(i);
+            R_Tg.push_back(R_Tg_i);
+            beta_1__rad.push_back(PI / 2 - los_params[i].theta_h1__rad);
+        }
+        else
+            EvaluateMedian(context, d__km[i], &medians[i], &tropo, &los_params[i]);
+    }
+
+    vector<SlantPathAttenuationResult> result_slant(los.size());
+    SlantPathAttenuationLanes(f__mhz / 1000, terminal_1->h_r__km, terminal_2->h_r__km, beta_1__rad.data(),
+        (int)los.size(), result_slant.data());
+
+    for (size_t k = 0; k < los.size(); k++)
+    {
+        int i = los[k];
+        LineOfSightMedian(terminal_1, terminal_2, &los_params[i], f__mhz, d__km[i], R_Tg[k],
+            result_slant[k].A_gas__db, result_slant[k].a__km, &medians[i]);
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function computes the distance- and time-dependent
+ |                parts of Annex 2, Section 3 of Recommendation ITU-R
+ |                P.528-5, "Propagation curves for aeronautical mobile and
+ |                radionavigation services using the VHF, UHF and SHF
+ |                bands", for a path prepared by InitializeContext() and
+ |                InitializeTranshorizon().
+ |                The context is not modified, so it may be shared by
+ |                concurrent callers.
+ |
+ |        Input:  context           - Struct containing the prepared path
+ |                d__km             - Path distance, in km
+ |                p                 - Time percentage
+ |
+ |      Outputs:  result            - Result structure containing various
+ |                                    computed parameters
+ |                tropo             - Troposcatter parameters
+ |                los_params        - Line-of-sight parameters
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int EvaluateContext(P528Context* context, double d__km, double p, Result* result,
+    TroposcatterParams* tropo, LineOfSightParams* los_params)
+{
+    return EvaluateContextMultiP(context, d__km, &p, 1, result, tropo, los_params);
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function computes the distance- and time-dependent
+ |                parts of Annex 2, Section 3 of Recommendation ITU-R
+ |                P.528-5, "Propagation curves for aeronautical mobile and
+ |                radionavigation services using the VHF, UHF and SHF
+ |                bands", for several time percentages.  The time-
+ |                independent results are computed once and shared.
+ |                The context is not modified, so it may be shared by
+ |                concurrent callers.
+ |
+ |        Input:  context           - Struct containing the prepared path
+ |                d__km             - Path distance, in km
+ |                p                 - Time percentages
+ |                N                 - Number of time percentages
+ |
+ |      Outputs:  results           - Result structures, one for each time
+ |                                    percentage
+ |                tropo             - Troposcatter parameters
+ |                los_params        - Line-of-sight parameters
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int EvaluateContextMultiP(P528Context* context, double d__km, const double* p, int N, Result* results,
+    TroposcatterParams* tropo, LineOfSightParams* los_params)
+{
+    int rtn = ValidateContextMultiP(context, d__km, p, N, results);
+
+    if (rtn == ERROR_HEIGHT_AND_DISTANCE)
+        return SUCCESS;
+    else if (rtn != SUCCESS)
+        return rtn;
+
+    MedianResult median;
+    EvaluateMedian(context, d__km, &median, tropo, los_params);
+
+    return TimeVariabilityMultiP(context, d__km, &median, p, N, results);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Resets the results of several time percentages of a path,
+ |                and validates their inputs.  Every time percentage is
+ |                validated, and an invalid input takes precedence over a
+ |                zero length path.
+ |
+ |        Input:  context           - Struct containing the prepared path
+ |                d__km             - Path distance, in km
+ |                p                 - Time percentages
+ |                N                 - Number of time percentages
+ |
+ |      Outputs:  results           - Result structures, one for each time
+ |                                    percentage, holding the input warnings
+ |
+ |      Returns:  rtn               - SUCCESS, ERROR_HEIGHT_AND_DISTANCE for
+ |                                    a zero length path, or error code
+ |
+ *===========================================================================*/
+int ValidateContextMultiP(P528Context* context, double d__km, const double* p, int N, Result* results)
+{
+    int rtn = SUCCESS;
+
+    for (int i = 0; i < N; i++)
+    {
+        Result* result = &results[i];
+
+        // reset Results struct
+        result->A_fs__db = 0;
+        result->A_a__db = 0;
+        result->A__db = 0;
+        result->d__km = 0;
+        result->theta_h1__rad = 0;
+        result->propagation_mode = PROP_MODE__NOT_SET;
+        result->warnings = WARNING__NO_WARNINGS;
+
+        // every time percentage is validated before any are evaluated, and an invalid input takes precedence
+        // over a zero length path
+        int err = ValidateInputs(d__km, context->h_1__meter, context->h_2__meter, context->f__mhz,
+            context->T_pol, p[i], &result->warnings);
+        if (err != SUCCESS && (rtn == SUCCESS || rtn == ERROR_HEIGHT_AND_DISTANCE))
+            rtn = err;
+    }
+
+    return rtn;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Applies the time variability to the time-independent
+ |                results of a path, for several time percentages.
+ |
+ |        Input:  context           - Struct containing the prepared path
+ |                d__km             - Path distance, in km
+ |                median            - Struct containing the time-
+ |                                    independent results of the path
+ |                p                 - Time percentages
+ |                N                 - Number of time percentages
+ |
+ | Input/Output:  results           - Result structures, one for each time
+ |                                    percentage, as set by
+ |                                    ValidateContextMultiP()
+ |
+ |      Returns:  rtn               - SUCCESS or SUCCESS_WITH_WARNINGS
+ |
+ *===========================================================================*/
+int TimeVariabilityMultiP(P528Context* context, double d__km, MedianResult* median, const double* p, int N,
+    Result* results)
+{
+    int rtn = SUCCESS;
+
+    for (int i = 0; i < N; i++)
+    {
+        TimeVariability(&context->terminal_1, &context->terminal_2, d__km, context->f__mhz, median, p[i], &results[i]);
+
+        if (results[i].warnings != WARNING__NO_WARNINGS)
+            rtn = SUCCESS_WITH_WARNINGS;
+    }
+
+    return rtn;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Prepares a reusable path context for a terminal pair and
+ |                frequency.  Everything that does not depend on the path
+ |                distance or time percentage (terminal geometries, the
+ |                smooth earth diffraction line, the line-of-sight setup
+ |                and the transhorizon search) is computed once here.
+ |                Release the context with P528_ReleaseContext().
+ |
+ |        Input:  h_1__meter        - Height of the low terminal, in meters
+ |                h_2__meter        - Height of the high terminal, in meters
+ |                f__mhz            - Frequency, in MHz
+ |                T_pol             - Code indicating either polarization
+ |                                      + 0 : POLARIZATION__HORIZONTAL
+ |                                      + 1 : POLARIZATION__VERTICAL
+ |
+ |      Outputs:  context           - Handle to the prepared context, or
+ |                                    null on error
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_PrepareContext(double h_1__meter, double h_2__meter, double f__mhz,
+    int T_pol, P528Context** context)
+{
+    *context = nullptr;
+
+    int warnings = WARNING__NO_WARNINGS;
+    int err = ValidateTerminalInputs(h_1__meter, h_2__meter, f__mhz, T_pol, &warnings);
+    if (err != SUCCESS)
+        return err;
+
+    *context = new P528Context;
+    InitializeContext(h_1__meter, h_2__meter, f__mhz, T_pol, *context);
+    InitializeTranshorizon(*context);
+
+    if (warnings == WARNING__NO_WARNINGS)
+        return SUCCESS;
+    else
+        return SUCCESS_WITH_WARNINGS;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Evaluates P.528 for a path distance and time percentage
+ |                using a context from P528_PrepareContext().  Results are
+ |                identical to calling P528() with the same inputs.
+ |
+ |        Input:  context           - Handle to the prepared context
+ |                d__km             - Path distance, in km
+ |                p                 - Time percentage
+ |
+ |      Outputs:  result            - Result structure containing various
+ |                                    computed parameters
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_EvaluateContext(P528Context* context, double d__km, double p, Result* result)
+{
+    TroposcatterParams tropo;
+    LineOfSightParams los_params;
+
+    return EvaluateContext(context, d__km, p, result, &tropo, &los_params);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Evaluates P.528 for a path distance and several time
+ |                percentages using a context from P528_PrepareContext().
+ |                Everything but the time variability is computed once.
+ |                Results are identical to calling P528() with the same
+ |                inputs.
+ |
+ |        Input:  context           - Handle to the prepared context
+ |                d__km             - Path distance, in km
+ |                p                 - Time percentages, or null for the
+ |                                    TIME_PERCENTAGES__COUNT percentages
+ |                                    of data::P
+ |                N                 - Number of time percentages
+ |
+ |      Outputs:  results           - Result structures, one for each time
+ |                                    percentage
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_EvaluateContextMultiP(P528Context* context, double d__km, const double* p, int N,
+    Result* results)
+{
+    if (N < 1 || (p == nullptr && N != TIME_PERCENTAGES__COUNT))
+        return ERROR_VALIDATION__PERCENT_COUNT;
+
+    if (p == nullptr)
+        p = data::P.data();
+
+    TroposcatterParams tropo;
+    LineOfSightParams los_params;
+
+    return EvaluateContextMultiP(context, d__km, p, N, results, &tropo, &los_params);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Releases a context from P528_PrepareContext()
+ |
+ |        Input:  context           - Handle to the prepared context
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void P528_ReleaseContext(P528Context* context)
+{
+    delete context;
+}
@@ -0,0 +1,270 @@
+#include <math.h>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+
+// before p528.h, whose constants are macros
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "../../include/p528.h"
+
+// Executor settings, applied the next time the pool is used
+static atomic<int> executor_thread_count(0);        // 0 uses every hardware thread
+static atomic<bool> executor_use_affinity(false);
+
+// Persistent worker threads.  The calling thread always works as worker 0, so the pool holds one fewer thread
+// than the executor uses.
+struct ThreadPool
+{
+    vector<thread> threads;
+    bool use_affinity = false;
+
+    mutex job_mutex;
+    condition_variable job_started;
+    condition_variable job_finished;
+
+    const function<void(int)>* job = nullptr;   // called with the worker index
+    int workers = 0;                            // workers taking part in the current job, including the caller
+    long long generation = 0;                   // incremented for every job
+    int running = 0;                            // pool threads still working on the current job
+    bool is_stopping = false;
+};
+
+// The pool is never destroyed, since its threads cannot be joined safely while the library is unloaded
+static ThreadPool& pool = *new ThreadPool();
+static mutex pool_mutex;                        // one job at a time
+
+static void PinThread(thread& worker, int cpu)
+{
+#if defined(_WIN32)
+    if (cpu < 64)
+        SetThreadAffinityMask(worker.native_handle(), (DWORD_PTR)1 << cpu);
+#elif defined(__linux__)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    pthread_setaffinity_np(worker.native_handle(), sizeof(cpus), &cpus);
+#endif
+}
+
+static void WorkerLoop(int w, long long seen)
+{
+    while (true)
+    {
+        const function<void(int)>* job;
+        {
+            unique_lock<mutex> lock(pool.job_mutex);
+            pool.job_started.wait(lock, [&] { return pool.is_stopping || pool.generation != seen; });
+
+            if (pool.is_stopping)
+                return;
+
+            seen = pool.generation;
+            job = (w < pool.workers) ? pool.job : nullptr;
+        }
+
+        if (job != nullptr)
+            (*job)(w);
+
+        unique_lock<mutex> lock(pool.job_mutex);
+        if (--pool.running == 0)
+            pool.job_finished.notify_one();
+    }
+}
+
+static void StopPool()
+{
+    {
+        lock_guard<mutex> lock(pool.job_mutex);
+        pool.is_stopping = true;
+    }
+    pool.job_started.notify_all();
+
+    for (thread& worker : pool.threads)
+        worker.join();
+
+    pool.threads.clear();
+    pool.is_stopping = false;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Number of threads the executor uses, from the thread
+ |                count set by P528_SetThreadCount()
+ |
+ |      Returns:  threads       - Number of threads, at least 1
+ |
+ *===========================================================================*/
+int GetExecutorThreads()
+{
+    int threads = executor_thread_count;
+    if (threads == 0)
+        threads = thread::hardware_concurrency();
+
+    return MAX(threads, 1);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Runs tasks in parallel on the executor's thread pool.
+ |                Tasks are dealt to the workers in order of decreasing
+ |                cost, so that the most expensive tasks start first and
+ |                each worker gets a similar mix.  A worker that runs out
+ |                of tasks steals the cheapest remaining task of another
+ |                worker.  Each task must only write its own outputs, so
+ |                that results do not depend on the number of threads or
+ |                on which thread runs a task.
+ |
+ |        Input:  N             - Number of tasks
+ |                cost          - Estimated cost of each task, in any unit
+ |                task          - Function running the task with the given
+ |                                index
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void ParallelFor(int N, const vector<double>& cost, const function<void(int)>& task)
+{
+    vector<int> order(N);
+    for (int i = 0; i < N; i++)
+        order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return cost[a] > cost[b]; });
+
+    int T = MIN(GetExecutorThreads(), N);
+    if (T <= 1)
+    {
+        for (int i : order)
+            task(i);
+        return;
+    }
+
+    // one queue per worker, dealt round robin from the most expensive task
+    vector<deque<int>> queues(T);
+    vector<mutex> queue_mutexes(T);
+    for (int k = 0; k < N; k++)
+        queues[k % T].push_back(order[k]);
+
+    function<void(int)> job = [&](int w)
+    {
+        while (true)
+        {
+            int i = -1;
+
+            // own queue, most expensive first
+            {
+                lock_guard<mutex> lock(queue_mutexes[w]);
+                if (!queues[w].empty())
+                {
+                    i = queues[w].front();
+                    queues[w].pop_front();
+                }
+            }
+
+            // steal the cheapest task of another worker
+            for (int v = 1; v < T && i < 0; v++)
+            {
+                int victim = (w + v) % T;
+
+                lock_guard<mutex> lock(queue_mutexes[victim]);
+                if (!queues[victim].empty())
+                {
+                    i = queues[victim].back();
+                    queues[victim].pop_back();
+                }
+            }
+
+            // every task was queued up front, so empty queues mean the work is done
+            if (i < 0)
+                return;
+
+            task(i);
+        }
+    };
+
+    lock_guard<mutex> lock(pool_mutex);
+
+    // rebuild the pool if its settings changed
+    int threads = GetExecutorThreads() - 1;
+    if ((int)pool.threads.size() != threads || pool.use_affinity != executor_use_affinity)
+    {
+        StopPool();
+
+        pool.use_affinity = executor_use_affinity;
+        for (int w = 1; w <= threads; w++)
+        {
+            pool.threads.emplace_back(WorkerLoop, w, pool.generation);      // only later jobs are run
+            if (pool.use_affinity)
+                PinThread(pool.threads.back(), w % MAX((int)thread::hardware_concurrency(), 1));
+        }
+    }
+
+    {
+        lock_guard<mutex> job_lock(pool.job_mutex);
+        pool.job = &job;
+        pool.workers = T;
+        pool.running = (int)pool.threads.size();
+        pool.generation++;
+    }
+    pool.job_started.notify_all();
+
+    job(0);
+
+    unique_lock<mutex> job_lock(pool.job_mutex);
+    pool.job_finished.wait(job_lock, [&] { return pool.running == 0; });
+    pool.job = nullptr;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Sets the number of threads used by the parallel batch
+ |                executor, including the calling thread
+ |
+ |        Input:  threads           - Number of threads.  0 uses every
+ |                                    hardware thread
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_SetThreadCount(int threads)
+{
+    if (threads < 0)
+        return ERROR_VALIDATION__THREAD_COUNT;
+
+    executor_thread_count = threads;
+
+    return SUCCESS;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Selects whether the worker threads of the parallel batch
+ |                executor are pinned to logical processors.  Worker w is
+ |                pinned to processor w, wrapping around the number of
+ |                hardware threads.  The calling thread is never pinned.
+ |                Pinning is supported on Windows and Linux, and ignored
+ |                elsewhere.
+ |
+ |        Input:  use_affinity      - Flag for thread affinity
+ |                                      + 0 : Threads are not pinned
+ |                                      + 1 : Threads are pinned
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_SetThreadAffinity(int use_affinity)
+{
+    if (use_affinity != 0 && use_affinity != 1)
+        return ERROR_VALIDATION__THREAD_AFFINITY;
+
+    executor_use_affinity = (use_affinity == 1);
+
+    return SUCCESS;
+}
\ No newline at end of file
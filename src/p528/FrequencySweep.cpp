@@ -0,0 +1,199 @@
+#include <math.h>
+#include "../../include/p528.h"
+#include "../../include/p676.h"
+
+/*=============================================================================
+ |
+ |  Description:  Evaluates a path at a contiguous block of frequencies,
+ |                for P528_FrequencySweep().  The rays to each terminal,
+ |                between the terminals and to the common volume are each
+ |                traced once for the block, and only their absorption is
+ |                integrated at each frequency.
+ |
+ |        Input:  d__km             - Path distance, in km
+ |                h_1__meter        - Height of the low terminal, in meters
+ |                h_2__meter        - Height of the high terminal, in meters
+ |                f__mhz            - Frequencies, in MHz
+ |                N                 - Number of frequencies
+ |                T_pol             - Code indicating either polarization
+ |                p                 - Time percentage
+ |                ray_optics        - Ray optics of the terminal pair
+ |
+ | Input/Output:  results           - Result structures, one for each
+ |                                    frequency, holding the input warnings
+ |
+ |      Returns:  rtn               - SUCCESS or SUCCESS_WITH_WARNINGS
+ |
+ *===========================================================================*/
+static int SweepFrequencies(double d__km, double h_1__meter, double h_2__meter, const double* f__mhz, int N,
+    int T_pol, double p, const RayOpticsTable& ray_optics, Result* results)
+{
+    vector<double> f__ghz(N);
+    for (int i = 0; i < N; i++)
+        f__ghz[i] = f__mhz[i] / 1000;
+
+    // Step 1 for both terminals, at every frequency
+    vector<Terminal> terminals_1(N);
+    vector<Terminal> terminals_2(N);
+    TerminalGeometrySweep(h_1__meter / 1000, f__mhz, N, terminals_1.data());
+    TerminalGeometrySweep(h_2__meter / 1000, f__mhz, N, terminals_2.data());
+
+    vector<P528Context> contexts(N);
+    for (int i = 0; i < N; i++)
+    {
+        P528Context* context = &contexts[i];
+        context->h_1__meter = h_1__meter;
+        context->h_2__meter = h_2__meter;
+        context->f__mhz = f__mhz[i];
+        context->T_pol = T_pol;
+        context->terminal_1 = terminals_1[i];
+        context->terminal_2 = terminals_2[i];
+        context->ray_optics = ray_optics;
+
+        InitializeContextFrequency(context);
+    }
+
+    vector<MedianResult> medians(N);
+    vector<LineOfSightParams> los_params(N);
+    vector<SlantPathAttenuationResult> result_slant(N);
+
+    // d_ML, and so the region of the path, is the same at every frequency
+    if (contexts[0].path.d_ML__km - d__km > 0.001)
+    {
+        vector<double> R_Tg(N);
+        for (int i = 0; i < N; i++)
+        {
+            P528Context* context = &contexts[i];
+            LineOfSightPath(&context->path, &context->terminal_1, &context->terminal_2, &context->ray_optics,
+                &los_params[i], f__mhz[i], -context->A_dML__db, context->psi_limit, context->A_d_0__db, d__km,
+                T_pol, &R_Tg[i]);
+        }
+
+        // the ray between the terminals leaves at the same elevation angle at every frequency
+        SlantPathAttenuationSweep(f__ghz.data(), N, h_1__meter / 1000, h_2__meter / 1000,
+            PI / 2 - los_params[0].theta_h1__rad, result_slant.data());
+
+        for (int i = 0; i < N; i++)
+            LineOfSightMedian(&contexts[i].terminal_1, &contexts[i].terminal_2, &los_params[i], f__mhz[i], d__km,
+                R_Tg[i], result_slant[i].A_gas__db, result_slant[i].a__km, &medians[i]);
+    }
+    else
+    {
+        vector<TroposcatterParams> tropo(N);
+        for (int i = 0; i < N; i++)
+        {
+            InitializeTranshorizon(&contexts[i]);
+            TranshorizonPath(&contexts[i], d__km, &medians[i], &tropo[i], &los_params[i]);
+        }
+
+        // the common volume is at the same height at every frequency
+        SlantPathAttenuationSweep(f__ghz.data(), N, 0, tropo[0].h_v__km, PI / 2, result_slant.data());
+
+        for (int i = 0; i < N; i++)
+            TranshorizonMedian(&contexts[i], d__km, result_slant[i].A_gas__db, result_slant[i].a__km, &medians[i]);
+    }
+
+    int rtn = SUCCESS;
+    for (int i = 0; i < N; i++)
+    {
+        if (TimeVariabilityMultiP(&contexts[i], d__km, &medians[i], &p, 1, &results[i]) != SUCCESS)
+            rtn = SUCCESS_WITH_WARNINGS;
+    }
+
+    return rtn;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Evaluates P.528 for a path at several frequencies.  The
+ |                refraction of the atmosphere does not depend on the
+ |                frequency, so the ray bending, ray lengths and horizon
+ |                distances of the path are traced once, along with the
+ |                ray optics of the terminal pair, and only the gaseous
+ |                absorption along the same layers and the frequency-
+ |                dependent parts of the model are computed per frequency.
+ |                The frequencies are split into contiguous blocks, one per
+ |                thread of the executor of P528_BatchParallel(), and each
+ |                block traces its rays once.  Results are identical to
+ |                calling P528() for each frequency, with the horizon ray
+ |                tables disabled.
+ |
+ |        Input:  d__km             - Path distance, in km
+ |                h_1__meter        - Height of the low terminal, in meters
+ |                h_2__meter        - Height of the high terminal, in meters
+ |                f__mhz            - Frequencies, in MHz
+ |                N                 - Number of frequencies
+ |                T_pol             - Code indicating either polarization
+ |                                      + 0 : POLARIZATION__HORIZONTAL
+ |                                      + 1 : POLARIZATION__VERTICAL
+ |                p                 - Time percentage
+ |
+ |      Outputs:  results           - Result structures, one for each
+ |                                    frequency
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_FrequencySweep(double d__km, double h_1__meter, double h_2__meter, const double* f__mhz, int N,
+    int T_pol, double p, Result* results)
+{
+    if (N < 1)
+        return ERROR_VALIDATION__FREQUENCY_COUNT;
+
+    int rtn = SUCCESS;
+
+    for (int i = 0; i < N; i++)
+    {
+        Result* result = &results[i];
+
+        // reset Results struct
+        result->A_fs__db = 0;
+        result->A_a__db = 0;
+        result->A__db = 0;
+        result->d__km = 0;
+        result->theta_h1__rad = 0;
+        result->propagation_mode = PROP_MODE__NOT_SET;
+        result->warnings = WARNING__NO_WARNINGS;
+
+        // every frequency is validated before any are evaluated, and an invalid input takes precedence over a
+        // zero length path
+        int err = ValidateInputs(d__km, h_1__meter, h_2__meter, f__mhz[i], T_pol, p, &result->warnings);
+        if (err != SUCCESS && (rtn == SUCCESS || rtn == ERROR_HEIGHT_AND_DISTANCE))
+            rtn = err;
+    }
+
+    if (rtn == ERROR_HEIGHT_AND_DISTANCE)
+        return SUCCESS;
+    else if (rtn != SUCCESS)
+        return rtn;
+
+    // the ray optics only depend on the terminal geometries, which are the same at every frequency
+    Terminal terminal_1;
+    Terminal terminal_2;
+    TerminalGeometrySweep(h_1__meter / 1000, f__mhz, 1, &terminal_1);
+    TerminalGeometrySweep(h_2__meter / 1000, f__mhz, 1, &terminal_2);
+
+    RayOpticsTable ray_optics;
+    BuildRayOpticsTable(&terminal_1, &terminal_2, &ray_optics);
+
+    int blocks = MIN(GetExecutorThreads(), N);
+    vector<double> cost(blocks, 1);
+    vector<int> rtns(blocks);
+
+    ParallelFor(blocks, cost, [&](int b)
+    {
+        int i_start = (int)((long long)N * b / blocks);
+        int i_end = (int)((long long)N * (b + 1) / blocks);
+
+        rtns[b] = SweepFrequencies(d__km, h_1__meter, h_2__meter, &f__mhz[i_start], i_end - i_start, T_pol, p,
+            ray_optics, &results[i_start]);
+    });
+
+    for (int b = 0; b < blocks; b++)
+    {
+        if (rtns[b] != SUCCESS)
+            rtn = SUCCESS_WITH_WARNINGS;
+    }
+
+    return rtn;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "../../include/p528.h"
+#include "../../include/p676.h"
+
+/*=============================================================================
+ |
+ |  Description:  Selects how the height at which a ray with a negative
+ |                elevation angle grazes is found.  By default, it is the
+ |                binary search of the reference, which stops within 0.001
+ |                km of the ray invariant and so within about 1.4 m of the
+ |                grazing height.  The exact search finds it to within
+ |                GRAZING_HEIGHT__EXACT_TOLERANCE__KM, and changes the
+ |                results of paths with a negative elevation angle.
+ |                Contexts prepared before a change keep the grazing heights
+ |                they were prepared with.
+ |
+ |        Input:  mode              - Code indicating the search
+ |                                      + 0 : GRAZING_HEIGHT__BISECTION
+ |                                      + 1 : GRAZING_HEIGHT__EXACT
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_SetGrazingHeightSearch(int mode)
+{
+    if (mode != GRAZING_HEIGHT__BISECTION && mode != GRAZING_HEIGHT__EXACT)
+        return ERROR_VALIDATION__GRAZING_HEIGHT_SEARCH;
+
+    SetGrazingHeightSearch(mode);
+
+    return SUCCESS;
+}
\ No newline at end of file
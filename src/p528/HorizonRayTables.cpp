@@ -0,0 +1,29 @@
+#include "../../include/p528.h"
+#include "../../include/p676.h"
+
+/*=============================================================================
+ |
+ |  Description:  Selects how the horizontal rays launched from the surface,
+ |                for the terminal geometry and the troposcatter common
+ |                volume, are computed.  By default, each is traced layer by
+ |                layer.  With tables, one ray per frequency is traced to
+ |                HORIZON_RAY__H_MAX__KM, and each height is read from its
+ |                cumulative results.  Contexts prepared before a change
+ |                keep the terminal geometry they were prepared with.
+ |
+ |        Input:  use_tables        - Flag for horizon ray tables
+ |                                      + 0 : Trace each ray
+ |                                      + 1 : Use tables
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_SetHorizonRayTables(int use_tables)
+{
+    if (use_tables != 0 && use_tables != 1)
+        return ERROR_VALIDATION__HORIZON_RAY_TABLES;
+
+    SetHorizonRayTables(use_tables == 1);
+
+    return SUCCESS;
+}
\ No newline at end of file
@@ -2,111 +2,264 @@
 #include "../../include/p528.h"
 #include "../../include/p676.h"
 
-double FindPsiAtDistance(double d__km, Path *path, Terminal *terminal_1, Terminal *terminal_2)
+/*=============================================================================
+ |
+ |  Description:  This function searches for the reflection angle at which
+ |                a ray optics quantity reaches a target value.  The result
+ |                is that of bisecting psi from PI/2 until the quantity is
+ |                within the termination tolerance.  The sampled table is
+ |                first used to bracket the answer, and the bracket is then
+ |                polished with a few regula falsi steps.  Since the
+ |                quantity is monotone in psi, every bisection step outside
+ |                of the bracket moves in a known direction without ending
+ |                the search, so only the steps inside of the bracket need
+ |                to evaluate the ray optics.
+ |
+ |        Input:  table         - Structure holding the sampled ray optics
+ |                terminal_1    - Structure holding low terminal parameters
+ |                terminal_2    - Structure holding high terminal parameters
+ |                quantity      - Code indicating the searched quantity
+ |                                  + 0 : RAY_OPTICS__D
+ |                                  + 1 : RAY_OPTICS__DELTA_R
+ |                target        - Target value of the quantity, in km
+ |                terminate     - Termination tolerance, in km
+ |                delta_psi_min - Smallest bisection step, in rad
+ |
+ |      Outputs:  params        - Ray optics at the resulting psi
+ |
+ |      Returns:  psi           - Reflection angle, in rad
+ |
+ *===========================================================================*/
+double SearchPsi(RayOpticsTable *table, Terminal *terminal_1, Terminal *terminal_2, int quantity,
+    double target, double terminate, double delta_psi_min, LineOfSightParams *params)
 {
-    if (d__km == 0)
-        return PI / 2;
+    // distance decreases with psi, while delta_r increases with psi
+    vector<double> *values = (quantity == RAY_OPTICS__D) ? &table->d__km : &table->delta_r__km;
+    double s = (quantity == RAY_OPTICS__D) ? -1 : 1;
 
-    // initialize to start at mid-point
-    double psi = PI / 2; 
-    double delta_psi = -PI / 4;
+    /////////////////////////////////////////////
+    // Bracket psi from the table
+    //
 
-    double d_psi__km;
+    // at and below psi_a, s * (quantity - target) < -2 * terminate.  at and above psi_b, up to the last
+    //      table sample, s * (quantity - target) > 2 * terminate.  a negative angle means that side is not
+    //      bracketed.
+    double psi_a = -1, psi_b = -1;
+    double u_a = 0, u_b = 0;    // s * (quantity - target) at the bracket ends
 
-    do
+    if (table->is_monotone)
     {
-        psi += delta_psi; // new psi
+        int N = (int)table->psi__rad.size();
+
+        // first table entry past the high side of the tolerance band
+        int lo = 0, hi = N;
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            if (s * ((*values)[mid] - target) > 2 * terminate)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        if (lo < N)
+        {
+            psi_b = table->psi__rad[lo];
+            u_b = s * ((*values)[lo] - target);
+        }
+
+        // last table entry past the low side of the tolerance band
+        lo = 0, hi = N;
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            if (s * ((*values)[mid] - target) >= -2 * terminate)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        if (lo > 0)
+        {
+            psi_a = table->psi__rad[lo - 1];
+            u_a = s * ((*values)[lo - 1] - target);
+        }
+    }
 
-        LineOfSightParams params_temp;
-        RayOptics(terminal_1, terminal_2, psi, &params_temp);
+    //
+    // Bracket psi from the table
+    /////////////////////////////////////////////
 
-        d_psi__km = params_temp.d__km;
+    /////////////////////////////////////////////
+    // Polish the bracket
+    //
 
-        // compute delta
-        if (d_psi__km > d__km)
-            delta_psi = abs(delta_psi) / 2;
+    // Illinois variant of regula falsi, stopping once a step lands inside of the tolerance band
+    double w_a = u_a, w_b = u_b;    // weighted ends used for the regula falsi steps
+    int side = 0;
+    for (int i = 0; i < RAY_OPTICS_TABLE__POLISH && psi_a >= 0 && psi_b >= 0; i++)
+    {
+        double psi = psi_a - w_a * (psi_b - psi_a) / (w_b - w_a);
+
+        RayOptics(terminal_1, terminal_2, psi, params);
+        double u = s * (((quantity == RAY_OPTICS__D) ? params->d__km : params->delta_r__km) - target);
+
+        if (u > 2 * terminate)
+        {
+            psi_b = psi;
+            u_b = w_b = u;
+            if (side == 1)
+                w_a /= 2;
+            side = 1;
+        }
+        else if (u < -2 * terminate)
+        {
+            psi_a = psi;
+            u_a = w_a = u;
+            if (side == -1)
+                w_b /= 2;
+            side = -1;
+        }
         else
-            delta_psi = -abs(delta_psi) / 2;
+        {
+            // probe a few band widths to either side to close the bracket around the band
+            double w = 4 * terminate * (psi_b - psi_a) / (u_b - u_a);
+            for (int j = -1; j <= 1; j += 2)
+            {
+                double psi_j = psi + j * w;
+                if (psi_j <= psi_a || psi_j >= psi_b)
+                    continue;
+
+                RayOptics(terminal_1, terminal_2, psi_j, params);
+                double u_j = s * (((quantity == RAY_OPTICS__D) ? params->d__km : params->delta_r__km) - target);
+
+                if (u_j < -2 * terminate)
+                    psi_a = psi_j;
+                else if (u_j > 2 * terminate)
+                    psi_b = psi_j;
+            }
+            break;
+        }
+    }
 
-    } while (abs(d__km - d_psi__km) > 1e-3 && (abs(delta_psi) > 1e-12));  // get within 1 meter of desired delta_r value
+    //
+    // Polish the bracket
+    /////////////////////////////////////////////
 
-    return psi;
-}
+    /////////////////////////////////////////////
+    // Bisect psi
+    //
 
-double FindPsiAtDeltaR(double delta_r__km, Path *path, Terminal *terminal_1, Terminal *terminal_2, double terminate)
-{
+    // the table is only trusted up to its last sample
+    double psi_min = table->psi__rad.front();
+    double psi_max = table->psi__rad.back();
+
+    // initialize to start at mid-point
     double psi = PI / 2;
     double delta_psi = -PI / 4;
 
-    LineOfSightParams params_temp;
+    bool is_computed;
+    double value;
+
     do
     {
-        psi += delta_psi;
+        psi += delta_psi; // new psi
 
-        RayOptics(terminal_1, terminal_2, psi, &params_temp);
+        bool is_above;  // quantity > target
+        is_computed = false;
 
-        if (params_temp.delta_r__km > delta_r__km)
-            delta_psi = -abs(delta_psi) / 2;
+        if (psi_a >= 0 && psi >= psi_min && psi <= psi_a)
+            is_above = (s < 0);
+        else if (psi_b >= 0 && psi >= psi_b && psi <= psi_max)
+            is_above = (s > 0);
         else
-            delta_psi = abs(delta_psi) / 2;
+        {
+            RayOptics(terminal_1, terminal_2, psi, params);
+            value = (quantity == RAY_OPTICS__D) ? params->d__km : params->delta_r__km;
 
-    } while (abs(params_temp.delta_r__km - delta_r__km) > terminate);
+            is_above = value > target;
+            is_computed = true;
+        }
+
+        // compute delta
+        if (is_above)
+            delta_psi = -s * abs(delta_psi) / 2;
+        else
+            delta_psi = s * abs(delta_psi) / 2;
+
+    } while ((!is_computed || abs(value - target) > terminate) && abs(delta_psi) > delta_psi_min);
+
+    if (!is_computed)
+        RayOptics(terminal_1, terminal_2, psi, params);
+
+    //
+    // Bisect psi
+    /////////////////////////////////////////////
 
     return psi;
 }
 
-double FindDistanceAtDeltaR(double delta_r__km, Path *path, Terminal *terminal_1, Terminal *terminal_2, double terminate)
+double FindPsiAtDistance(double d__km, RayOpticsTable *table, Terminal *terminal_1, Terminal *terminal_2)
 {
-    double psi = PI / 2;
-    double delta_psi = -PI / 4;
+    if (d__km == 0)
+        return PI / 2;
 
+    // get within 1 meter of desired distance
     LineOfSightParams params_temp;
-    do
-    {
-        psi += delta_psi;
+    return SearchPsi(table, terminal_1, terminal_2, RAY_OPTICS__D, d__km, 1e-3, 1e-12, &params_temp);
+}
 
-        RayOptics(terminal_1, terminal_2, psi, &params_temp);
+double FindPsiAtDeltaR(double delta_r__km, RayOpticsTable *table, Terminal *terminal_1, Terminal *terminal_2, double terminate)
+{
+    LineOfSightParams params_temp;
+    return SearchPsi(table, terminal_1, terminal_2, RAY_OPTICS__DELTA_R, delta_r__km, terminate, 0, &params_temp);
+}
 
-        if (params_temp.delta_r__km > delta_r__km)
-            delta_psi = -abs(delta_psi) / 2;
-        else
-            delta_psi = abs(delta_psi) / 2;
+double FindDistanceAtDeltaR(double delta_r__km, RayOpticsTable *table, Terminal *terminal_1, Terminal *terminal_2, double terminate)
+{
+    LineOfSightParams params_temp;
+    SearchPsi(table, terminal_1, terminal_2, RAY_OPTICS__DELTA_R, delta_r__km, terminate, 0, &params_temp);
 
-    } while (abs(params_temp.delta_r__km - delta_r__km) > terminate);
+    return params_temp.d__km;
+}
+
+double FindRayOpticsDistance(double d__km, RayOpticsTable *table, Terminal *terminal_1, Terminal *terminal_2)
+{
+    double psi = FindPsiAtDistance(d__km, table, terminal_1, terminal_2);
+
+    LineOfSightParams params_temp;
+    RayOptics(terminal_1, terminal_2, psi, &params_temp);
 
     return params_temp.d__km;
 }
 
 /*=============================================================================
  |
- |  Description:  This function computes the total loss in the line-of-sight
- |                region as described in Annex 2, Section 6 of
+ |  Description:  This function computes the distance-independent line-of-
+ |                sight parameters as described in Annex 2, Section 6 of
  |                Recommendation ITU-R P.528-5, "Propagation curves for
  |                aeronautical mobile and radionavigation services using
- |                the VHF, UHF and SHF bands"
+ |                the VHF, UHF and SHF bands".  These only need to be
+ |                computed once per terminal pair and frequency.
  |
  |        Input:  path          - Struct containing path parameters
  |                terminal_1    - Struct containing low terminal parameters
  |                terminal_2    - Struct containing high terminal parameters
+ |                table         - Struct containing the sampled ray optics
  |                f__mhz        - Frequency, in MHz
  |                A_dML__db     - Diffraction loss at d_ML, in dB
- |                p             - Time percentage
- |                d__km         - Path length, in km
  |                T_pol         - Code indicating either polarization
  |                                  + 0 : POLARIZATION__HORIZONTAL
  |                                  + 1 : POLARIZATION__VERTICAL
  |
- |      Outputs:  los_params    - Struct containing LOS parameters
- |                result        - Struct containing P.528 results
- |                K_LOS         - K-value
+ |      Outputs:  path          - d_0__km is set
+ |                psi_limit     - Angular limit separating FS and 2-Ray, in rad
+ |                A_d_0__db     - Loss at d_0, in dB
  |
  |      Returns:  [void]
  |
  *===========================================================================*/
-void LineOfSight(Path *path, Terminal *terminal_1, Terminal *terminal_2, LineOfSightParams *los_params, 
-    double f__mhz, double A_dML__db, double p, double d__km, int T_pol, Result *result, double *K_LOS)
+void InitializeLineOfSight(Path *path, Terminal *terminal_1, Terminal *terminal_2, RayOpticsTable *table,
+    double f__mhz, double A_dML__db, int T_pol, double *psi_limit, double *A_d_0__db)
 {
-    double psi;
     double R_Tg;
 
     // 0.2997925 = speed of light, gigameters per sec
@@ -115,11 +268,11 @@ void LineOfSight(Path *path, Terminal *terminal_1, Terminal *terminal_2, LineOfS
 
     // determine psi_limit, where you switch from free space to 2-ray model
     // lambda / 2 is the start of the lobe closest to d_ML
-    double psi_limit = FindPsiAtDeltaR(lambda__km / 2, path, terminal_1, terminal_2, terminate);
+    *psi_limit = FindPsiAtDeltaR(lambda__km / 2, table, terminal_1, terminal_2, terminate);
 
     // "[d_y6__km] is the largest distance at which a free-space value is obtained in a two-ray model
     //   of reflection from a smooth earth with a reflection coefficient of -1" [ES-83-3, page 44]
-    double d_y6__km = FindDistanceAtDeltaR(lambda__km / 6, path, terminal_1, terminal_2, terminate);
+    double d_y6__km = FindDistanceAtDeltaR(lambda__km / 6, table, terminal_1, terminal_2, terminate);
 
     /////////////////////////////////////////////
     // Determine d_0__km distance
@@ -148,27 +301,47 @@ void LineOfSight(Path *path, Terminal *terminal_1, Terminal *terminal_2, LineOfS
     // Tune d_0__km distance
     //
 
-    // Now that we have d_0, lets carefully walk it forward, 1 meter at a time, to tune it to as precise as possible without
-    //      going beyond the LOS region (ie, beyond d_ML)
-    double d_temp__km = path->d_0__km;
-    while (true)
+    // Now that we have d_0, tune it to as precise as possible without going beyond the LOS region (ie, beyond d_ML).
+    //      This is done on a 1 meter grid of distances starting at d_0, taking the first grid point whose ray optics
+    //      distance is at least d_0, or the last grid point before d_ML.  Since FindPsiAtDistance() gets within 1 meter
+    //      of the requested distance, this is almost always the first or second grid point, so those are checked
+    //      directly.  Otherwise, the remaining grid points are bisected instead of walked one at a time, which gives the
+    //      same d_0 to within the 1 meter grid spacing with at most ~log2(d_ML - d_0 in meters) psi searches.
+    double d_start__km = path->d_0__km;
+
+    // last grid point before the next one would be outside of LOS
+    int k_max = MAX(0, (int)ceil((path->d_ML__km - d_start__km) / 0.001) - 1);
+    while (d_start__km + (k_max + 1) * 0.001 < path->d_ML__km)
+        k_max++;
+    while (k_max > 0 && d_start__km + k_max * 0.001 >= path->d_ML__km)
+        k_max--;
+
+    int k_lo = -1;                  // largest grid point known to fall short of d_0
+    int k_hi = k_max;               // smallest grid point known to end the search
+    double d_hi__km = -1;           // ray optics distance at k_hi, if already computed
+
+    while (k_hi - k_lo > 1)
     {
-        psi = FindPsiAtDistance(d_temp__km, path, terminal_1, terminal_2);
+        int k = (k_lo < 1) ? k_lo + 1 : k_lo + (k_hi - k_lo) / 2;
 
-        LineOfSightParams los_result;
-        RayOptics(terminal_1, terminal_2, psi, &los_result);
+        double d_k__km = FindRayOpticsDistance(d_start__km + k * 0.001, table, terminal_1, terminal_2);
 
-        // if the resulting distance is beyond d_0 OR if we incremented again we'd be outside of LOS...
-        if (los_result.d__km >= path->d_0__km || (d_temp__km + 0.001) >= path->d_ML__km)
+        if (d_k__km >= d_start__km)
         {
-            // use the resulting distance as d_0
-            path->d_0__km = los_result.d__km;
-            break;
+            k_hi = k;
+            d_hi__km = d_k__km;
         }
-
-        d_temp__km += 0.001;
+        else
+            k_lo = k;
     }
 
+    // k_hi is the last grid point before d_ML and was never evaluated
+    if (d_hi__km < 0)
+        d_hi__km = FindRayOpticsDistance(d_start__km + k_hi * 0.001, table, terminal_1, terminal_2);
+
+    // use the resulting distance as d_0
+    path->d_0__km = d_hi__km;
+
     //
     // Tune d_0__km distance
     /////////////////////////////////////////////
@@ -177,62 +350,58 @@ void LineOfSight(Path *path, Terminal *terminal_1, Terminal *terminal_2, LineOfS
     // Compute loss at d_0__km
     //
 
-    double psi_d0 = FindPsiAtDistance(path->d_0__km, path, terminal_1, terminal_2);
-
-    RayOptics(terminal_1, terminal_2, psi_d0, los_params);
-
-    GetPathLoss(psi_d0, path, f__mhz, psi_limit, A_dML__db, 0, T_pol, los_params, &R_Tg);
-
-    //
-    // Compute loss at d_0__km
-    /////////////////////////////////////////////
-
-    // tune psi for the desired distance
-    psi = FindPsiAtDistance(d__km, path, terminal_1, terminal_2);
-
-    RayOptics(terminal_1, terminal_2, psi, los_params);
-
-    GetPathLoss(psi, path, f__mhz, psi_limit, A_dML__db, los_params->A_LOS__db, T_pol, los_params, &R_Tg);
-
-    /////////////////////////////////////////////
-    // Compute atmospheric absorption
-    //
-
-    SlantPathAttenuationResult result_slant;
-    SlantPathAttenuation(f__mhz / 1000, terminal_1->h_r__km, terminal_2->h_r__km, PI / 2 - los_params->theta_h1__rad, &result_slant);
+    double psi_d0 = FindPsiAtDistance(path->d_0__km, table, terminal_1, terminal_2);
 
-    result->A_a__db = result_slant.A_gas__db;
+    LineOfSightParams params_d0;
+    RayOptics(terminal_1, terminal_2, psi_d0, &params_d0);
 
-    //
-    // Compute atmospheric absorption
-    /////////////////////////////////////////////
-
-    /////////////////////////////////////////////
-    // Compute free-space loss
-    //
+    GetPathLoss(psi_d0, path, f__mhz, *psi_limit, A_dML__db, 0, T_pol, &params_d0, &R_Tg);
 
-    result->A_fs__db = 20.0 * log10(los_params->r_0__km) + 20.0 * log10(f__mhz) + 32.45; // [Eqn 6-4]
+    *A_d_0__db = params_d0.A_LOS__db;
 
     //
-    // Compute free-space loss
+    // Compute loss at d_0__km
     /////////////////////////////////////////////
+}
 
-    /////////////////////////////////////////////
-    // Compute variability
-    //
+/*=============================================================================
+ |
+ |  Description:  This function computes the variability parameters of a
+ |                line-of-sight path, from its geometry and the length of
+ |                the ray traced between the terminals.  See Annex 2,
+ |                Section 13.
+ |
+ |        Input:  terminal_1    - Struct containing low terminal parameters
+ |                terminal_2    - Struct containing high terminal parameters
+ |                los_params    - Struct containing LOS parameters
+ |                f__mhz        - Frequency, in MHz
+ |                d__km         - Path length, in km
+ |                R_Tg          - Reflection coefficient
+ |                a__km         - Length of the traced ray, in km
+ |
+ |      Outputs:  f_theta_h     - Angle factor of the variability
+ |                Y_e_50__db    - Variability at 50% of time, in dB
+ |
+ |      Returns:  K_LOS         - K-value of the Nakagami-Rice distribution
+ |
+ *===========================================================================*/
+static double LineOfSightVariability(Terminal *terminal_1, Terminal *terminal_2, LineOfSightParams *los_params,
+    double f__mhz, double d__km, double R_Tg, double a__km, double *f_theta_h, double *Y_e_50__db)
+{
+    // 0.2997925 = speed of light, gigameters per sec
+    double lambda__km = 0.2997925 / f__mhz;                             // [Eqn 6-1]
 
     // [Eqn 13-1]
-    double f_theta_h;
     if (los_params->theta_h1__rad <= 0.0)
-        f_theta_h = 1.0;
+        *f_theta_h = 1.0;
     else if (los_params->theta_h1__rad >= 1.0)
-        f_theta_h = 0.0;
+        *f_theta_h = 0.0;
     else
-        f_theta_h = MAX(0.5 - (1 / PI) * (atan(20.0 * log10(32.0 * los_params->theta_h1__rad))), 0);
+        *f_theta_h = MAX(0.5 - (1 / PI) * (atan(20.0 * log10(32.0 * los_params->theta_h1__rad))), 0);
 
-    double Y_e__db, Y_e_50__db, A_Y;
-    LongTermVariability(terminal_1->d_r__km, terminal_2->d_r__km, d__km, f__mhz, p, f_theta_h, los_params->A_LOS__db, &Y_e__db, &A_Y);
-    LongTermVariability(terminal_1->d_r__km, terminal_2->d_r__km, d__km, f__mhz, 50, f_theta_h, los_params->A_LOS__db, &Y_e_50__db, &A_Y);
+    // the conditional adjustment factor does not depend on the time percentage
+    double A_Y;
+    LongTermVariability(terminal_1->d_r__km, terminal_2->d_r__km, d__km, f__mhz, 50, *f_theta_h, los_params->A_LOS__db, Y_e_50__db, &A_Y);
 
     // [Eqn 13-2]
     double F_AY;
@@ -254,7 +423,7 @@ void LineOfSight(Path *path, Terminal *terminal_1, Terminal *terminal_2, LineOfS
 
     double R_s = R_Tg * F_delta_r * F_AY;       // [Eqn 13-4]
 
-    double Y_pi_99__db = 10.0 * log10(f__mhz * pow(result_slant.a__km, 3)) - 84.26;	// [Eqn 13-5]
+    double Y_pi_99__db = 10.0 * log10(f__mhz * pow(a__km, 3)) - 84.26;	// [Eqn 13-5]
     double K_t = FindKForYpiAt99Percent(Y_pi_99__db);
 
     double W_a = pow(10.0, K_t / 10.0);         // [Eqn 13-6]
@@ -262,26 +431,209 @@ void LineOfSight(Path *path, Terminal *terminal_1, Terminal *terminal_2, LineOfS
     double W = W_R + W_a;                       // [Eqn 13-8]
 
     // [Eqn 13-9]
+    double K_LOS;
     if (W <= 0.0)
-        *K_LOS = -40.0;
+        K_LOS = -40.0;
     else
     {
-        *K_LOS = 10.0 * log10(W);
+        K_LOS = 10.0 * log10(W);
 
-    if (*K_LOS < -40.0)
-        *K_LOS = -40.0;
+    if (K_LOS < -40.0)
+        K_LOS = -40.0;
     }
 
-    double Y_pi_50__db = 0.0;   //  zero mean
-    double Y_pi__db = NakagamiRice(*K_LOS, p);
+    return K_LOS;
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function computes the total loss in the line-of-sight
+ |                region as described in Annex 2, Section 6 of
+ |                Recommendation ITU-R P.528-5, "Propagation curves for
+ |                aeronautical mobile and radionavigation services using
+ |                the VHF, UHF and SHF bands", up to the time percentage.
+ |                The time variability is applied by TimeVariability().
+ |
+ |        Input:  path          - Struct containing path parameters
+ |                terminal_1    - Struct containing low terminal parameters
+ |                terminal_2    - Struct containing high terminal parameters
+ |                table         - Struct containing the sampled ray optics
+ |                f__mhz        - Frequency, in MHz
+ |                A_dML__db     - Diffraction loss at d_ML, in dB
+ |                psi_limit     - Angular limit separating FS and 2-Ray, in rad
+ |                A_d_0__db     - Loss at d_0, in dB
+ |                d__km         - Path length, in km
+ |                T_pol         - Code indicating either polarization
+ |                                  + 0 : POLARIZATION__HORIZONTAL
+ |                                  + 1 : POLARIZATION__VERTICAL
+ |
+ |      Outputs:  los_params    - Struct containing LOS parameters
+ |                median        - Struct containing the time-independent
+ |                                results, including K_LOS
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void LineOfSight(Path *path, Terminal *terminal_1, Terminal *terminal_2, RayOpticsTable *table,
+    LineOfSightParams *los_params, double f__mhz, double A_dML__db, double psi_limit, double A_d_0__db, double d__km, int T_pol, 
+    MedianResult *median)
+{
+    double R_Tg;
+    LineOfSightPath(path, terminal_1, terminal_2, table, los_params, f__mhz, A_dML__db, psi_limit, A_d_0__db, d__km, T_pol, &R_Tg);
+
+    SlantPathAttenuationResult result_slant;
+    SlantPathAttenuation(f__mhz / 1000, terminal_1->h_r__km, terminal_2->h_r__km, PI / 2 - los_params->theta_h1__rad, &result_slant);
+
+    LineOfSightMedian(terminal_1, terminal_2, los_params, f__mhz, d__km, R_Tg, result_slant.A_gas__db, result_slant.a__km,
+        median);
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function computes K_LOS, the K-value of a line-of-
+ |                sight path, identical to the K__db of LineOfSight().  The
+ |                variability only needs the length of the ray between the
+ |                terminals, so the ray is traced through layers without
+ |                their absorption, which are cached once for the terminal
+ |                pair and shared by every frequency.
+ |
+ |        Input:  path          - Struct containing path parameters
+ |                terminal_1    - Struct containing low terminal parameters
+ |                terminal_2    - Struct containing high terminal parameters
+ |                table         - Struct containing the sampled ray optics
+ |                f__mhz        - Frequency, in MHz
+ |                A_dML__db     - Diffraction loss at d_ML, in dB
+ |                psi_limit     - Angular limit separating FS and 2-Ray, in rad
+ |                A_d_0__db     - Loss at d_0, in dB
+ |                d__km         - Path length, in km
+ |                T_pol         - Code indicating either polarization
+ |                                  + 0 : POLARIZATION__HORIZONTAL
+ |                                  + 1 : POLARIZATION__VERTICAL
+ |
+ |      Outputs:  los_params    - Struct containing LOS parameters
+ |
+ |      Returns:  K_LOS         - K-value of the Nakagami-Rice distribution
+ |
+ *===========================================================================*/
+double LineOfSightK(Path *path, Terminal *terminal_1, Terminal *terminal_2, RayOpticsTable *table,
+    LineOfSightParams *los_params, double f__mhz, double A_dML__db, double psi_limit, double A_d_0__db, double d__km,
+    int T_pol)
+{
+    double R_Tg;
+    LineOfSightPath(path, terminal_1, terminal_2, table, los_params, f__mhz, A_dML__db, psi_limit, A_d_0__db, d__km, T_pol, &R_Tg);
+
+    SlantPathAttenuationResult result_slant;
+    SlantPathGeometry(terminal_1->h_r__km, terminal_2->h_r__km, PI / 2 - los_params->theta_h1__rad, &result_slant);
+
+    double f_theta_h, Y_e_50__db;
+    return LineOfSightVariability(terminal_1, terminal_2, los_params, f__mhz, d__km, R_Tg, result_slant.a__km,
+        &f_theta_h, &Y_e_50__db);
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function finds the ray optics geometry and the path
+ |                loss of a line-of-sight path, the parts of LineOfSight()
+ |                before the ray between the terminals is traced.
+ |
+ |        Input:  path          - Struct containing path parameters
+ |                terminal_1    - Struct containing low terminal parameters
+ |                terminal_2    - Struct containing high terminal parameters
+ |                table         - Struct containing the sampled ray optics
+ |                f__mhz        - Frequency, in MHz
+ |                A_dML__db     - Diffraction loss at d_ML, in dB
+ |                psi_limit     - Angular limit separating FS and 2-Ray, in rad
+ |                A_d_0__db     - Loss at d_0, in dB
+ |                d__km         - Path length, in km
+ |                T_pol         - Code indicating either polarization
+ |                                  + 0 : POLARIZATION__HORIZONTAL
+ |                                  + 1 : POLARIZATION__VERTICAL
+ |
+ |      Outputs:  los_params    - Struct containing LOS parameters
+ |                R_Tg          - Reflection coefficient
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void LineOfSightPath(Path *path, Terminal *terminal_1, Terminal *terminal_2, RayOpticsTable *table,
+    LineOfSightParams *los_params, double f__mhz, double A_dML__db, double psi_limit, double A_d_0__db, double d__km, int T_pol,
+    double *R_Tg)
+{
+    // tune psi for the desired distance
+    double psi = FindPsiAtDistance(d__km, table, terminal_1, terminal_2);
+
+    RayOptics(terminal_1, terminal_2, psi, los_params);
+
+    GetPathLoss(psi, path, f__mhz, psi_limit, A_dML__db, A_d_0__db, T_pol, los_params, R_Tg);
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function computes the time-independent results of a
+ |                line-of-sight path from its geometry and the ray traced
+ |                between the terminals, the parts of LineOfSight() after
+ |                the ray is traced.
+ |
+ |        Input:  terminal_1    - Struct containing low terminal parameters
+ |                terminal_2    - Struct containing high terminal parameters
+ |                los_params    - Struct containing LOS parameters, from
+ |                                LineOfSightPath()
+ |                f__mhz        - Frequency, in MHz
+ |                d__km         - Path length, in km
+ |                R_Tg          - Reflection coefficient, from
+ |                                LineOfSightPath()
+ |                A_gas__db     - Gaseous absorption along the ray traced
+ |                                from terminal_1 to terminal_2 at the
+ |                                elevation angle theta_h1, in dB
+ |                a__km         - Length of the traced ray, in km
+ |
+ |      Outputs:  median        - Struct containing the time-independent
+ |                                results, including K_LOS
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void LineOfSightMedian(Terminal *terminal_1, Terminal *terminal_2, LineOfSightParams *los_params, double f__mhz,
+    double d__km, double R_Tg, double A_gas__db, double a__km, MedianResult *median)
+{
+    /////////////////////////////////////////////
+    // Compute atmospheric absorption
+    //
+
+    median->A_a__db = A_gas__db;
+
+    //
+    // Compute atmospheric absorption
+    /////////////////////////////////////////////
+
+    /////////////////////////////////////////////
+    // Compute free-space loss
+    //
+
+    median->A_fs__db = 20.0 * log10(los_params->r_0__km) + 20.0 * log10(f__mhz) + 32.45; // [Eqn 6-4]
+
+    //
+    // Compute free-space loss
+    /////////////////////////////////////////////
+
+    /////////////////////////////////////////////
+    // Compute variability
+    //
 
-    double Y_total__db = -CombineDistributions(Y_e_50__db, Y_e__db, Y_pi_50__db, Y_pi__db, p);
+    double f_theta_h, Y_e_50__db;
+    double K_LOS = LineOfSightVariability(terminal_1, terminal_2, los_params, f__mhz, d__km, R_Tg, a__km, &f_theta_h,
+        &Y_e_50__db);
 
     //
     // Compute variability
     /////////////////////////////////////////////
 
-    result->d__km = los_params->d__km;
-    result->A__db = result->A_fs__db + result->A_a__db - los_params->A_LOS__db + Y_total__db;
-    result->theta_h1__rad = los_params->theta_h1__rad;
+    median->propagation_mode = PROP_MODE__LOS;
+    median->warnings = WARNING__NO_WARNINGS;
+    median->d__km = los_params->d__km;
+    median->A_T__db = -los_params->A_LOS__db;
+    median->theta_h1__rad = los_params->theta_h1__rad;
+    median->f_theta_h = f_theta_h;
+    median->K__db = K_LOS;
+    median->Y_e_50__db = Y_e_50__db;
 }
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "../../include/p528.h"
+#include "../../include/p676.h"
+
+/*=============================================================================
+ |
+ |  Description:  Sets the spectral line windowing mode used for atmospheric
+ |                absorption.  With a non-zero tolerance, only the oxygen
+ |                and water vapour lines needed at each frequency are
+ |                evaluated, and the rest are folded into a residual term,
+ |                keeping each line sum within the tolerance over the
+ |                reference atmosphere.  A tolerance of 0, the default,
+ |                evaluates every line.  Contexts prepared before a change
+ |                keep the tolerance they were prepared with.
+ |
+ |        Input:  tolerance         - Bound on the relative error of the
+ |                                    oxygen and water vapour line sums,
+ |                                    ex. 0.001 for 0.1%
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_SetLineWindowTolerance(double tolerance)
+{
+    if (!(tolerance >= 0 && tolerance < 1))
+        return ERROR_VALIDATION__LINE_WINDOW;
+
+    SetLineWindowTolerance(tolerance);
+
+    return SUCCESS;
+}
\ No newline at end of file
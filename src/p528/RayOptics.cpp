@@ -57,4 +57,47 @@ void RayOptics(Terminal *terminal_1, Terminal *terminal_2, double psi, LineOfSig
 
     params->theta_h1__rad = alpha - params->theta[0];                // [Eqn 7-16]
     params->theta_h2__rad = -(alpha + params->theta[1]);             // [Eqn 7-17]
+}
+
+/*=============================================================================
+ |
+ |  Description:  This function samples the ray optics of a terminal pair
+ |                over reflection angle, so that searches for the angle at
+ |                a given distance or ray length path difference can start
+ |                from a narrow bracket instead of the full [0, PI/2] range.
+ |                This only needs to be computed once per terminal pair.
+ |
+ |        Input:  terminal_1    - Structure holding low terminal parameters
+ |                terminal_2    - Structure holding high terminal parameters
+ |
+ |      Outputs:  table         - Structure holding the sampled ray optics
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void BuildRayOpticsTable(Terminal *terminal_1, Terminal *terminal_2, RayOpticsTable *table)
+{
+    table->psi__rad.resize(RAY_OPTICS_TABLE__SIZE);
+    table->d__km.resize(RAY_OPTICS_TABLE__SIZE);
+    table->delta_r__km.resize(RAY_OPTICS_TABLE__SIZE);
+
+    table->is_monotone = true;
+
+    LineOfSightParams params;
+    for (int i = 0; i < RAY_OPTICS_TABLE__SIZE; i++)
+    {
+        // sample more densely at low angles, where distance changes fastest near the horizon
+        double x = (double)i / (RAY_OPTICS_TABLE__SIZE - 1);
+        double psi = RAY_OPTICS_TABLE__PSI_MAX * x * x;
+
+        RayOptics(terminal_1, terminal_2, psi, &params);
+
+        table->psi__rad[i] = psi;
+        table->d__km[i] = params.d__km;
+        table->delta_r__km[i] = params.delta_r__km;
+
+        // searches rely on distance decreasing and delta_r increasing with psi
+        if (i > 0 && !(table->d__km[i] < table->d__km[i - 1] && table->delta_r__km[i] > table->delta_r__km[i - 1]))
+            table->is_monotone = false;
+    }
 }
\ No newline at end of file
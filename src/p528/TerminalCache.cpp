@@ -0,0 +1,343 @@
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include "../../include/p528.h"
+#include "../../include/p676.h"
+
+// A cached terminal geometry.  Every field is atomic so that readers never take a lock: a writer makes the
+// sequence number odd while it updates the slot, and a reader only accepts a slot whose sequence number was
+// even and unchanged across its reads.
+struct TerminalCacheSlot
+{
+    atomic<unsigned> sequence{ 0 };
+
+    // Key.  The ray traces also depend on the process-wide attenuation settings.
+    atomic<double> f__mhz{ 0 };             // 0 marks an empty slot
+    atomic<double> h_r__km{ 0 };
+    atomic<double> tolerance{ 0 };
+    atomic<int> engine{ 0 };
+    atomic<bool> use_horizon_ray_tables{ false };
+
+    // Terminal geometry
+    atomic<double> h_e__km{ 0 };
+    atomic<double> delta_h__km{ 0 };
+    atomic<double> d_r__km{ 0 };
+    atomic<double> a__km{ 0 };
+    atomic<double> phi__rad{ 0 };
+    atomic<double> theta__rad{ 0 };
+    atomic<double> A_a__db{ 0 };
+};
+
+struct TerminalCacheShard
+{
+    mutex write_mutex;                      // serializes writers, readers never lock
+    unsigned next_way = 0;                  // round robin eviction, guarded by write_mutex
+
+    atomic<long long> hits{ 0 };
+    atomic<long long> misses{ 0 };
+};
+
+struct TerminalCache
+{
+    int sets;                               // sets of TERMINAL_CACHE__WAYS slots, per shard
+    unique_ptr<TerminalCacheShard[]> shards;
+    unique_ptr<TerminalCacheSlot[]> slots;
+};
+
+struct TerminalCacheKey
+{
+    double f__mhz;
+    double h_r__km;
+    double tolerance;
+    int engine;
+    bool use_horizon_ray_tables;
+};
+
+static TerminalCache* NewTerminalCache(int capacity)
+{
+    TerminalCache* cache = new TerminalCache();
+
+    cache->sets = capacity / (TERMINAL_CACHE__SHARDS * TERMINAL_CACHE__WAYS);
+    if (capacity > 0)
+        cache->sets = MAX(cache->sets, 1);
+
+    cache->shards.reset(new TerminalCacheShard[TERMINAL_CACHE__SHARDS]);
+    cache->slots.reset(new TerminalCacheSlot[TERMINAL_CACHE__SHARDS * cache->sets * TERMINAL_CACHE__WAYS]);
+
+    return cache;
+}
+
+static atomic<TerminalCache*> terminal_cache(NewTerminalCache(TERMINAL_CACHE__CAPACITY));
+
+// Readers of one shard in one parity of the epoch, on a cache line of their own
+struct TerminalCacheReaders
+{
+    atomic<int> count{ 0 };
+    char padding[64 - sizeof(atomic<int>)];
+};
+
+// A reader registers in the parity of the current epoch before it loads the cache.  Replacing the cache
+// advances the epoch, so once the readers of the previous parity have left, none can hold the old cache
+static atomic<unsigned> terminal_cache_epoch(0);
+static TerminalCacheReaders terminal_cache_readers[2][TERMINAL_CACHE__SHARDS];
+static mutex terminal_cache_mutex;          // serializes replacing the cache
+
+// Registers a reader of the terminal cache in a shard, for as long as it is in scope
+struct TerminalCacheReader
+{
+    atomic<int>* count;
+
+    explicit TerminalCacheReader(int s)
+    {
+        // the epoch must not advance between choosing a parity and registering in it
+        for (;;)
+        {
+            unsigned epoch = terminal_cache_epoch.load();
+            count = &terminal_cache_readers[epoch & 1][s].count;
+            count->fetch_add(1);
+
+            if (terminal_cache_epoch.load() == epoch)
+                break;
+
+            count->fetch_sub(1);
+        }
+    }
+
+    ~TerminalCacheReader()
+    {
+        count->fetch_sub(1);
+    }
+};
+
+static uint64_t HashTerminalKey(const TerminalCacheKey& key)
+{
+    uint64_t f, h;
+    memcpy(&f, &key.f__mhz, sizeof(f));
+    memcpy(&h, &key.h_r__km, sizeof(h));
+
+    // splitmix64 finalizer
+    uint64_t x = f * 0x9E3779B97F4A7C15ull ^ h;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Reads a slot without locking.  Fails if the slot is empty,
+ |                holds a different key, or is being written.
+ |
+ |        Input:  slot          - Cache slot
+ |                key           - Terminal geometry key
+ |
+ |      Outputs:  terminal      - Structure containing parameters dealing
+ |                                with the geometry of the terminal
+ |
+ |      Returns:  is_hit        - True if the terminal geometry was read
+ |
+ *===========================================================================*/
+static bool ReadSlot(const TerminalCacheSlot& slot, const TerminalCacheKey& key, Terminal* terminal)
+{
+    unsigned sequence = slot.sequence.load(memory_order_acquire);
+    if (sequence & 1)
+        return false;
+
+    bool is_match =
+        slot.f__mhz.load(memory_order_relaxed) == key.f__mhz &&
+        slot.h_r__km.load(memory_order_relaxed) == key.h_r__km &&
+        slot.tolerance.load(memory_order_relaxed) == key.tolerance &&
+        slot.engine.load(memory_order_relaxed) == key.engine &&
+        slot.use_horizon_ray_tables.load(memory_order_relaxed) == key.use_horizon_ray_tables;
+
+    Terminal value;
+    value.h_r__km = key.h_r__km;
+    value.h_e__km = slot.h_e__km.load(memory_order_relaxed);
+    value.delta_h__km = slot.delta_h__km.load(memory_order_relaxed);
+    value.d_r__km = slot.d_r__km.load(memory_order_relaxed);
+    value.a__km = slot.a__km.load(memory_order_relaxed);
+    value.phi__rad = slot.phi__rad.load(memory_order_relaxed);
+    value.theta__rad = slot.theta__rad.load(memory_order_relaxed);
+    value.A_a__db = slot.A_a__db.load(memory_order_relaxed);
+
+    // the reads are only consistent if no writer started in the meantime
+    atomic_thread_fence(memory_order_acquire);
+    if (!is_match || slot.sequence.load(memory_order_relaxed) != sequence)
+        return false;
+
+    *terminal = value;
+    return true;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Writes a slot.  The caller must hold the write mutex of
+ |                the slot's shard.
+ |
+ |        Input:  key           - Terminal geometry key
+ |                terminal      - Terminal geometry
+ |
+ |      Outputs:  slot          - Cache slot
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void WriteSlot(const TerminalCacheKey& key, const Terminal& terminal, TerminalCacheSlot* slot)
+{
+    unsigned sequence = slot->sequence.load(memory_order_relaxed);
+    slot->sequence.store(sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->f__mhz.store(key.f__mhz, memory_order_relaxed);
+    slot->h_r__km.store(key.h_r__km, memory_order_relaxed);
+    slot->tolerance.store(key.tolerance, memory_order_relaxed);
+    slot->engine.store(key.engine, memory_order_relaxed);
+    slot->use_horizon_ray_tables.store(key.use_horizon_ray_tables, memory_order_relaxed);
+
+    slot->h_e__km.store(terminal.h_e__km, memory_order_relaxed);
+    slot->delta_h__km.store(terminal.delta_h__km, memory_order_relaxed);
+    slot->d_r__km.store(terminal.d_r__km, memory_order_relaxed);
+    slot->a__km.store(terminal.a__km, memory_order_relaxed);
+    slot->phi__rad.store(terminal.phi__rad, memory_order_relaxed);
+    slot->theta__rad.store(terminal.theta__rad, memory_order_relaxed);
+    slot->A_a__db.store(terminal.A_a__db, memory_order_relaxed);
+
+    slot->sequence.store(sequence + 2, memory_order_release);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Computes the terminal geometry, reusing the result of an
+ |                earlier call at the same frequency and terminal height.
+ |                The cache is shared across calls and threads, and lookups
+ |                do not lock.  Results are identical to TerminalGeometry().
+ |
+ |        Input:  f__mhz        - Frequency, in MHz
+ |
+ | Input/Output:  terminal      - Structure containing parameters dealing
+ |                                with the geometry of the terminal.  Only
+ |                                h_r__km is used as input
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void GetTerminalGeometry(double f__mhz, Terminal* terminal)
+{
+    TerminalCacheKey key = { f__mhz, terminal->h_r__km, GetLineWindowTolerance(), GetAttenuationEngine(),
+        GetHorizonRayTables() };
+
+    uint64_t hash = HashTerminalKey(key);
+    int s = hash % TERMINAL_CACHE__SHARDS;
+
+    TerminalCacheReader reader(s);
+
+    TerminalCache* cache = terminal_cache.load();
+    if (cache->sets == 0)
+    {
+        TerminalGeometry(f__mhz, terminal);
+        return;
+    }
+
+    // each shard owns a contiguous block of sets
+    int i = (hash / TERMINAL_CACHE__SHARDS) % cache->sets;
+
+    TerminalCacheShard& shard = cache->shards[s];
+    TerminalCacheSlot* set = &cache->slots[(s * cache->sets + i) * TERMINAL_CACHE__WAYS];
+
+    for (int w = 0; w < TERMINAL_CACHE__WAYS; w++)
+    {
+        if (ReadSlot(set[w], key, terminal))
+        {
+            shard.hits.fetch_add(1, memory_order_relaxed);
+            return;
+        }
+    }
+
+    shard.misses.fetch_add(1, memory_order_relaxed);
+
+    // trace outside of the lock, so other threads are not blocked
+    TerminalGeometry(f__mhz, terminal);
+
+    lock_guard<mutex> lock(shard.write_mutex);
+
+    // another thread may have added the same geometry in the meantime
+    Terminal existing;
+    for (int w = 0; w < TERMINAL_CACHE__WAYS; w++)
+        if (ReadSlot(set[w], key, &existing))
+            return;
+
+    // fill an empty slot before evicting
+    int way = -1;
+    for (int w = 0; w < TERMINAL_CACHE__WAYS && way < 0; w++)
+        if (set[w].f__mhz.load(memory_order_relaxed) == 0)
+            way = w;
+    if (way < 0)
+        way = shard.next_way++ % TERMINAL_CACHE__WAYS;
+
+    WriteSlot(key, *terminal, &set[way]);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Sets the number of terminal geometries kept by the cache,
+ |                and empties it.  The capacity is rounded down to a multiple
+ |                of TERMINAL_CACHE__SHARDS * TERMINAL_CACHE__WAYS, with at
+ |                least one set per shard.  A capacity of 0 turns the
+ |                cache off.  The hit and miss counts are reset.  The old
+ |                cache is freed once every lookup that may be using it
+ |                has finished, so this waits for those lookups.
+ |
+ |        Input:  capacity          - Number of terminal geometries
+ |
+ |      Returns:  rtn               - SUCCESS or error code
+ |
+ *===========================================================================*/
+int P528_SetTerminalCacheCapacity(int capacity)
+{
+    if (capacity < 0)
+        return ERROR_VALIDATION__TERMINAL_CACHE;
+
+    TerminalCache* cache = NewTerminalCache(capacity);
+
+    lock_guard<mutex> lock(terminal_cache_mutex);
+    TerminalCache* old_cache = terminal_cache.exchange(cache);
+
+    // readers that register from now on load the new cache
+    unsigned epoch = terminal_cache_epoch.fetch_add(1);
+    for (int s = 0; s < TERMINAL_CACHE__SHARDS; s++)
+        while (terminal_cache_readers[epoch & 1][s].count.load() != 0)
+            this_thread::yield();
+
+    delete old_cache;
+
+    return SUCCESS;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Reads the hit and miss counts of the terminal geometry
+ |                cache, since its capacity was last set.
+ |
+ |      Outputs:  stats             - Terminal cache statistics structure
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void P528_GetTerminalCacheStatistics(TerminalCacheStatistics* stats)
+{
+    // the cache is not replaced while it is read
+    lock_guard<mutex> lock(terminal_cache_mutex);
+    TerminalCache* cache = terminal_cache.load();
+
+    stats->hits = 0;
+    stats->misses = 0;
+    for (int s = 0; s < TERMINAL_CACHE__SHARDS; s++)
+    {
+        stats->hits += cache->shards[s].hits.load(memory_order_relaxed);
+        stats->misses += cache->shards[s].misses.load(memory_order_relaxed);
+    }
+
+    stats->capacity = TERMINAL_CACHE__SHARDS * cache->sets * TERMINAL_CACHE__WAYS;
+}
\ No newline at end of file
@@ -2,6 +2,38 @@
 #include "../../include/p528.h"
 #include "../../include/p676.h"
 
+/*=============================================================================
+ |
+ |  Description:  Completes the terminal geometry from the ray traced from
+ |                the surface to the terminal
+ |
+ |        Input:  result    - Ray trace result of the horizontal ray
+ |                            launched from the surface
+ |
+ |      Outputs:  terminal  - Structure containing parameters dealing
+ |                            with the geometry of the terminal
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void TerminalRayGeometry(const SlantPathAttenuationResult* result, Terminal *terminal)
+{
+    double theta_tx__rad = 0;
+
+    terminal->theta__rad = PI / 2 - result->angle__rad;
+    terminal->A_a__db = result->A_gas__db;
+    terminal->a__km = result->a__km;
+
+    // compute arc distance
+    double central_angle = ((PI / 2 - result->angle__rad) - theta_tx__rad + result->bending__rad);          // [Thayer, Equ 2], rearranged
+    terminal->d_r__km = a_0__km * central_angle;
+
+    terminal->phi__rad = terminal->d_r__km / a_e__km;                   // [Eqn 4-1]
+    terminal->h_e__km = (a_e__km / cos(terminal->phi__rad)) - a_e__km;  // [Eqn 4-2]
+
+    terminal->delta_h__km = terminal->h_r__km - terminal->h_e__km;      // [Eqn 4-3]
+}
+
 /*=============================================================================
  |
  |  Description:  This file computes the terminal geometry as described
@@ -22,16 +54,43 @@ void TerminalGeometry(double f__mhz, Terminal *terminal)
     double theta_tx__rad = 0;
     SlantPathAttenuationResult result;
     SlantPathAttenuation(f__mhz / 1000, 0, terminal->h_r__km, PI / 2 - theta_tx__rad, &result);
-    terminal->theta__rad = PI / 2 - result.angle__rad;
-    terminal->A_a__db = result.A_gas__db;
-    terminal->a__km = result.a__km;
 
-    // compute arc distance
-    double central_angle = ((PI / 2 - result.angle__rad) - theta_tx__rad + result.bending__rad);            // [Thayer, Equ 2], rearranged
-    terminal->d_r__km = a_0__km * central_angle;
+    TerminalRayGeometry(&result, terminal);
+}
 
-    terminal->phi__rad = terminal->d_r__km / a_e__km;                   // [Eqn 4-1]
-    terminal->h_e__km = (a_e__km / cos(terminal->phi__rad)) - a_e__km;  // [Eqn 4-2]
+/*=============================================================================
+ |
+ |  Description:  Computes the terminal geometry of TerminalGeometry() at
+ |                several frequencies.  Only the atmospheric absorption
+ |                depends on the frequency, so the ray to the terminal is
+ |                traced once and its absorption is integrated at each
+ |                frequency.
+ |
+ |        Input:  h_r__km   - Real terminal height, in km
+ |                f__mhz    - Frequencies, in MHz
+ |                N         - Number of frequencies
+ |
+ |      Outputs:  terminals - Structures containing parameters dealing
+ |                            with the geometry of the terminal, one for
+ |                            each frequency
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void TerminalGeometrySweep(double h_r__km, const double* f__mhz, int N, Terminal* terminals)
+{
+    double theta_tx__rad = 0;
 
-    terminal->delta_h__km = terminal->h_r__km - terminal->h_e__km;      // [Eqn 4-3]
-}
+    vector<double> f__ghz(N);
+    for (int i = 0; i < N; i++)
+        f__ghz[i] = f__mhz[i] / 1000;
+
+    vector<SlantPathAttenuationResult> results(N);
+    SlantPathAttenuationSweep(f__ghz.data(), N, 0, h_r__km, PI / 2 - theta_tx__rad, results.data());
+
+    for (int i = 0; i < N; i++)
+    {
+        terminals[i].h_r__km = h_r__km;
+        TerminalRayGeometry(&results[i], &terminals[i]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include <math.h>
+#include "../../include/p528.h"
+
+/*=============================================================================
+ |
+ |  Description:  This function applies the time variability of Annex 2,
+ |                Sections 13 and 14 of Recommendation ITU-R P.528-5,
+ |                "Propagation curves for aeronautical mobile and
+ |                radionavigation services using the VHF, UHF and SHF
+ |                bands", to the time-independent results of a path.  Only
+ |                this step depends on the time percentage, so many time
+ |                percentages can share one MedianResult.
+ |
+ |        Input:  terminal_1        - Struct containing low terminal parameters
+ |                terminal_2        - Struct containing high terminal parameters
+ |                d__km             - Path distance, in km
+ |                f__mhz            - Frequency, in MHz
+ |                median            - Struct containing the time-independent
+ |                                    results of the path
+ |                p                 - Time percentage
+ |
+ |      Outputs:  result            - Result structure containing various
+ |                                    computed parameters
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void TimeVariability(Terminal *terminal_1, Terminal *terminal_2, double d__km, double f__mhz,
+    MedianResult *median, double p, Result *result)
+{
+    // compute the p% of the long-term variability distribution
+    double Y_e__db, A_Y;
+    LongTermVariability(terminal_1->d_r__km, terminal_2->d_r__km, d__km, f__mhz, p, median->f_theta_h, -median->A_T__db, &Y_e__db, &A_Y);
+
+    // compute the p% of the Nakagami-Rice distribution
+    double Y_pi_50__db = 0.0;       //  zero mean
+    double Y_pi__db = NakagamiRice(median->K__db, p);
+
+    // combine the long-term and Nakagami-Rice distributions
+    double Y_total__db = CombineDistributions(median->Y_e_50__db, Y_e__db, Y_pi_50__db, Y_pi__db, p);
+
+    result->propagation_mode = median->propagation_mode;
+    result->warnings |= median->warnings;
+    result->d__km = median->d__km;
+    result->A_fs__db = median->A_fs__db;
+    result->A_a__db = median->A_a__db;
+    result->A__db = result->A_fs__db + result->A_a__db + median->A_T__db - Y_total__db;    // [Eqn 3-20]
+    result->theta_h1__rad = median->theta_h1__rad;
+}
\ No newline at end of file
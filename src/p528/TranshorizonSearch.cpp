@@ -1,4 +1,117 @@
 #include "../../include/p528.h"
+#include "../../include/p676.h"
+
+static const int SEARCH_LIMIT = 100;    // 100 km beyond starting point
+
+// Search distances of Step 6.1, and the troposcatter loss at each as it is needed
+struct SearchPoints
+{
+    double d__km[SEARCH_LIMIT];
+    double A_s__db[SEARCH_LIMIT];
+    bool is_evaluated[SEARCH_LIMIT];
+};
+
+/*=============================================================================
+ |
+ |  Description:  Step 6.6 of the transhorizon search: selects the case of
+ |                the crossover, and adjusts the diffraction line to the
+ |                troposcatter model for CASE_2.
+ |
+ |        Input:  path              - Structure containing parameters dealing
+ |                                    with the propagation path
+ |                A_dML__db         - Diffraction loss at d_ML, in dB
+ |                d__km             - Search distance before the crossover,
+ |                                    in km
+ |                A_s__db           - Troposcatter loss at d__km, in dB
+ |
+ | Input/Output:  M_d               - Slope of the diffraction line
+ |                A_d0              - Intercept of the diffraction line
+ |
+ |      Outputs:  CASE              - Case as defined in Step 6.5
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void CrossoverCase(Path* path, double A_dML__db, double d__km, double A_s__db, double* M_d, double* A_d0,
+    int* CASE)
+{
+    double A_d__db = *M_d * d__km + *A_d0;                              // [Eqn 3-11]
+
+    if (A_s__db >= A_d__db)
+        *CASE = CASE_1;
+    else
+    {
+        // Adjust the diffraction line to the troposcatter model
+        *M_d = (A_s__db - A_dML__db) / (d__km - path->d_ML__km);        // [Eqn 3-12]
+        *A_d0 = A_s__db - (*M_d * d__km);                               // [Eqn 3-13]
+
+        *CASE = CASE_2;
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Step 6.1 of the transhorizon search: the search distances,
+ |                stepped 1 km at a time from d'
+ |
+ |        Input:  path              - Structure containing parameters dealing
+ |                                    with the propagation path
+ |
+ |      Outputs:  points            - Search distances, with no loss
+ |                                    evaluated yet
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void InitializeSearchPoints(Path* path, SearchPoints* points)
+{
+    points->d__km[0] = path->d_ML__km + 3;      // d', [Eqn 3-8]
+    points->is_evaluated[0] = false;
+
+    for (int i = 1; i < SEARCH_LIMIT; i++)
+    {
+        points->d__km[i] = points->d__km[i - 1];
+        points->d__km[i]++;
+        points->is_evaluated[i] = false;
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Step 6.2 of the transhorizon search: the troposcatter loss
+ |                at the ith search distance.  With the vector troposcatter
+ |                kernel, the losses are evaluated TROPOSCATTER__LANES
+ |                search distances at a time.
+ |
+ |        Input:  terms             - Troposcatter terms of the path
+ |                i                 - Index of the search distance
+ |
+ | Input/Output:  points            - Search distances and losses
+ |
+ |      Returns:  A_s__db           - Troposcatter loss, in dB
+ |
+ *===========================================================================*/
+static double SearchLoss(const TroposcatterTerms* terms, SearchPoints* points, int i)
+{
+    if (!points->is_evaluated[i])
+    {
+        int lanes = (GetLineKernel() != LINE_KERNEL__SCALAR) ? TROPOSCATTER__LANES : 1;
+        int i_start = i - i % lanes;
+        int N = MIN(lanes, SEARCH_LIMIT - i_start);
+
+        TroposcatterParams tropo[TROPOSCATTER__LANES];
+        double A_d__db[TROPOSCATTER__LANES];
+        TroposcatterDistances(terms, &points->d__km[i_start], N, 0, 0, tropo, A_d__db);
+
+        for (int j = 0; j < N; j++)
+        {
+            points->A_s__db[i_start + j] = tropo[j].A_s__db;
+            points->is_evaluated[i_start + j] = true;
+        }
+    }
+
+    return points->A_s__db[i];
+}
 
 /*=============================================================================
  |
@@ -9,11 +122,8 @@
  |
  |        Input:  path              - Structure containing parameters dealing
  |                                    with the propagation path
- |                terminal_1        - Structure containing parameters dealing
- |                                    with the geometry of the low terminal
- |                terminal_2        - Structure containing parameters dealing
- |                                    with the geometry of the high terminal
- |                f__mhz            - Frequency, in MHz
+ |                terms             - Troposcatter terms of the terminal
+ |                                    pair and frequency
  |                A_dML__db         - Diffraction loss at d_ML, in dB
  |
  |      Outputs:  M_d               - Slope of the diffraction line
@@ -25,15 +135,14 @@
  |      Returns:  [void]
  |
  *===========================================================================*/
-void TranshorizonSearch(Path* path, Terminal *terminal_1, Terminal *terminal_2, 
-    double f__mhz, double A_dML__db, double *M_d, double *A_d0, 
+void TranshorizonSearch(Path* path, const TroposcatterTerms* terms, double A_dML__db, double *M_d, double *A_d0, 
     double* d_crx__km, int *CASE, int *warnings)
 {
     *CASE = CONST_MODE__SEARCH;
     int k = 0;
 
-    TroposcatterParams tropo;
-    tropo.A_s__db = 0;
+    SearchPoints points;
+    InitializeSearchPoints(path, &points);
 
     // Step 6.1.  Initialize search parameters
     double d_search__km[2];
@@ -43,18 +152,15 @@ void TranshorizonSearch(Path* path, Terminal *terminal_1, Terminal *terminal_2,
     double A_s__db[2] = { 0 };
     double M_s = 0;
 
-    int SEARCH_LIMIT = 100; // 100 km beyond starting point
-
     for (int i_search = 0; i_search < SEARCH_LIMIT; i_search++)
     {
         A_s__db[1] = A_s__db[0];
 
         // Step 6.2
-        Troposcatter(path, terminal_1, terminal_2, d_search__km[0], f__mhz, &tropo);
-        A_s__db[0] = tropo.A_s__db;
+        A_s__db[0] = SearchLoss(terms, &points, i_search);
 
         // if loss is less than 20 dB, the result is not within valid part of model
-        if (tropo.A_s__db < 20.0)
+        if (A_s__db[0] < 20.0)
         {
             d_search__km[1] = d_search__km[0];
             d_search__km[0]++;
@@ -76,19 +182,7 @@ void TranshorizonSearch(Path* path, Terminal *terminal_1, Terminal *terminal_2,
         {
             *d_crx__km = d_search__km[0];
 
-            // Step 6.6
-            double A_d__db = *M_d * d_search__km[1] + *A_d0;                            // [Eqn 3-11]
-
-            if (A_s__db[1] >= A_d__db)
-                *CASE = CASE_1;
-            else
-            {
-                // Adjust the diffraction line to the troposcatter model
-                *M_d = (A_s__db[1] - A_dML__db) / (d_search__km[1] - path->d_ML__km);   // [Eqn 3-12]
-                *A_d0 = A_s__db[1] - (*M_d * d_search__km[1]);                          // [Eqn 3-13]
-
-                *CASE = CASE_2;
-            }
+            CrossoverCase(path, A_dML__db, d_search__km[1], A_s__db[1], M_d, A_d0, CASE);
 
             return;
         }
@@ -1,5 +1,37 @@
 #include <math.h>
 #include "../../include/p528.h"
+#include "../../include/p676.h"
+
+/*=============================================================================
+ |
+ |  Description:  Computes the terms of the troposcatter loss that do not
+ |                depend on the path distance, for TroposcatterDistances()
+ |
+ |        Input:  terminal_1    - Struct containing low terminal parameters
+ |                terminal_2    - Struct containing high terminal parameters
+ |                f__mhz        - Frequency, in MHz
+ |
+ |      Outputs:  terms         - Struct containing the terms
+ |
+ *===========================================================================*/
+void InitializeTroposcatter(Terminal* terminal_1, Terminal* terminal_2, double f__mhz, TroposcatterTerms* terms)
+{
+    terms->d_r1__km = terminal_1->d_r__km;
+    terms->d_r2__km = terminal_2->d_r__km;
+    terms->h_e1__km = terminal_1->h_e__km;
+    terms->h_e2__km = terminal_2->h_e__km;
+
+    double X_A1__km2 = pow(terminal_1->h_e__km, 2) + 4.0 * (a_e__km + terminal_1->h_e__km) * a_e__km * pow(sin(terminal_1->d_r__km / (a_e__km * 2)), 2);      // [Eqn 11-24]
+    double X_A2__km2 = pow(terminal_2->h_e__km, 2) + 4.0 * (a_e__km + terminal_2->h_e__km) * a_e__km * pow(sin(terminal_2->d_r__km / (a_e__km * 2)), 2);      // [Eqn 11-24]
+
+    terms->X_A1__km = sqrt(X_A1__km2);
+    terms->X_A2__km = sqrt(X_A2__km2);
+
+    terms->kappa = f__mhz / 0.0477;                                                  // [Eqn 11-29]
+
+    terms->epsilon_1 = 5.67e-6 * pow(N_s, 2) - 0.00232 * N_s + 0.031;                // [Eqn 11-20]
+    terms->epsilon_2 = 0.0002 * pow(N_s, 2) - 0.06 * N_s + 6.6;                      // [Eqn 11-21]
+}
 
 /*=============================================================================
  |
@@ -9,21 +41,19 @@
  |                aeronautical mobile and radionavigation services using
  |                the VHF, UHF and SHF bands"
  |
- |        Input:  path          - Struct containing path parameters
- |                terminal_1    - Struct containing low terminal parameters
- |                terminal_2    - Struct containing high terminal parameters
+ |        Input:  terms         - Struct containing the terms from
+ |                                InitializeTroposcatter()
  |                d__km         - Path distance, in km
- |                f__mhz        - Frequency, in MHz
  |
  |      Outputs:  tropo         - Struct containing resulting parameters
  |
  *===========================================================================*/
-void Troposcatter(Path *path, Terminal *terminal_1, Terminal *terminal_2, double d__km, double f__mhz, TroposcatterParams *tropo)
+static void TroposcatterDistance(const TroposcatterTerms* terms, double d__km, TroposcatterParams *tropo)
 {
     double Q_o, Q_a, Q_b, Q_A, Q_B;
     double z_a__km, z_b__km, Z_a__km, Z_b__km;
 
-    tropo->d_s__km = d__km - terminal_1->d_r__km - terminal_2->d_r__km;       // [Eqn 11-2]
+    tropo->d_s__km = d__km - terms->d_r1__km - terms->d_r2__km;             // [Eqn 11-2]
 
     if (tropo->d_s__km <= 0.0)
     {
@@ -73,8 +103,8 @@ void Troposcatter(Path *path, Terminal *terminal_1, Terminal *terminal_2, double
         ///////////////////////////////////////
         // Compute the scattering efficiency term
         // 
-        double epsilon_1 = 5.67e-6 * pow(N_s, 2) - 0.00232 * N_s + 0.031;           // [Eqn 11-20]
-        double epsilon_2 = 0.0002 * pow(N_s, 2) - 0.06 * N_s + 6.6;                 // [Eqn 11-21]
+        double epsilon_1 = terms->epsilon_1;
+        double epsilon_2 = terms->epsilon_2;
 
         double gamma = 0.1424 * (1.0 + epsilon_1 / exp(MIN(35.0, pow(tropo->h_v__km / 4.0, 6))));   // [Eqn 11-22]
 
@@ -88,20 +118,17 @@ void Troposcatter(Path *path, Terminal *terminal_1, Terminal *terminal_2, double
         // Compute the scattering volume term
         // 
 
-        double X_A1__km2 = pow(terminal_1->h_e__km, 2) + 4.0 * (a_e__km + terminal_1->h_e__km) * a_e__km * pow(sin(terminal_1->d_r__km / (a_e__km * 2)), 2);      // [Eqn 11-24]
-        double X_A2__km2 = pow(terminal_2->h_e__km, 2) + 4.0 * (a_e__km + terminal_2->h_e__km) * a_e__km * pow(sin(terminal_2->d_r__km / (a_e__km * 2)), 2);      // [Eqn 11-24]
-
-        double ell_1__km = sqrt(X_A1__km2) + tropo->d_z__km;                        // [Eqn 11-25]
-        double ell_2__km = sqrt(X_A2__km2) + tropo->d_z__km;                        // [Eqn 11-25]
+        double ell_1__km = terms->X_A1__km + tropo->d_z__km;                        // [Eqn 11-25]
+        double ell_2__km = terms->X_A2__km + tropo->d_z__km;                        // [Eqn 11-25]
         double ell__km = ell_1__km + ell_2__km;                                     // [Eqn 11-26]
 
         double s = (ell_1__km - ell_2__km) / ell__km;                               // [Eqn 11-27]
         double eta = gamma * tropo->theta_s * ell__km / 2;                          // [Eqn 11-28]
 
-        double kappa = f__mhz / 0.0477;                                             // [Eqn 11-29]
+        double kappa = terms->kappa;
 
-        double rho_1__km = 2.0 * kappa * tropo->theta_s * terminal_1->h_e__km;      // [Eqn 11-30]
-        double rho_2__km = 2.0 * kappa * tropo->theta_s * terminal_2->h_e__km;      // [Eqn 11-30]
+        double rho_1__km = 2.0 * kappa * tropo->theta_s * terms->h_e1__km;           // [Eqn 11-30]
+        double rho_2__km = 2.0 * kappa * tropo->theta_s * terms->h_e2__km;           // [Eqn 11-30]
 
         double SQRT2 = sqrt(2);
 
@@ -135,4 +162,52 @@ void Troposcatter(Path *path, Terminal *terminal_1, Terminal *terminal_2, double
 
         tropo->A_s__db = S_e__db + S_v__db + 10.0 * log10(kappa * pow(tropo->theta_s, 3) / ell__km);
     }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Computes the troposcatter loss, and the diffraction line,
+ |                at each of an array of path distances.  On processors
+ |                with AVX2, the distances are evaluated
+ |                TROPOSCATTER__LANES at a time by the vector kernel, and
+ |                a single distance is evaluated by the same kernel, so
+ |                every result is identical however the distances are
+ |                grouped.
+ |
+ |        Input:  terms         - Struct containing the terms from
+ |                                InitializeTroposcatter()
+ |                d__km         - Path distances, in km
+ |                N             - Number of path distances
+ |                M_d           - Slope of the diffraction line
+ |                A_d0          - Intercept of the diffraction line
+ |
+ |      Outputs:  tropo         - Structs containing resulting parameters,
+ |                                one for each distance
+ |                A_d__db       - Diffraction line loss at each distance,
+ |                                in dB
+ |
+ *===========================================================================*/
+void TroposcatterDistances(const TroposcatterTerms* terms, const double* d__km, int N, double M_d, double A_d0,
+    TroposcatterParams* tropo, double* A_d__db)
+{
+    bool is_vector = false;
+
+#if defined(LINE_KERNEL__X86)
+    // as with the ray trace kernel, the AVX2 kernel is also used with AVX-512
+    if (GetLineKernel() != LINE_KERNEL__SCALAR)
+    {
+        for (int i = 0; i < N; i += TROPOSCATTER__LANES)
+            TroposcatterLanes_AVX2(terms, &d__km[i], MIN(N - i, TROPOSCATTER__LANES), &tropo[i]);
+        is_vector = true;
+    }
+#endif
+
+    if (!is_vector)
+    {
+        for (int i = 0; i < N; i++)
+            TroposcatterDistance(terms, d__km[i], &tropo[i]);
+    }
+
+    for (int i = 0; i < N; i++)
+        A_d__db[i] = M_d * d__km[i] + A_d0;                                         // [Eqn 3-14]
 }
\ No newline at end of file
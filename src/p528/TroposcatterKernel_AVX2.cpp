@@ -0,0 +1,299 @@
+#include <math.h>
+#include "../../include/p528.h"
+#include "../../include/p676.h"
+
+#if defined(LINE_KERNEL__X86)
+
+#include <immintrin.h>
+
+/*=============================================================================
+ |
+ |  Description:  Vector exponential, as in the spectral line kernel.  The
+ |                argument is reduced by multiples of ln(2) and the
+ |                remainder is evaluated with a degree 13 Taylor
+ |                polynomial, to within a few ULP of exp().
+ |
+ |        Input:  x             - Argument
+ |
+ |      Returns:  e^x
+ |
+ *===========================================================================*/
+TARGET_AVX2 static inline __m256d Exp_AVX2(__m256d x)
+{
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-708)), _mm256_set1_pd(709));
+
+    // x = n * ln(2) + r, with ln(2) split in two parts so the reduction is exact
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634074)),
+        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(6.93145751953125e-1), x);
+    r = _mm256_fnmadd_pd(n, _mm256_set1_pd(1.42860682030941723212e-6), r);
+
+    __m256d p = _mm256_set1_pd(1.0 / 6227020800.0);
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 479001600.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 39916800.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 3628800.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 362880.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 40320.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 5040.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 720.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 120.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 24.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 6.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(0.5));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+
+    // scale by 2^n, built directly in the exponent bits
+    __m256i k = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));
+    k = _mm256_slli_epi64(_mm256_add_epi64(k, _mm256_set1_epi64x(1023)), 52);
+
+    return _mm256_mul_pd(p, _mm256_castsi256_pd(k));
+}
+
+/*=============================================================================
+ |
+ |  Description:  Vector natural logarithm for positive, normal arguments,
+ |                from the reduction and minimax polynomial of the fdlibm
+ |                log(), to within a few ULP of log().
+ |
+ |        Input:  x             - Argument
+ |
+ |      Returns:  ln(x)
+ |
+ *===========================================================================*/
+TARGET_AVX2 static inline __m256d Log_AVX2(__m256d x)
+{
+    __m256d one = _mm256_set1_pd(1);
+
+    // x = 2^k * m, with 1 <= m < 2.  The exponent is converted by adding its bits to those of 2^52
+    __m256i bits = _mm256_castpd_si256(x);
+    __m256d two_52 = _mm256_set1_pd(4503599627370496.0);
+    __m256d k = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52),
+        _mm256_castpd_si256(two_52))), two_52);
+    k = _mm256_sub_pd(k, _mm256_set1_pd(1023));
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+        _mm256_castpd_si256(one)));
+
+    // keep m within [sqrt(2)/2, sqrt(2)), so that f = m - 1 is small
+    __m256d is_high = _mm256_cmp_pd(m, _mm256_set1_pd(1.41421356237309504880), _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), is_high);
+    k = _mm256_add_pd(k, _mm256_and_pd(is_high, one));
+
+    // ln(1 + f) = f - f^2 / 2 + s * (f^2 / 2 + R(s^2)), with s = f / (2 + f)
+    __m256d f = _mm256_sub_pd(m, one);
+    __m256d s = _mm256_div_pd(f, _mm256_add_pd(f, _mm256_set1_pd(2)));
+    __m256d z = _mm256_mul_pd(s, s);
+    __m256d hfsq = _mm256_mul_pd(_mm256_mul_pd(f, f), _mm256_set1_pd(0.5));
+
+    __m256d R = _mm256_set1_pd(1.479819860511658591e-01);
+    R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(1.531383769920937332e-01));
+    R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(1.818357216161805012e-01));
+    R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(2.222219843214978396e-01));
+    R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(2.857142874366239149e-01));
+    R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(3.999999999940941908e-01));
+    R = _mm256_fmadd_pd(R, z, _mm256_set1_pd(6.666666666666735130e-01));
+    R = _mm256_mul_pd(R, z);
+
+    // k * ln(2) is added with ln(2) split in two parts, as in the reduction of Exp_AVX2()
+    __m256d low = _mm256_fmadd_pd(k, _mm256_set1_pd(1.90821492927058770002e-10),
+        _mm256_mul_pd(s, _mm256_add_pd(hfsq, R)));
+    __m256d log_m = _mm256_sub_pd(f, _mm256_sub_pd(hfsq, low));
+
+    return _mm256_fmadd_pd(k, _mm256_set1_pd(6.93147180369123816490e-01), log_m);
+}
+
+/*=============================================================================
+ |
+ |  Description:  The Q terms of Eqns 11-13 and 11-16,
+ |                A_m - dN / exp(MIN(35, z / gamma_e))
+ |
+ |        Input:  z             - Height, in km
+ |                A_m           - From Eqn 11-7
+ |                dN            - From Eqn 11-8
+ |                inv_gamma_e   - 1 / gamma_e, from Eqn 11-9
+ |
+ |      Returns:  Q
+ |
+ *===========================================================================*/
+TARGET_AVX2 static inline __m256d Q_AVX2(__m256d z, __m256d A_m, __m256d dN, __m256d inv_gamma_e)
+{
+    __m256d x = _mm256_min_pd(_mm256_mul_pd(z, inv_gamma_e), _mm256_set1_pd(35.0));
+
+    return _mm256_sub_pd(A_m, _mm256_div_pd(dN, Exp_AVX2(x)));
+}
+
+/*=============================================================================
+ |
+ |  Description:  Troposcatter loss of Annex 2, Section 11 of
+ |                Recommendation ITU-R P.528-5, for up to 4 path distances,
+ |                one per vector lane.  The exponentials and logarithms are
+ |                taken from Exp_AVX2() and Log_AVX2(), and the logarithms
+ |                of Eqn 11-23 and of the scattering volume and loss terms
+ |                are each taken once, of their combined arguments.
+ |
+ |        Input:  terms         - Struct containing the terms from
+ |                                InitializeTroposcatter()
+ |                d__km         - Path distance of each lane, in km
+ |                lanes         - Number of distances, up to 4
+ |
+ |      Outputs:  tropo         - Struct containing resulting parameters,
+ |                                one for each distance
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX2 void TroposcatterLanes_AVX2(const TroposcatterTerms* terms, const double* d__km, int lanes,
+    TroposcatterParams* tropo)
+{
+    // unused lanes repeat the first distance
+    double d[4];
+    for (int l = 0; l < 4; l++)
+        d[l] = d__km[(l < lanes) ? l : 0];
+
+    __m256d one = _mm256_set1_pd(1);
+    __m256d two = _mm256_set1_pd(2);
+    __m256d limit = _mm256_set1_pd(35.0);
+    __m256d log10_e = _mm256_set1_pd(0.43429448190325182765);
+
+    double A_m = 1 / a_0__km;                                                       // [Eqn 11-7]
+    double dN = A_m - (1.0 / a_e__km);                                              // [Eqn 11-8]
+    double gamma_e__km = (N_s * 1e-6) / dN;                                         // [Eqn 11-9]
+
+    __m256d A_m_v = _mm256_set1_pd(A_m);
+    __m256d dN_v = _mm256_set1_pd(dN);
+    __m256d inv_gamma_e = _mm256_set1_pd(1 / gamma_e__km);
+    __m256d Q_o = _mm256_set1_pd(A_m - dN);                                         // [Eqn 11-12]
+
+    __m256d d_s = _mm256_sub_pd(_mm256_sub_pd(_mm256_loadu_pd(d), _mm256_set1_pd(terms->d_r1__km)),
+        _mm256_set1_pd(terms->d_r2__km));                                           // [Eqn 11-2]
+    __m256d is_scatter = _mm256_cmp_pd(d_s, _mm256_setzero_pd(), _CMP_GT_OQ);
+
+    ///////////////////////////////////////
+    // Compute the geometric parameters
+    //
+
+    __m256d d_z = _mm256_mul_pd(d_s, _mm256_set1_pd(0.5));                          // [Eqn 11-6]
+    __m256d d_z2 = _mm256_mul_pd(d_z, d_z);
+    __m256d d_z_2 = _mm256_mul_pd(d_z, _mm256_set1_pd(0.5));
+
+    __m256d z_a = _mm256_mul_pd(_mm256_set1_pd(1.0 / (2 * a_e__km)), _mm256_mul_pd(d_z_2, d_z_2));     // [Eqn 11-10]
+    __m256d z_b = _mm256_mul_pd(_mm256_set1_pd(1.0 / (2 * a_e__km)), d_z2);                            // [Eqn 11-11]
+
+    __m256d Q_a = Q_AVX2(z_a, A_m_v, dN_v, inv_gamma_e);                           // [Eqn 11-13]
+    __m256d Q_b = Q_AVX2(z_b, A_m_v, dN_v, inv_gamma_e);                           // [Eqn 11-13]
+
+    __m256d Z_a = _mm256_mul_pd(_mm256_sub_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(7.0), Q_o),
+        _mm256_mul_pd(_mm256_set1_pd(6.0), Q_a)), Q_b), _mm256_div_pd(d_z2, _mm256_set1_pd(96.0)));  // [Eqn 11-14]
+    __m256d Z_b = _mm256_mul_pd(_mm256_add_pd(Q_o, _mm256_mul_pd(two, Q_a)),
+        _mm256_div_pd(d_z2, _mm256_set1_pd(6.0)));                                  // [Eqn 11-15]
+
+    __m256d Q_A = Q_AVX2(Z_a, A_m_v, dN_v, inv_gamma_e);                           // [Eqn 11-16]
+    __m256d Q_B = Q_AVX2(Z_b, A_m_v, dN_v, inv_gamma_e);                           // [Eqn 11-16]
+
+    __m256d h_v = _mm256_mul_pd(_mm256_add_pd(Q_o, _mm256_mul_pd(two, Q_A)),
+        _mm256_div_pd(d_z2, _mm256_set1_pd(6.0)));                                  // [Eqn 11-17]
+
+    __m256d theta_A = _mm256_div_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(Q_o,
+        _mm256_mul_pd(_mm256_set1_pd(4.0), Q_A)), Q_B), d_z), _mm256_set1_pd(6.0)); // [Eqn 11-18]
+
+    __m256d theta_s = _mm256_mul_pd(two, theta_A);                                  // [Eqn 11-19]
+
+    ///////////////////////////////////////
+    // Compute the scattering efficiency term
+    //
+
+    __m256d h_v_4 = _mm256_mul_pd(h_v, _mm256_set1_pd(0.25));
+    __m256d h_v_4_2 = _mm256_mul_pd(h_v_4, h_v_4);
+    __m256d h_v_4_6 = _mm256_mul_pd(_mm256_mul_pd(h_v_4_2, h_v_4_2), h_v_4_2);
+
+    __m256d gamma = _mm256_mul_pd(_mm256_set1_pd(0.1424), _mm256_add_pd(one,
+        _mm256_div_pd(_mm256_set1_pd(terms->epsilon_1), Exp_AVX2(_mm256_min_pd(h_v_4_6, limit)))));     // [Eqn 11-22]
+
+    // log10((0.1424 / gamma)^2 * exp(gamma * h_v)) = (2 * ln(0.1424 / gamma) + gamma * h_v) * log10(e)
+    __m256d S_e = _mm256_sub_pd(_mm256_set1_pd(83.1), _mm256_div_pd(_mm256_set1_pd(terms->epsilon_2),
+        _mm256_add_pd(one, _mm256_mul_pd(_mm256_set1_pd(0.07716), _mm256_mul_pd(h_v, h_v)))));
+    __m256d ln_S_e = _mm256_add_pd(_mm256_mul_pd(two, Log_AVX2(_mm256_div_pd(_mm256_set1_pd(0.1424), gamma))),
+        _mm256_mul_pd(gamma, h_v));
+    S_e = _mm256_add_pd(S_e, _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(20), log10_e), ln_S_e));     // [Eqn 11-23]
+
+    ///////////////////////////////////////
+    // Compute the scattering volume term
+    //
+
+    __m256d ell_1 = _mm256_add_pd(_mm256_set1_pd(terms->X_A1__km), d_z);          // [Eqn 11-25]
+    __m256d ell_2 = _mm256_add_pd(_mm256_set1_pd(terms->X_A2__km), d_z);          // [Eqn 11-25]
+    __m256d ell = _mm256_add_pd(ell_1, ell_2);                                      // [Eqn 11-26]
+
+    __m256d s = _mm256_div_pd(_mm256_sub_pd(ell_1, ell_2), ell);                    // [Eqn 11-27]
+    __m256d eta = _mm256_mul_pd(_mm256_mul_pd(gamma, theta_s), _mm256_mul_pd(ell, _mm256_set1_pd(0.5)));  // [Eqn 11-28]
+
+    __m256d rho_1 = _mm256_mul_pd(_mm256_set1_pd(2.0 * terms->kappa * terms->h_e1__km), theta_s);        // [Eqn 11-30]
+    __m256d rho_2 = _mm256_mul_pd(_mm256_set1_pd(2.0 * terms->kappa * terms->h_e2__km), theta_s);        // [Eqn 11-30]
+
+    __m256d SQRT2 = _mm256_set1_pd(1.41421356237309504880);
+
+    __m256d s2 = _mm256_mul_pd(s, s);
+    __m256d one_minus_s2 = _mm256_sub_pd(one, s2);
+    __m256d A = _mm256_mul_pd(one_minus_s2, one_minus_s2);                          // [Eqn 11-36]
+
+    __m256d one_plus_s = _mm256_add_pd(one, s);
+    __m256d one_minus_s = _mm256_sub_pd(one, s);
+    __m256d X_v1 = _mm256_mul_pd(_mm256_mul_pd(one_plus_s, one_plus_s), eta);      // [Eqn 11-32]
+    __m256d X_v2 = _mm256_mul_pd(_mm256_mul_pd(one_minus_s, one_minus_s), eta);    // [Eqn 11-33]
+
+    __m256d X_v1_2 = _mm256_mul_pd(X_v1, X_v1);
+    __m256d X_v2_2 = _mm256_mul_pd(X_v2, X_v2);
+    __m256d rho_1_2 = _mm256_mul_pd(rho_1, rho_1);
+    __m256d rho_2_2 = _mm256_mul_pd(rho_2, rho_2);
+
+    __m256d q_1 = _mm256_add_pd(X_v1_2, rho_1_2);                                   // [Eqn 11-34]
+    __m256d q_2 = _mm256_add_pd(X_v2_2, rho_2_2);                                   // [Eqn 11-35]
+
+    // [Eqn 11-37]
+    __m256d eight = _mm256_set1_pd(8);
+    __m256d B_s = _mm256_add_pd(_mm256_set1_pd(6), _mm256_mul_pd(eight, s2));
+    B_s = _mm256_add_pd(B_s, _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(eight, one_minus_s), X_v1_2),
+        rho_1_2), _mm256_mul_pd(q_1, q_1)));
+    B_s = _mm256_add_pd(B_s, _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(eight, one_plus_s), X_v2_2),
+        rho_2_2), _mm256_mul_pd(q_2, q_2)));
+    B_s = _mm256_add_pd(B_s, _mm256_mul_pd(_mm256_mul_pd(_mm256_mul_pd(two, one_minus_s2),
+        _mm256_add_pd(one, _mm256_div_pd(_mm256_mul_pd(two, X_v1_2), q_1))),
+        _mm256_add_pd(one, _mm256_div_pd(_mm256_mul_pd(two, X_v2_2), q_2))));
+
+    // [Eqn 11-38]
+    __m256d C_1 = _mm256_div_pd(_mm256_add_pd(rho_1, SQRT2), rho_1);
+    __m256d C_2 = _mm256_div_pd(_mm256_add_pd(rho_2, SQRT2), rho_2);
+    __m256d rho = _mm256_add_pd(rho_1, rho_2);
+    __m256d C_s = _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(12), _mm256_mul_pd(C_1, C_1)), _mm256_mul_pd(C_2, C_2));
+    C_s = _mm256_div_pd(_mm256_mul_pd(C_s, rho), _mm256_add_pd(rho, _mm256_mul_pd(two, SQRT2)));
+
+    __m256d temp = _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_add_pd(_mm256_mul_pd(A, _mm256_mul_pd(eta, eta)),
+        _mm256_mul_pd(B_s, eta)), q_1), q_2), _mm256_mul_pd(rho_1_2, rho_2_2));
+
+    // S_v + 10 * log10(kappa * theta_s^3 / ell), as a single logarithm
+    __m256d theta_s3 = _mm256_mul_pd(_mm256_mul_pd(theta_s, theta_s), theta_s);
+    __m256d loss = _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(_mm256_add_pd(temp, C_s), _mm256_set1_pd(terms->kappa)),
+        theta_s3), ell);
+    __m256d A_s = _mm256_add_pd(S_e, _mm256_mul_pd(_mm256_mul_pd(_mm256_set1_pd(10), log10_e), Log_AVX2(loss)));
+
+    // paths within the horizons of the terminals have no common volume
+    double values[6][4];
+    _mm256_storeu_pd(values[0], _mm256_and_pd(is_scatter, d_s));
+    _mm256_storeu_pd(values[1], _mm256_and_pd(is_scatter, d_z));
+    _mm256_storeu_pd(values[2], _mm256_and_pd(is_scatter, h_v));
+    _mm256_storeu_pd(values[3], _mm256_and_pd(is_scatter, theta_s));
+    _mm256_storeu_pd(values[4], _mm256_and_pd(is_scatter, theta_A));
+    _mm256_storeu_pd(values[5], _mm256_and_pd(is_scatter, A_s));
+
+    for (int l = 0; l < lanes; l++)
+    {
+        tropo[l].d_s__km = values[0][l];
+        tropo[l].d_z__km = values[1][l];
+        tropo[l].h_v__km = values[2][l];
+        tropo[l].theta_s = values[3][l];
+        tropo[l].theta_A = values[4][l];
+        tropo[l].A_s__db = values[5][l];
+    }
+}
+
+#endif
\ No newline at end of file
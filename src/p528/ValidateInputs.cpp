@@ -2,7 +2,8 @@
 
 /*=============================================================================
  |
- |  Description:  Validate the model input values
+ |  Description:  Validate the model input values.  A NaN input fails
+ |                its range check
  |
  |        Input:  d__km             - Path distance, in km
  |                h_1__meter        - Height of the low terminal, in meters
@@ -23,13 +24,50 @@ int ValidateInputs(double d__km, double h_1__meter, double h_2__meter,
 {
     int rtn = SUCCESS;
 
-    if (d__km < 0)
+    if (!(d__km >= 0))
         return ERROR_VALIDATION__D_KM;
 
-    if (h_1__meter < 1.5 || h_1__meter > 80000)
+    rtn = ValidateTerminalInputs(h_1__meter, h_2__meter, f__mhz, T_pol, warnings);
+    if (rtn != SUCCESS)
+        return rtn;
+
+    if (!(p >= 1))
+        return ERROR_VALIDATION__PERCENT_LOW;
+
+    if (p > 99)
+        return ERROR_VALIDATION__PERCENT_HIGH;
+
+    if (h_1__meter == h_2__meter && d__km == 0)
+        return ERROR_HEIGHT_AND_DISTANCE;
+
+    return SUCCESS;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Validate the model input values that describe the
+ |                terminals and the link, independent of the path distance
+ |                and time percentage.  A NaN input fails its range check
+ |
+ |        Input:  h_1__meter        - Height of the low terminal, in meters
+ |                h_2__meter        - Height of the high terminal, in meters
+ |                f__mhz            - Frequency, in MHz
+ |                T_pol             - Code indicating either polarization
+ |                                      + 0 : POLARIZATION__HORIZONTAL
+ |                                      + 1 : POLARIZATION__VERTICAL
+ |
+ |       Output:  warnings          - Warning flags
+ |
+ |      Returns:  SUCCESS, or validation error code
+ |
+ *===========================================================================*/
+int ValidateTerminalInputs(double h_1__meter, double h_2__meter, double f__mhz,
+    int T_pol, int* warnings)
+{
+    if (!(h_1__meter >= 1.5 && h_1__meter <= 80000))
         return ERROR_VALIDATION__H_1;
 
-    if (h_2__meter < 1.5 || h_2__meter > 80000)
+    if (!(h_2__meter >= 1.5 && h_2__meter <= 80000))
         return ERROR_VALIDATION__H_2;
 
     if (h_1__meter > 20000 && h_1__meter <= 80000)
@@ -41,7 +79,7 @@ int ValidateInputs(double d__km, double h_1__meter, double h_2__meter,
     if (h_1__meter > h_2__meter)
         return ERROR_VALIDATION__TERM_GEO;
 
-    if (f__mhz < 100)
+    if (!(f__mhz >= 100))
         return ERROR_VALIDATION__F_MHZ_LOW;
 
     if (f__mhz > 30000)
@@ -51,14 +89,5 @@ int ValidateInputs(double d__km, double h_1__meter, double h_2__meter,
         T_pol != POLARIZATION__VERTICAL)
         return ERROR_VALIDATION__POLARIZATION;
 
-    if (p < 1)
-        return ERROR_VALIDATION__PERCENT_LOW;
-
-    if (p > 99)
-        return ERROR_VALIDATION__PERCENT_HIGH;
-
-    if (h_1__meter == h_2__meter && d__km == 0)
-        return ERROR_HEIGHT_AND_DISTANCE;
-
     return SUCCESS;
 }
\ No newline at end of file
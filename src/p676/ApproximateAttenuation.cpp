@@ -0,0 +1,333 @@
+#include <math.h>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <shared_mutex>
+#include "../../include/p676.h"
+
+// The line-by-line engine is used until another is selected
+static atomic<int> attenuation_engine(ATTENUATION_ENGINE__LINE_BY_LINE);
+
+static map<double, shared_ptr<const AttenuationFit>> attenuation_fit_cache;
+static deque<double> attenuation_fit_cache_order;       // insertion order, for eviction
+static shared_timed_mutex attenuation_fit_cache_mutex;
+
+// Pressure terms of the fit, as powers of p and e.  In the far wing of a line, the strength is
+// linear in pressure and the width adds another power, the interference and the Lorentzian
+// denominators add a third and fourth, and the Zeeman floor of the oxygen lines adds a constant
+static const int P_POWER[APPROXIMATE__TERMS] = { 0, 2, 1, 0, 3, 4, 2 };
+static const int E_POWER[APPROXIMATE__TERMS] = { 0, 0, 1, 2, 0, 0, 1 };
+
+void SetAttenuationEngine(int engine)
+{
+    attenuation_engine = engine;
+}
+
+int GetAttenuationEngine()
+{
+    return attenuation_engine;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Terms of the far-wing fit for an atmospheric state.
+ |                Pressures are scaled by 1013 hPa to keep the terms of a
+ |                similar magnitude.
+ |
+ |        Input:  theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Outputs:  terms         - Fit terms, in the order of the coefficients
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void FitTerms(double theta, double e__hPa, double p__hPa, double* terms)
+{
+    double x = p__hPa / 1013;
+    double y = e__hPa / 1013;
+    double u = log(theta);
+
+    for (int j = 0; j < APPROXIMATE__TERMS; j++)
+    {
+        double term = pow(x, P_POWER[j]) * pow(y, E_POWER[j]);
+        for (int k = 0; k < APPROXIMATE__ORDER; k++)
+        {
+            terms[j * APPROXIMATE__ORDER + k] = term;
+            term *= u;
+        }
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Solves the linear least squares problem min |A x - b|,
+ |                by Householder QR of the column-scaled A.
+ |
+ |        Input:  A             - Matrix, A[i][j] for row i and column j.
+ |                                Overwritten
+ |                b             - Right hand side.  Overwritten
+ |
+ |      Outputs:  x             - Solution
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void SolveLeastSquares(vector<vector<double>>& A, vector<double>& b, vector<double>* x)
+{
+    int N = A.size();
+    int M = A[0].size();
+
+    // scale the columns to unit length
+    vector<double> scale(M, 0);
+    for (int j = 0; j < M; j++)
+    {
+        for (int i = 0; i < N; i++)
+            scale[j] += A[i][j] * A[i][j];
+        scale[j] = sqrt(scale[j]);
+        for (int i = 0; i < N; i++)
+            A[i][j] /= scale[j];
+    }
+
+    vector<double> v(N);
+    for (int j = 0; j < M; j++)
+    {
+        double norm = 0;
+        for (int i = j; i < N; i++)
+            norm += A[i][j] * A[i][j];
+        norm = sqrt(norm);
+
+        // reflect column j onto the diagonal
+        double alpha = (A[j][j] > 0) ? -norm : norm;
+        for (int i = j; i < N; i++)
+            v[i] = A[i][j];
+        v[j] -= alpha;
+
+        double v_2 = 0;
+        for (int i = j; i < N; i++)
+            v_2 += v[i] * v[i];
+        if (v_2 == 0)
+            continue;
+
+        for (int c = j; c < M; c++)
+        {
+            double d = 0;
+            for (int i = j; i < N; i++)
+                d += v[i] * A[i][c];
+            d *= 2 / v_2;
+            for (int i = j; i < N; i++)
+                A[i][c] -= d * v[i];
+        }
+
+        double d = 0;
+        for (int i = j; i < N; i++)
+            d += v[i] * b[i];
+        d *= 2 / v_2;
+        for (int i = j; i < N; i++)
+            b[i] -= d * v[i];
+    }
+
+    // back substitution
+    x->assign(M, 0);
+    for (int j = M - 1; j >= 0; j--)
+    {
+        double sum = b[j];
+        for (int c = j + 1; c < M; c++)
+            sum -= A[j][c] * (*x)[c];
+        (*x)[j] = sum / A[j][j];
+    }
+
+    for (int j = 0; j < M; j++)
+        (*x)[j] /= scale[j];
+}
+
+/*=============================================================================
+ |
+ |  Description:  Fits the approximate engine at a frequency.  Lines within
+ |                APPROXIMATE__NEAR__GHZ of the frequency are kept for exact
+ |                summation, and the far wings of the remaining lines are
+ |                fitted, for minimum relative error in the specific
+ |                attenuation, over the atmospheric states covered by the
+ |                engine.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |
+ |      Outputs:  fit           - Fit structure
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void ComputeAttenuationFit(double f__ghz, AttenuationFit* fit)
+{
+    fit->f__ghz = f__ghz;
+
+    vector<int> near_o, near_w;
+    for (int i = 0; i < (int)OxygenData::f_0.size(); i++)
+        if (abs(OxygenData::f_0[i] - f__ghz) < APPROXIMATE__NEAR__GHZ)
+            near_o.push_back(i);
+    for (int i = 0; i < (int)WaterVapourData::f_0.size(); i++)
+        if (abs(WaterVapourData::f_0[i] - f__ghz) < APPROXIMATE__NEAR__GHZ)
+            near_w.push_back(i);
+
+    fit->oxygen = BuildOxygenLineTable(near_o);
+    fit->water_vapour = BuildWaterVapourLineTable(near_w);
+
+    const OxygenLineTable& oxygen = GetOxygenLineTable();
+    const WaterVapourLineTable& water_vapour = GetWaterVapourLineTable();
+
+    const int M = APPROXIMATE__TERMS * APPROXIMATE__ORDER;
+    double terms[M];
+
+    vector<vector<double>> A;
+    vector<double> b;
+
+    // sample every 10 K, 25 steps of log pressure and 5 water vapour ratios
+    double log_p_min = log(APPROXIMATE__P_MIN__HPA);
+    double log_p_max = log(APPROXIMATE__P_MAX__HPA);
+    for (double T__kelvin = APPROXIMATE__T_MIN__KELVIN; T__kelvin <= APPROXIMATE__T_MAX__KELVIN; T__kelvin += 10)
+    {
+        for (int i = 0; i <= 25; i++)
+        {
+            double p__hPa = exp(log_p_min + i * (log_p_max - log_p_min) / 25);
+
+            for (int j = 0; j <= 4; j++)
+            {
+                double e__hPa = p__hPa * APPROXIMATE__E_RATIO_MAX * j / 4;
+                double theta = 300 / T__kelvin;
+
+                double N_near = OxygenLineSum(fit->oxygen, f__ghz, theta, e__hPa, p__hPa)
+                    + WaterVapourLineSum(fit->water_vapour, f__ghz, theta, e__hPa, p__hPa);
+                double N_lines = OxygenLineSum(oxygen, f__ghz, theta, e__hPa, p__hPa)
+                    + WaterVapourLineSum(water_vapour, f__ghz, theta, e__hPa, p__hPa);
+                double N = N_lines + NonresonantDebyeAttenuation(f__ghz, e__hPa, p__hPa, theta);
+
+                // weight each sample by the full refractivity, for relative error
+                FitTerms(theta, e__hPa, p__hPa, terms);
+                for (int k = 0; k < M; k++)
+                    terms[k] /= N;
+
+                A.push_back(vector<double>(terms, terms + M));
+                b.push_back((N_lines - N_near) / N);
+            }
+        }
+    }
+
+    vector<double> c;
+    SolveLeastSquares(A, b, &c);
+
+    for (int j = 0; j < APPROXIMATE__TERMS; j++)
+        for (int k = 0; k < APPROXIMATE__ORDER; k++)
+            fit->c[j][k] = c[j * APPROXIMATE__ORDER + k];
+}
+
+/*=============================================================================
+ |
+ |  Description:  Returns the approximate engine fit at a frequency, from a
+ |                cache shared across calls and threads.  The oldest fit is
+ |                evicted once the cache holds APPROXIMATE__CAPACITY fits.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |
+ |      Returns:  fit           - Fit
+ |
+ *===========================================================================*/
+shared_ptr<const AttenuationFit> GetAttenuationFit(double f__ghz)
+{
+    // every layer of a ray trace asks for the same fit
+    thread_local shared_ptr<const AttenuationFit> last;
+    if (last && last->f__ghz == f__ghz)
+        return last;
+
+    {
+        shared_lock<shared_timed_mutex> lock(attenuation_fit_cache_mutex);
+
+        auto it = attenuation_fit_cache.find(f__ghz);
+        if (it != attenuation_fit_cache.end())
+            return last = it->second;
+    }
+
+    // compute outside of the lock, so other traces are not blocked
+    shared_ptr<AttenuationFit> fit = make_shared<AttenuationFit>();
+    ComputeAttenuationFit(f__ghz, fit.get());
+
+    unique_lock<shared_timed_mutex> lock(attenuation_fit_cache_mutex);
+
+    // another thread may have added the same fit in the meantime
+    auto it = attenuation_fit_cache.find(f__ghz);
+    if (it != attenuation_fit_cache.end())
+        return last = it->second;
+
+    while (attenuation_fit_cache.size() >= APPROXIMATE__CAPACITY)
+    {
+        attenuation_fit_cache.erase(attenuation_fit_cache_order.front());
+        attenuation_fit_cache_order.pop_front();
+    }
+
+    attenuation_fit_cache[f__ghz] = fit;
+    attenuation_fit_cache_order.push_back(f__ghz);
+
+    return last = fit;
+}
+
+/*=============================================================================
+ |
+ |  Description:  The specific gaseous attenuation due to dry air and
+ |                water vapour, in dB/km, from the approximate engine.  The
+ |                lines near the frequency and the nonresonant Debye
+ |                spectrum are summed exactly, and the far wings of the
+ |                remaining lines are taken from a fit in pressure and
+ |                temperature.  Atmospheric states outside of those covered
+ |                by the fit use the line-by-line engine.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |                T__kelvin     - Temperature, in Kelvin
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Returns:  gamma         - Specific gaseous attenuation, in dB/km
+ |
+ *===========================================================================*/
+double ApproximateSpecificAttenuation(double f__ghz, double T__kelvin, double e__hPa, double p__hPa)
+{
+    if (p__hPa < APPROXIMATE__P_MIN__HPA || p__hPa > APPROXIMATE__P_MAX__HPA ||
+        T__kelvin < APPROXIMATE__T_MIN__KELVIN || T__kelvin > APPROXIMATE__T_MAX__KELVIN ||
+        e__hPa > APPROXIMATE__E_RATIO_MAX * p__hPa)
+        return SpecificAttenuation(f__ghz, T__kelvin, e__hPa, p__hPa);
+
+    shared_ptr<const AttenuationFit> fit = GetAttenuationFit(f__ghz);
+
+    double theta = 300 / T__kelvin;
+
+    double x = p__hPa / 1013;
+    double y = e__hPa / 1013;
+    double u = log(theta);
+
+    double x_n[5] = { 1, x, x * x, x * x * x, x * x * x * x };
+    double y_n[3] = { 1, y, y * y };
+
+    // far wings, each pressure term by Horner's method in ln(theta)
+    double N_far = 0;
+    for (int j = 0; j < APPROXIMATE__TERMS; j++)
+    {
+        double c = fit->c[j][APPROXIMATE__ORDER - 1];
+        for (int k = APPROXIMATE__ORDER - 2; k >= 0; k--)
+            c = c * u + fit->c[j][k];
+
+        N_far += c * x_n[P_POWER[j]] * y_n[E_POWER[j]];
+    }
+
+    // below about 2 GHz, no lines are near
+    double N_near = 0;
+    if (!fit->oxygen.f_0.empty())
+        N_near += OxygenLineSum(fit->oxygen, f__ghz, theta, e__hPa, p__hPa);
+    if (!fit->water_vapour.f_0.empty())
+        N_near += WaterVapourLineSum(fit->water_vapour, f__ghz, theta, e__hPa, p__hPa);
+
+    double N_D = NonresonantDebyeAttenuation(f__ghz, e__hPa, p__hPa, theta);
+
+    double gamma = 0.1820 * f__ghz * (N_far + N_near + N_D);   // [Eqn 1]
+
+    return gamma;
+}
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <math.h>
 #include "../../include/p676.h"
 #include "../../include/p835.h"
 
@@ -0,0 +1,202 @@
+#include <math.h>
+#include <map>
+#include <deque>
+#include <tuple>
+#include <mutex>
+#include <atomic>
+#include <shared_mutex>
+#include "../../include/p676.h"
+
+// Horizontal rays from the surface are traced for every call until tables are enabled
+static atomic<bool> use_horizon_ray_tables(false);
+
+// Horizon ray tables are keyed by everything that determines their layer profile
+using HorizonRayKey = tuple<double, Temperature, DryPressure, WetPressure, GaseousAttenuation, double>;
+
+static map<HorizonRayKey, shared_ptr<const HorizonRayTable>> horizon_ray_cache;
+static deque<HorizonRayKey> horizon_ray_cache_order;    // insertion order, for eviction
+static shared_timed_mutex horizon_ray_cache_mutex;
+
+void SetHorizonRayTables(bool use_tables)
+{
+    use_horizon_ray_tables = use_tables;
+}
+
+bool GetHorizonRayTables()
+{
+    return use_horizon_ray_tables;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Traces a horizontal ray from the bottom of a layer
+ |                profile, recording the cumulative results at each layer
+ |                interface up to a height.  The ray from the bottom of the
+ |                profile to any lower height is then a prefix of this ray.
+ |
+ |        Input:  profile       - Layer profile, from the height at which
+ |                                the ray is horizontal
+ |                h_max__km     - Height up to which the ray is traced, in
+ |                                km
+ |
+ |      Outputs:  table         - Horizon ray table structure
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void TraceHorizonRay(shared_ptr<const LayerProfile> profile, double h_max__km, HorizonRayTable* table)
+{
+    table->profile = profile;
+
+    // interfaces up to the first at or above h_max
+    int N = profile->h__km.size();
+    while (N > 2 && profile->h__km[N - 2] >= h_max__km)
+        N--;
+
+    table->A_gas__db.assign(N, 0);
+    table->bending__rad.assign(N, 0);
+    table->a__km.assign(N, 0);
+    table->delta_L__km.assign(N, 0);
+
+    // n_1 * r_1 * sin(beta_1), for a horizontal launch
+    double c = profile->n[0] * (a_0__km + profile->h__km[0]);
+
+    for (int j = 0; j < N - 1; j++)
+    {
+        double r_i__km = a_0__km + profile->h__km[j];
+        double r_ii__km = a_0__km + profile->h__km[j + 1];
+        double delta_i__km = profile->delta__km[j];
+
+        // Equations 19b and 18a
+        double beta_i__rad = asin(MIN(1, c / (profile->n[j] * r_i__km)));
+        double alpha_i__rad = asin(MIN(1, c / (profile->n[j] * r_ii__km)));
+
+        // path length through the layer, Equation 17
+        double a_i__km = -r_i__km * cos(beta_i__rad) + sqrt(pow(r_i__km, 2) * pow(cos(beta_i__rad), 2) + 2 * r_i__km * delta_i__km + pow(delta_i__km, 2));
+
+        double beta_ii__rad = asin(profile->n[j] / profile->n[j + 1] * sin(alpha_i__rad));
+
+        table->a__km[j + 1] = table->a__km[j] + a_i__km;
+        table->A_gas__db[j + 1] = table->A_gas__db[j] + a_i__km * profile->gamma[j];
+        table->delta_L__km[j + 1] = table->delta_L__km[j] + a_i__km * (profile->n[j] - 1);     // Equation 23
+        table->bending__rad[j + 1] = table->bending__rad[j] + beta_ii__rad - alpha_i__rad;   // Equation 22a
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Traces a horizontal ray from the surface to
+ |                HORIZON_RAY__H_MAX__KM, recording the cumulative results
+ |                at each layer interface.  The ray from the surface to any
+ |                lower height is then a prefix of this ray.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |                config        - Structure containing atmospheric params
+ |
+ |      Outputs:  table         - Horizon ray table structure
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void ComputeHorizonRayTable(double f__ghz, RayTraceConfig config, HorizonRayTable* table)
+{
+    TraceHorizonRay(GetLayerProfile(f__ghz, 0, HORIZON_RAY__H_MAX__KM, config), HORIZON_RAY__H_MAX__KM, table);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Returns the horizon ray table of a frequency and
+ |                atmosphere, from a cache shared across calls and threads.
+ |                The oldest table is evicted once the cache holds
+ |                HORIZON_RAY__CAPACITY tables.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |                config        - Structure containing atmospheric params
+ |
+ |      Returns:  table         - Horizon ray table
+ |
+ *===========================================================================*/
+shared_ptr<const HorizonRayTable> GetHorizonRayTable(double f__ghz, RayTraceConfig config)
+{
+    HorizonRayKey key(f__ghz, config.temperature, config.dry_pressure, config.wet_pressure,
+        config.specific_attenuation, GetLineWindowTolerance());
+
+    {
+        shared_lock<shared_timed_mutex> lock(horizon_ray_cache_mutex);
+
+        auto it = horizon_ray_cache.find(key);
+        if (it != horizon_ray_cache.end())
+            return it->second;
+    }
+
+    // compute outside of the lock, so other traces are not blocked
+    shared_ptr<HorizonRayTable> table = make_shared<HorizonRayTable>();
+    ComputeHorizonRayTable(f__ghz, config, table.get());
+
+    unique_lock<shared_timed_mutex> lock(horizon_ray_cache_mutex);
+
+    // another thread may have added the same table in the meantime
+    auto it = horizon_ray_cache.find(key);
+    if (it != horizon_ray_cache.end())
+        return it->second;
+
+    while (horizon_ray_cache.size() >= HORIZON_RAY__CAPACITY)
+    {
+        horizon_ray_cache.erase(horizon_ray_cache_order.front());
+        horizon_ray_cache_order.pop_front();
+    }
+
+    horizon_ray_cache[key] = table;
+    horizon_ray_cache_order.push_back(key);
+
+    return table;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Results of a horizontal ray from the bottom of its table
+ |                to a height, read from a horizon ray table.  The layer
+ |                containing the height is found directly from Equation 16,
+ |                and the ray is traced exactly from the bottom of that
+ |                layer to the height.
+ |
+ |        Input:  table         - Horizon ray table
+ |                h__km         - Height, in km.  No more than the height
+ |                                the table was traced to
+ |
+ |       Output:  result        - Ray trace result structure
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void HorizonRay(const HorizonRayTable& table, double h__km, SlantPathAttenuationResult* result)
+{
+    const LayerProfile& profile = *table.profile;
+
+    int N = table.a__km.size();
+    double m = profile.delta__km[0];
+
+    // layer containing the height, from inverting the layer heights of Equation 16
+    int k = floor(100 * log((h__km - profile.h__km[0]) * (exp(1. / 100.) - 1) / m + 1));
+    k = MAX(0, MIN(k, N - 2));
+    while (k > 0 && h__km < profile.h__km[k])
+        k--;
+    while (k < N - 2 && h__km >= profile.h__km[k + 1])
+        k++;
+
+    double c = profile.n[0] * (a_0__km + profile.h__km[0]);
+    double r_k__km = a_0__km + profile.h__km[k];
+    double delta__km = h__km - profile.h__km[k];
+
+    // partial layer, Equation 17
+    double beta_k__rad = asin(MIN(1, c / (profile.n[k] * r_k__km)));
+    double a_k__km = -r_k__km * cos(beta_k__rad) + sqrt(pow(r_k__km, 2) * pow(cos(beta_k__rad), 2) + 2 * r_k__km * delta__km + pow(delta__km, 2));
+
+    result->A_gas__db = table.A_gas__db[k] + a_k__km * profile.gamma[k];
+    result->bending__rad = table.bending__rad[k];
+    result->a__km = table.a__km[k] + a_k__km;
+    result->delta_L__km = table.delta_L__km[k] + a_k__km * (profile.n[k] - 1);
+
+    // incident angle at the height, Equation 18a
+    result->angle__rad = asin(MIN(1, c / (profile.n[k] * (a_0__km + h__km))));
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <math.h>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <atomic>
+#include <shared_mutex>
+#include "../../include/p676.h"
+
+// Layer profiles are keyed by everything that determines them, including the attenuation engine and
+// line window tolerance
+using LayerProfileKey = tuple<double, double, double, Temperature, DryPressure, WetPressure, GaseousAttenuation,
+    double>;
+
+// A cached layer profile, stamped with its last use so that the least recently used is evicted.  The stamp is
+// atomic, so that hits only take the shared lock
+struct LayerCacheEntry
+{
+    shared_ptr<const LayerProfile> profile;
+    atomic<unsigned long long> last_use{ 0 };
+};
+
+static map<LayerProfileKey, LayerCacheEntry> layer_cache;
+static atomic<unsigned long long> layer_cache_clock(0);
+static shared_timed_mutex layer_cache_mutex;
+
+/*=============================================================================
+ |
+ |  Description:  Computes the layers of a ray trace from terminal h_1 to
+ |                terminal h_2, along with the atmospheric properties in the
+ |                middle of each layer.  The layers do not depend on the
+ |                elevation angle of the ray.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |                h_1__km       - Height of the low terminal, in km
+ |                h_2__km       - Height of the high terminal, in km
+ |                config        - Structure containing atmospheric params
+ |
+ |       Output:  profile       - Layer profile structure
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void ComputeLayerProfile(double f__ghz, double h_1__km, double h_2__km, RayTraceConfig config,
+    LayerProfile* profile)
+{
+    // Equations 16(a)-(c)
+    int i_lower = floor(100 * log(1e4 * h_1__km * (exp(1. / 100.) - 1) + 1) + 1);
+    int i_upper = ceil(100 * log(1e4 * h_2__km * (exp(1. / 100.) - 1) + 1) + 1);
+    double m = ((exp(2. / 100.) - exp(1. / 100.)) / (exp(i_upper / 100.) - exp(i_lower / 100.))) * (h_2__km - h_1__km);
+
+    profile->i_lower = i_lower;
+    profile->i_upper = i_upper;
+
+    // the lowest layer is always needed to start the trace
+    int N = MAX(i_upper - i_lower + 1, 1);
+    profile->h__km.resize(N);
+    profile->delta__km.resize(N);
+    profile->T__kelvin.resize(N);
+    profile->p__hPa.resize(N);
+    profile->e__hPa.resize(N);
+    profile->n.resize(N);
+    profile->gamma.resize(N);
+
+    for (int j = 0; j < N; j++)
+    {
+        int i = i_lower + j;
+
+        profile->delta__km[j] = LayerThickness(m, i);
+        profile->h__km[j] = h_1__km + m * ((exp((i - 1) / 100.) - exp((i_lower - 1) / 100.)) / (exp(1 / 100.) - 1));
+
+        double h_mid__km = profile->h__km[j] + profile->delta__km[j] / 2;
+
+        // use function pointers to get atmospheric parameters
+        profile->T__kelvin[j] = config.temperature(h_mid__km);
+        profile->p__hPa[j] = config.dry_pressure(h_mid__km);
+        profile->e__hPa[j] = config.wet_pressure(h_mid__km);
+
+        profile->n[j] = RefractiveIndex(profile->p__hPa[j], profile->T__kelvin[j], profile->e__hPa[j]);
+        profile->gamma[j] = config.specific_attenuation(f__ghz, profile->T__kelvin[j], profile->e__hPa[j], profile->p__hPa[j]);
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Returns the layer profile of a ray trace, from a cache
+ |                shared across calls and threads.  Repeated traces at the
+ |                same frequency and terminal heights, such as every line-
+ |                of-sight distance of a terminal pair, skip the line-by-
+ |                line spectroscopy.  The least recently used profile is
+ |                evicted once the cache holds LAYER_CACHE__CAPACITY
+ |                profiles, so the profiles of a terminal pair survive the
+ |                traces to a different common volume height at every
+ |                transhorizon distance.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |                h_1__km       - Height of the low terminal, in km
+ |                h_2__km       - Height of the high terminal, in km
+ |                config        - Structure containing atmospheric params
+ |
+ |      Returns:  profile       - Layer profile
+ |
+ *===========================================================================*/
+shared_ptr<const LayerProfile> GetLayerProfile(double f__ghz, double h_1__km, double h_2__km,
+    RayTraceConfig config)
+{
+    LayerProfileKey key(f__ghz, h_1__km, h_2__km, config.temperature, config.dry_pressure, config.wet_pressure,
+        config.specific_attenuation, GetLineWindowTolerance());
+
+    {
+        shared_lock<shared_timed_mutex> lock(layer_cache_mutex);
+
+        auto it = layer_cache.find(key);
+        if (it != layer_cache.end())
+        {
+            it->second.last_use.store(layer_cache_clock.fetch_add(1, memory_order_relaxed), memory_order_relaxed);
+            return it->second.profile;
+        }
+    }
+
+    // compute outside of the lock, so other traces are not blocked
+    shared_ptr<LayerProfile> profile = make_shared<LayerProfile>();
+    ComputeLayerProfile(f__ghz, h_1__km, h_2__km, config, profile.get());
+
+    unique_lock<shared_timed_mutex> lock(layer_cache_mutex);
+
+    // another thread may have added the same profile in the meantime
+    auto it = layer_cache.find(key);
+    if (it != layer_cache.end())
+        return it->second.profile;
+
+    while (layer_cache.size() >= LAYER_CACHE__CAPACITY)
+    {
+        auto lru = layer_cache.begin();
+        for (auto entry = layer_cache.begin(); entry != layer_cache.end(); entry++)
+            if (entry->second.last_use.load(memory_order_relaxed) < lru->second.last_use.load(memory_order_relaxed))
+                lru = entry;
+
+        layer_cache.erase(lru);
+    }
+
+    LayerCacheEntry& entry = layer_cache[key];
+    entry.profile = profile;
+    entry.last_use.store(layer_cache_clock.fetch_add(1, memory_order_relaxed), memory_order_relaxed);
+
+    return profile;
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include "../../include/p676.h"
+
+#if defined(LINE_KERNEL__X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*=============================================================================
+ |
+ |  Description:  Detects the widest spectral line kernel supported by the
+ |                processor and operating system.
+ |
+ |      Returns:  kernel        - Code indicating the line kernel
+ |                                  + 0 : LINE_KERNEL__SCALAR
+ |                                  + 1 : LINE_KERNEL__AVX2
+ |                                  + 2 : LINE_KERNEL__AVX512
+ |
+ *===========================================================================*/
+static int DetectLineKernel()
+{
+#if defined(LINE_KERNEL__X86) && defined(_MSC_VER)
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return LINE_KERNEL__SCALAR;
+
+    // AVX and FMA, and the OS saving the AVX registers
+    __cpuid(info, 1);
+    bool has_fma = (info[2] >> 12) & 1;
+    bool has_osxsave = (info[2] >> 27) & 1;
+    bool has_avx = (info[2] >> 28) & 1;
+    if (!has_fma || !has_osxsave || !has_avx)
+        return LINE_KERNEL__SCALAR;
+
+    unsigned long long xcr0 = _xgetbv(0);
+    if ((xcr0 & 0x06) != 0x06)
+        return LINE_KERNEL__SCALAR;
+
+    __cpuidex(info, 7, 0);
+    bool has_avx2 = (info[1] >> 5) & 1;
+    bool has_avx512f = (info[1] >> 16) & 1;
+    bool has_avx512dq = (info[1] >> 17) & 1;
+
+    // the OS must also save the opmask and upper ZMM registers
+    if (has_avx512f && has_avx512dq && (xcr0 & 0xE6) == 0xE6)
+        return LINE_KERNEL__AVX512;
+    if (has_avx2)
+        return LINE_KERNEL__AVX2;
+
+    return LINE_KERNEL__SCALAR;
+#elif defined(LINE_KERNEL__X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+        return LINE_KERNEL__AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return LINE_KERNEL__AVX2;
+
+    return LINE_KERNEL__SCALAR;
+#else
+    return LINE_KERNEL__SCALAR;
+#endif
+}
+
+/*=============================================================================
+ |
+ |  Description:  Returns the spectral line kernel used by the refractivity
+ |                calculations, detected once per process.
+ |
+ |      Returns:  kernel        - Code indicating the line kernel
+ |
+ *===========================================================================*/
+int GetLineKernel()
+{
+    static const int kernel = DetectLineKernel();
+    return kernel;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the oxygen lines in Equation (2a) over a line
+ |                table, with the widest supported kernel.
+ |
+ |        Input:  lines         - Oxygen line table
+ |                f__ghz        - Frequency, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Returns:  N             - Sum of S_i * F_i
+ |
+ *===========================================================================*/
+double OxygenLineSum(const OxygenLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa)
+{
+#if defined(LINE_KERNEL__X86)
+    if (GetLineKernel() == LINE_KERNEL__AVX512)
+        return OxygenLineSum_AVX512(lines, f__ghz, theta, e__hPa, p__hPa);
+    if (GetLineKernel() == LINE_KERNEL__AVX2)
+        return OxygenLineSum_AVX2(lines, f__ghz, theta, e__hPa, p__hPa);
+#endif
+
+    double N = 0;
+    for (int i = 0; i < (int)lines.f_0.size(); i++)
+        N += OxygenLineTerm(lines, i, f__ghz, theta, e__hPa, p__hPa);
+
+    return N;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the water vapour lines in Equation (2b) over
+ |                a line table, with the widest supported kernel.
+ |
+ |        Input:  lines         - Water vapour line table
+ |                f__ghz        - Frequency, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Returns:  N_w           - Sum of S_i * F_i
+ |
+ *===========================================================================*/
+double WaterVapourLineSum(const WaterVapourLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa)
+{
+#if defined(LINE_KERNEL__X86)
+    if (GetLineKernel() == LINE_KERNEL__AVX512)
+        return WaterVapourLineSum_AVX512(lines, f__ghz, theta, e__hPa, p__hPa);
+    if (GetLineKernel() == LINE_KERNEL__AVX2)
+        return WaterVapourLineSum_AVX2(lines, f__ghz, theta, e__hPa, p__hPa);
+#endif
+
+    double N_w = 0;
+    for (int i = 0; i < (int)lines.f_0.size(); i++)
+        N_w += WaterVapourLineTerm(lines, i, f__ghz, theta, e__hPa, p__hPa);
+
+    return N_w;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the oxygen lines in Equation (2a) over a line
+ |                table at several frequencies, with the widest supported
+ |                kernel.  Each sum is identical to OxygenLineSum() at its
+ |                frequency.
+ |
+ |        Input:  lines         - Oxygen line table
+ |                N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Outputs:  sums          - Sum of S_i * F_i at each frequency
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void OxygenLineSweep(const OxygenLineTable& lines, int N, const double* f__ghz, double theta, double e__hPa,
+    double p__hPa, double* sums)
+{
+#if defined(LINE_KERNEL__X86)
+    if (GetLineKernel() == LINE_KERNEL__AVX512)
+        return OxygenLineSweep_AVX512(lines, N, f__ghz, theta, e__hPa, p__hPa, sums);
+    if (GetLineKernel() == LINE_KERNEL__AVX2)
+        return OxygenLineSweep_AVX2(lines, N, f__ghz, theta, e__hPa, p__hPa, sums);
+#endif
+
+    for (int k = 0; k < N; k++)
+        sums[k] = OxygenLineSum(lines, f__ghz[k], theta, e__hPa, p__hPa);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the water vapour lines in Equation (2b) over
+ |                a line table at several frequencies, with the widest
+ |                supported kernel.  Each sum is identical to
+ |                WaterVapourLineSum() at its frequency.
+ |
+ |        Input:  lines         - Water vapour line table
+ |                N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Outputs:  sums          - Sum of S_i * F_i at each frequency
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void WaterVapourLineSweep(const WaterVapourLineTable& lines, int N, const double* f__ghz, double theta,
+    double e__hPa, double p__hPa, double* sums)
+{
+#if defined(LINE_KERNEL__X86)
+    if (GetLineKernel() == LINE_KERNEL__AVX512)
+        return WaterVapourLineSweep_AVX512(lines, N, f__ghz, theta, e__hPa, p__hPa, sums);
+    if (GetLineKernel() == LINE_KERNEL__AVX2)
+        return WaterVapourLineSweep_AVX2(lines, N, f__ghz, theta, e__hPa, p__hPa, sums);
+#endif
+
+    for (int k = 0; k < N; k++)
+        sums[k] = WaterVapourLineSum(lines, f__ghz[k], theta, e__hPa, p__hPa);
+}
\ No newline at end of file
@@ -0,0 +1,417 @@
+#include <math.h>
+#include "../../include/p676.h"
+
+#if defined(LINE_KERNEL__X86)
+
+#include <immintrin.h>
+
+/*=============================================================================
+ |
+ |  Description:  Vector exponential.  The argument is reduced by multiples
+ |                of ln(2) and the remainder is evaluated with a degree 13
+ |                Taylor polynomial, to within a few ULP of exp().
+ |
+ |        Input:  x             - Argument
+ |
+ |      Returns:  e^x
+ |
+ *===========================================================================*/
+TARGET_AVX2 static inline __m256d Exp_AVX2(__m256d x)
+{
+    x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(-708)), _mm256_set1_pd(709));
+
+    // x = n * ln(2) + r, with ln(2) split in two parts so the reduction is exact
+    __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634074)),
+        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(n, _mm256_set1_pd(6.93145751953125e-1), x);
+    r = _mm256_fnmadd_pd(n, _mm256_set1_pd(1.42860682030941723212e-6), r);
+
+    __m256d p = _mm256_set1_pd(1.0 / 6227020800.0);
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 479001600.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 39916800.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 3628800.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 362880.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 40320.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 5040.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 720.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 120.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 24.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0 / 6.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(0.5));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+    p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(1.0));
+
+    // scale by 2^n, built directly in the exponent bits
+    __m256i k = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));
+    k = _mm256_slli_epi64(_mm256_add_epi64(k, _mm256_set1_epi64x(1023)), 52);
+
+    return _mm256_mul_pd(p, _mm256_castsi256_pd(k));
+}
+
+/*=============================================================================
+ |
+ |  Description:  Line-shape factor of Equation (5), for a vector of lines.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |                f_i__ghz      - Line center frequency, in GHz
+ |                inv_f_i       - 1 / f_i__ghz
+ |                delta_f__ghz  - From Equation 6
+ |                delta         - From Equation 7
+ |
+ |      Returns:  F_i           - Line-shape factor
+ |
+ *===========================================================================*/
+TARGET_AVX2 static inline __m256d LineShapeFactor_AVX2(__m256d f__ghz, __m256d f_i__ghz, __m256d inv_f_i,
+    __m256d delta_f__ghz, __m256d delta)
+{
+    __m256d f_minus = _mm256_sub_pd(f_i__ghz, f__ghz);
+    __m256d f_plus = _mm256_add_pd(f_i__ghz, f__ghz);
+    __m256d delta_f_2 = _mm256_mul_pd(delta_f__ghz, delta_f__ghz);
+
+    __m256d term2 = _mm256_div_pd(_mm256_fnmadd_pd(delta, f_minus, delta_f__ghz), _mm256_fmadd_pd(f_minus, f_minus, delta_f_2));
+    __m256d term3 = _mm256_div_pd(_mm256_fnmadd_pd(delta, f_plus, delta_f__ghz), _mm256_fmadd_pd(f_plus, f_plus, delta_f_2));
+
+    return _mm256_mul_pd(_mm256_mul_pd(f__ghz, inv_f_i), _mm256_add_pd(term2, term3));
+}
+
+TARGET_AVX2 static inline double HorizontalSum_AVX2(__m256d x)
+{
+    __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+// Terms of Equations 3, 6 and 7 shared by every oxygen line of an atmospheric state
+struct OxygenState_AVX2
+{
+    __m256d p;
+    __m256d t;
+    __m256d log_t;
+    __m256d one_minus_t;
+    __m256d S_0;
+    __m256d W_e;
+    __m256d delta_0;
+};
+
+// Terms of Equations 3 and 6 shared by every water vapour line of an atmospheric state
+struct WaterVapourState_AVX2
+{
+    __m256d p;
+    __m256d e;
+    __m256d log_t;
+    __m256d one_minus_t;
+    __m256d inv_t;
+    __m256d S_0;
+};
+
+TARGET_AVX2 static inline OxygenState_AVX2 GetOxygenState_AVX2(double theta, double e__hPa, double p__hPa)
+{
+    OxygenState_AVX2 state;
+    state.p = _mm256_set1_pd(p__hPa);
+    state.t = _mm256_set1_pd(theta);
+    state.log_t = _mm256_set1_pd(log(theta));
+    state.one_minus_t = _mm256_set1_pd(1 - theta);
+    state.S_0 = _mm256_set1_pd(p__hPa * pow(theta, 3));
+    state.W_e = _mm256_set1_pd(1.1 * e__hPa * theta);
+    state.delta_0 = _mm256_set1_pd(1e-4 * (p__hPa + e__hPa) * pow(theta, 0.8));
+
+    return state;
+}
+
+TARGET_AVX2 static inline WaterVapourState_AVX2 GetWaterVapourState_AVX2(double theta, double e__hPa, double p__hPa)
+{
+    WaterVapourState_AVX2 state;
+    state.p = _mm256_set1_pd(p__hPa);
+    state.e = _mm256_set1_pd(e__hPa);
+    state.log_t = _mm256_set1_pd(log(theta));
+    state.one_minus_t = _mm256_set1_pd(1 - theta);
+    state.inv_t = _mm256_set1_pd(1 / theta);
+    state.S_0 = _mm256_set1_pd(e__hPa * pow(theta, 3.5));
+
+    return state;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Strength, width and interference correction of four
+ |                oxygen lines, which do not depend on the frequency.
+ |
+ |        Input:  lines         - Line table
+ |                i             - First of the four lines
+ |                state         - Terms shared by every line
+ |
+ |      Outputs:  S_i           - Line strength, from Equation 3
+ |                delta_f       - Line width, from Equation 6
+ |                delta         - Correction factor, from Equation 7
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX2 static inline void OxygenLines_AVX2(const OxygenLineTable& lines, size_t i, const OxygenState_AVX2& state,
+    __m256d* S_i, __m256d* delta_f, __m256d* delta)
+{
+    // Equation 3
+    *S_i = _mm256_mul_pd(_mm256_mul_pd(_mm256_loadu_pd(&lines.S[i]), state.S_0),
+        Exp_AVX2(_mm256_mul_pd(_mm256_loadu_pd(&lines.x_S[i]), state.one_minus_t)));
+
+    // Equation 6a, then 6b for Zeeman splitting
+    __m256d width = _mm256_mul_pd(_mm256_loadu_pd(&lines.W[i]),
+        _mm256_fmadd_pd(state.p, Exp_AVX2(_mm256_mul_pd(_mm256_loadu_pd(&lines.x_W[i]), state.log_t)), state.W_e));
+    *delta_f = _mm256_sqrt_pd(_mm256_fmadd_pd(width, width, _mm256_set1_pd(2.25e-6)));
+
+    // Equation 7
+    *delta = _mm256_mul_pd(_mm256_fmadd_pd(_mm256_loadu_pd(&lines.d_1[i]), state.t, _mm256_loadu_pd(&lines.d_0[i])),
+        state.delta_0);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Strength and width of four water vapour lines, which do
+ |                not depend on the frequency.
+ |
+ |        Input:  lines         - Line table
+ |                i             - First of the four lines
+ |                state         - Terms shared by every line
+ |
+ |      Outputs:  S_i           - Line strength, from Equation 3
+ |                delta_f       - Line width, from Equation 6
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX2 static inline void WaterVapourLines_AVX2(const WaterVapourLineTable& lines, size_t i,
+    const WaterVapourState_AVX2& state, __m256d* S_i, __m256d* delta_f)
+{
+    // Equation 3
+    *S_i = _mm256_mul_pd(_mm256_mul_pd(_mm256_loadu_pd(&lines.S[i]), state.S_0),
+        Exp_AVX2(_mm256_mul_pd(_mm256_loadu_pd(&lines.x_S[i]), state.one_minus_t)));
+
+    // Equation 6a, fused explicitly so the rounding is the same wherever this is inlined
+    __m256d width_e = _mm256_mul_pd(_mm256_mul_pd(_mm256_loadu_pd(&lines.W_e[i]), state.e),
+        Exp_AVX2(_mm256_mul_pd(_mm256_loadu_pd(&lines.x_e[i]), state.log_t)));
+    __m256d width = _mm256_mul_pd(_mm256_loadu_pd(&lines.W[i]),
+        _mm256_fmadd_pd(state.p, Exp_AVX2(_mm256_mul_pd(_mm256_loadu_pd(&lines.x_p[i]), state.log_t)), width_e));
+
+    // Equation 6b, for Doppler broadening
+    __m256d term1 = _mm256_fmadd_pd(_mm256_mul_pd(_mm256_set1_pd(0.217), width), width,
+        _mm256_mul_pd(_mm256_loadu_pd(&lines.D[i]), state.inv_t));
+    *delta_f = _mm256_fmadd_pd(_mm256_set1_pd(0.535), width, _mm256_sqrt_pd(term1));
+}
+
+// One line term S_i * F_i at every frequency lane, added to a partial sum
+TARGET_AVX2 static inline __m256d LineTerm_AVX2(__m256d f, const double* f_0, const double* inv_f_0, const double* S,
+    const double* delta_f, const double* delta, size_t i, __m256d sum)
+{
+    __m256d delta_i = (delta != nullptr) ? _mm256_set1_pd(delta[i]) : _mm256_setzero_pd();
+
+    __m256d F_i = LineShapeFactor_AVX2(f, _mm256_set1_pd(f_0[i]), _mm256_set1_pd(inv_f_0[i]), _mm256_set1_pd(delta_f[i]),
+        delta_i);
+
+    return _mm256_fmadd_pd(_mm256_set1_pd(S[i]), F_i, sum);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the line terms S_i * F_i at four frequencies
+ |                at a time, one per vector lane, for line strengths and
+ |                widths computed once.  Each frequency keeps a partial sum
+ |                for every fourth line, which are added in the order of
+ |                HorizontalSum_AVX2(), so each sum is identical to the sum
+ |                over vectors of four lines at one frequency.
+ |
+ |        Input:  L             - Number of lines, a multiple of 4
+ |                f_0           - Line center frequencies, in GHz
+ |                inv_f_0       - 1 / f_0
+ |                S             - Line strengths
+ |                delta_f       - Line widths, in GHz
+ |                delta         - Correction factors, or null for none
+ |                N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |
+ |      Outputs:  sums          - Sum of S_i * F_i at each frequency
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX2 static void LineSweep_AVX2(size_t L, const double* f_0, const double* inv_f_0, const double* S,
+    const double* delta_f, const double* delta, int N, const double* f__ghz, double* sums)
+{
+    for (int k = 0; k < N; k += 4)
+    {
+        // unused lanes repeat the last frequency
+        double f_lanes[4];
+        for (int l = 0; l < 4; l++)
+            f_lanes[l] = f__ghz[MIN(k + l, N - 1)];
+        __m256d f = _mm256_loadu_pd(f_lanes);
+
+        __m256d N_0 = _mm256_setzero_pd();
+        __m256d N_1 = _mm256_setzero_pd();
+        __m256d N_2 = _mm256_setzero_pd();
+        __m256d N_3 = _mm256_setzero_pd();
+        for (size_t i = 0; i < L; i += 4)
+        {
+            N_0 = LineTerm_AVX2(f, f_0, inv_f_0, S, delta_f, delta, i, N_0);
+            N_1 = LineTerm_AVX2(f, f_0, inv_f_0, S, delta_f, delta, i + 1, N_1);
+            N_2 = LineTerm_AVX2(f, f_0, inv_f_0, S, delta_f, delta, i + 2, N_2);
+            N_3 = LineTerm_AVX2(f, f_0, inv_f_0, S, delta_f, delta, i + 3, N_3);
+        }
+
+        __m256d sum = _mm256_add_pd(_mm256_add_pd(N_0, N_2), _mm256_add_pd(N_1, N_3));
+
+        double sum_lanes[4];
+        _mm256_storeu_pd(sum_lanes, sum);
+        for (int l = 0; l < 4 && k + l < N; l++)
+            sums[k + l] = sum_lanes[l];
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the oxygen lines in Equation (2a), four lines
+ |                at a time.
+ |
+ |        Input:  lines         - Line table
+ |                f__ghz        - Frequency, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Returns:  N             - Sum of S_i * F_i
+ |
+ *===========================================================================*/
+TARGET_AVX2 double OxygenLineSum_AVX2(const OxygenLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa)
+{
+    // terms shared by every line
+    __m256d f = _mm256_set1_pd(f__ghz);
+    OxygenState_AVX2 state = GetOxygenState_AVX2(theta, e__hPa, p__hPa);
+
+    __m256d N = _mm256_setzero_pd();
+    for (size_t i = 0; i < lines.f_0.size(); i += 4)
+    {
+        __m256d S_i, delta_f, delta;
+        OxygenLines_AVX2(lines, i, state, &S_i, &delta_f, &delta);
+
+        __m256d F_i = LineShapeFactor_AVX2(f, _mm256_loadu_pd(&lines.f_0[i]), _mm256_loadu_pd(&lines.inv_f_0[i]),
+            delta_f, delta);
+
+        N = _mm256_fmadd_pd(S_i, F_i, N);
+    }
+
+    return HorizontalSum_AVX2(N);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the water vapour lines in Equation (2b), four
+ |                lines at a time.
+ |
+ |        Input:  lines         - Line table
+ |                f__ghz        - Frequency, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Returns:  N_w           - Sum of S_i * F_i
+ |
+ *===========================================================================*/
+TARGET_AVX2 double WaterVapourLineSum_AVX2(const WaterVapourLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa)
+{
+    // terms shared by every line
+    __m256d f = _mm256_set1_pd(f__ghz);
+    WaterVapourState_AVX2 state = GetWaterVapourState_AVX2(theta, e__hPa, p__hPa);
+    __m256d zero = _mm256_setzero_pd();
+
+    __m256d N_w = _mm256_setzero_pd();
+    for (size_t i = 0; i < lines.f_0.size(); i += 4)
+    {
+        __m256d S_i, delta_f;
+        WaterVapourLines_AVX2(lines, i, state, &S_i, &delta_f);
+
+        __m256d F_i = LineShapeFactor_AVX2(f, _mm256_loadu_pd(&lines.f_0[i]), _mm256_loadu_pd(&lines.inv_f_0[i]),
+            delta_f, zero);
+
+        N_w = _mm256_fmadd_pd(S_i, F_i, N_w);
+    }
+
+    return HorizontalSum_AVX2(N_w);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the oxygen lines in Equation (2a) at several
+ |                frequencies.  The line strengths and widths are computed
+ |                once, four lines at a time, and the line shapes four
+ |                frequencies at a time.  Each sum is identical to
+ |                OxygenLineSum_AVX2() at its frequency.
+ |
+ |        Input:  lines         - Line table
+ |                N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Outputs:  sums          - Sum of S_i * F_i at each frequency
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX2 void OxygenLineSweep_AVX2(const OxygenLineTable& lines, int N, const double* f__ghz, double theta,
+    double e__hPa, double p__hPa, double* sums)
+{
+    OxygenState_AVX2 state = GetOxygenState_AVX2(theta, e__hPa, p__hPa);
+
+    size_t L = lines.f_0.size();
+    vector<double> S(L), delta_f(L), delta(L);
+    for (size_t i = 0; i < L; i += 4)
+    {
+        __m256d S_i, delta_f_i, delta_i;
+        OxygenLines_AVX2(lines, i, state, &S_i, &delta_f_i, &delta_i);
+
+        _mm256_storeu_pd(&S[i], S_i);
+        _mm256_storeu_pd(&delta_f[i], delta_f_i);
+        _mm256_storeu_pd(&delta[i], delta_i);
+    }
+
+    LineSweep_AVX2(L, lines.f_0.data(), lines.inv_f_0.data(), S.data(), delta_f.data(), delta.data(), N, f__ghz, sums);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the water vapour lines in Equation (2b) at
+ |                several frequencies.  The line strengths and widths are
+ |                computed once, four lines at a time, and the line shapes
+ |                four frequencies at a time.  Each sum is identical to
+ |                WaterVapourLineSum_AVX2() at its frequency.
+ |
+ |        Input:  lines         - Line table
+ |                N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Outputs:  sums          - Sum of S_i * F_i at each frequency
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX2 void WaterVapourLineSweep_AVX2(const WaterVapourLineTable& lines, int N, const double* f__ghz,
+    double theta, double e__hPa, double p__hPa, double* sums)
+{
+    WaterVapourState_AVX2 state = GetWaterVapourState_AVX2(theta, e__hPa, p__hPa);
+
+    size_t L = lines.f_0.size();
+    vector<double> S(L), delta_f(L);
+    for (size_t i = 0; i < L; i += 4)
+    {
+        __m256d S_i, delta_f_i;
+        WaterVapourLines_AVX2(lines, i, state, &S_i, &delta_f_i);
+
+        _mm256_storeu_pd(&S[i], S_i);
+        _mm256_storeu_pd(&delta_f[i], delta_f_i);
+    }
+
+    LineSweep_AVX2(L, lines.f_0.data(), lines.inv_f_0.data(), S.data(), delta_f.data(), nullptr, N, f__ghz, sums);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,440 @@
+#include <math.h>
+#include "../../include/p676.h"
+
+#if defined(LINE_KERNEL__X86)
+
+#include <immintrin.h>
+
+// The unmasked AVX-512 intrinsics of GCC pass _mm512_undefined_pd() as the unused source of their masked
+// builtins, which GCC 12 reports as uninitialized wherever they are inlined.  Every lane is written, so the
+// source is never read
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+/*=============================================================================
+ |
+ |  Description:  Vector exponential.  The argument is reduced by multiples
+ |                of ln(2) and the remainder is evaluated with a degree 13
+ |                Taylor polynomial, to within a few ULP of exp().
+ |
+ |        Input:  x             - Argument
+ |
+ |      Returns:  e^x
+ |
+ *===========================================================================*/
+TARGET_AVX512 static inline __m512d Exp_AVX512(__m512d x)
+{
+    x = _mm512_min_pd(_mm512_max_pd(x, _mm512_set1_pd(-708)), _mm512_set1_pd(709));
+
+    // x = n * ln(2) + r, with ln(2) split in two parts so the reduction is exact
+    __m512d n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(1.4426950408889634074)),
+        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512d r = _mm512_fnmadd_pd(n, _mm512_set1_pd(6.93145751953125e-1), x);
+    r = _mm512_fnmadd_pd(n, _mm512_set1_pd(1.42860682030941723212e-6), r);
+
+    __m512d p = _mm512_set1_pd(1.0 / 6227020800.0);
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 479001600.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 39916800.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 3628800.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 362880.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 40320.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 5040.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 720.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 120.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 24.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0 / 6.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(0.5));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0));
+    p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(1.0));
+
+    // scale by 2^n
+    return _mm512_scalef_pd(p, n);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Line-shape factor of Equation (5), for a vector of lines.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |                f_i__ghz      - Line center frequency, in GHz
+ |                inv_f_i       - 1 / f_i__ghz
+ |                delta_f__ghz  - From Equation 6
+ |                delta         - From Equation 7
+ |
+ |      Returns:  F_i           - Line-shape factor
+ |
+ *===========================================================================*/
+TARGET_AVX512 static inline __m512d LineShapeFactor_AVX512(__m512d f__ghz, __m512d f_i__ghz, __m512d inv_f_i,
+    __m512d delta_f__ghz, __m512d delta)
+{
+    __m512d f_minus = _mm512_sub_pd(f_i__ghz, f__ghz);
+    __m512d f_plus = _mm512_add_pd(f_i__ghz, f__ghz);
+    __m512d delta_f_2 = _mm512_mul_pd(delta_f__ghz, delta_f__ghz);
+
+    __m512d term2 = _mm512_div_pd(_mm512_fnmadd_pd(delta, f_minus, delta_f__ghz), _mm512_fmadd_pd(f_minus, f_minus, delta_f_2));
+    __m512d term3 = _mm512_div_pd(_mm512_fnmadd_pd(delta, f_plus, delta_f__ghz), _mm512_fmadd_pd(f_plus, f_plus, delta_f_2));
+
+    return _mm512_mul_pd(_mm512_mul_pd(f__ghz, inv_f_i), _mm512_add_pd(term2, term3));
+}
+
+// Adds the lanes pairwise, in the same order as GCC's _mm512_reduce_add_pd()
+TARGET_AVX512 static inline double HorizontalSum_AVX512(__m512d x)
+{
+    __m256d sum_4 = _mm256_add_pd(_mm512_castpd512_pd256(x), _mm512_extractf64x4_pd(x, 1));
+    __m128d sum_2 = _mm_add_pd(_mm256_castpd256_pd128(sum_4), _mm256_extractf128_pd(sum_4, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum_2, _mm_unpackhi_pd(sum_2, sum_2)));
+}
+
+// Terms of Equations 3, 6 and 7 shared by every oxygen line of an atmospheric state
+struct OxygenState_AVX512
+{
+    __m512d p;
+    __m512d t;
+    __m512d log_t;
+    __m512d one_minus_t;
+    __m512d S_0;
+    __m512d W_e;
+    __m512d delta_0;
+};
+
+// Terms of Equations 3 and 6 shared by every water vapour line of an atmospheric state
+struct WaterVapourState_AVX512
+{
+    __m512d p;
+    __m512d e;
+    __m512d log_t;
+    __m512d one_minus_t;
+    __m512d inv_t;
+    __m512d S_0;
+};
+
+TARGET_AVX512 static inline OxygenState_AVX512 GetOxygenState_AVX512(double theta, double e__hPa, double p__hPa)
+{
+    OxygenState_AVX512 state;
+    state.p = _mm512_set1_pd(p__hPa);
+    state.t = _mm512_set1_pd(theta);
+    state.log_t = _mm512_set1_pd(log(theta));
+    state.one_minus_t = _mm512_set1_pd(1 - theta);
+    state.S_0 = _mm512_set1_pd(p__hPa * pow(theta, 3));
+    state.W_e = _mm512_set1_pd(1.1 * e__hPa * theta);
+    state.delta_0 = _mm512_set1_pd(1e-4 * (p__hPa + e__hPa) * pow(theta, 0.8));
+
+    return state;
+}
+
+TARGET_AVX512 static inline WaterVapourState_AVX512 GetWaterVapourState_AVX512(double theta, double e__hPa,
+    double p__hPa)
+{
+    WaterVapourState_AVX512 state;
+    state.p = _mm512_set1_pd(p__hPa);
+    state.e = _mm512_set1_pd(e__hPa);
+    state.log_t = _mm512_set1_pd(log(theta));
+    state.one_minus_t = _mm512_set1_pd(1 - theta);
+    state.inv_t = _mm512_set1_pd(1 / theta);
+    state.S_0 = _mm512_set1_pd(e__hPa * pow(theta, 3.5));
+
+    return state;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Strength, width and interference correction of eight
+ |                oxygen lines, which do not depend on the frequency.
+ |
+ |        Input:  lines         - Line table
+ |                i             - First of the eight lines
+ |                state         - Terms shared by every line
+ |
+ |      Outputs:  S_i           - Line strength, from Equation 3
+ |                delta_f       - Line width, from Equation 6
+ |                delta         - Correction factor, from Equation 7
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX512 static inline void OxygenLines_AVX512(const OxygenLineTable& lines, size_t i,
+    const OxygenState_AVX512& state, __m512d* S_i, __m512d* delta_f, __m512d* delta)
+{
+    // Equation 3
+    *S_i = _mm512_mul_pd(_mm512_mul_pd(_mm512_loadu_pd(&lines.S[i]), state.S_0),
+        Exp_AVX512(_mm512_mul_pd(_mm512_loadu_pd(&lines.x_S[i]), state.one_minus_t)));
+
+    // Equation 6a, then 6b for Zeeman splitting
+    __m512d width = _mm512_mul_pd(_mm512_loadu_pd(&lines.W[i]),
+        _mm512_fmadd_pd(state.p, Exp_AVX512(_mm512_mul_pd(_mm512_loadu_pd(&lines.x_W[i]), state.log_t)), state.W_e));
+    *delta_f = _mm512_sqrt_pd(_mm512_fmadd_pd(width, width, _mm512_set1_pd(2.25e-6)));
+
+    // Equation 7
+    *delta = _mm512_mul_pd(_mm512_fmadd_pd(_mm512_loadu_pd(&lines.d_1[i]), state.t, _mm512_loadu_pd(&lines.d_0[i])),
+        state.delta_0);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Strength and width of eight water vapour lines, which do
+ |                not depend on the frequency.
+ |
+ |        Input:  lines         - Line table
+ |                i             - First of the eight lines
+ |                state         - Terms shared by every line
+ |
+ |      Outputs:  S_i           - Line strength, from Equation 3
+ |                delta_f       - Line width, from Equation 6
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX512 static inline void WaterVapourLines_AVX512(const WaterVapourLineTable& lines, size_t i,
+    const WaterVapourState_AVX512& state, __m512d* S_i, __m512d* delta_f)
+{
+    // Equation 3
+    *S_i = _mm512_mul_pd(_mm512_mul_pd(_mm512_loadu_pd(&lines.S[i]), state.S_0),
+        Exp_AVX512(_mm512_mul_pd(_mm512_loadu_pd(&lines.x_S[i]), state.one_minus_t)));
+
+    // Equation 6a, fused explicitly so the rounding is the same wherever this is inlined
+    __m512d width_e = _mm512_mul_pd(_mm512_mul_pd(_mm512_loadu_pd(&lines.W_e[i]), state.e),
+        Exp_AVX512(_mm512_mul_pd(_mm512_loadu_pd(&lines.x_e[i]), state.log_t)));
+    __m512d width = _mm512_mul_pd(_mm512_loadu_pd(&lines.W[i]),
+        _mm512_fmadd_pd(state.p, Exp_AVX512(_mm512_mul_pd(_mm512_loadu_pd(&lines.x_p[i]), state.log_t)), width_e));
+
+    // Equation 6b, for Doppler broadening
+    __m512d term1 = _mm512_fmadd_pd(_mm512_mul_pd(_mm512_set1_pd(0.217), width), width,
+        _mm512_mul_pd(_mm512_loadu_pd(&lines.D[i]), state.inv_t));
+    *delta_f = _mm512_fmadd_pd(_mm512_set1_pd(0.535), width, _mm512_sqrt_pd(term1));
+}
+
+// One line term S_i * F_i at every frequency lane, added to a partial sum
+TARGET_AVX512 static inline __m512d LineTerm_AVX512(__m512d f, const double* f_0, const double* inv_f_0, const double* S,
+    const double* delta_f, const double* delta, size_t i, __m512d sum)
+{
+    __m512d delta_i = (delta != nullptr) ? _mm512_set1_pd(delta[i]) : _mm512_setzero_pd();
+
+    __m512d F_i = LineShapeFactor_AVX512(f, _mm512_set1_pd(f_0[i]), _mm512_set1_pd(inv_f_0[i]), _mm512_set1_pd(delta_f[i]),
+        delta_i);
+
+    return _mm512_fmadd_pd(_mm512_set1_pd(S[i]), F_i, sum);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the line terms S_i * F_i at eight frequencies
+ |                at a time, one per vector lane, for line strengths and
+ |                widths computed once.  Each frequency keeps a partial sum
+ |                for every eighth line, which are added in the order of
+ |                HorizontalSum_AVX512(), so each sum is identical to the
+ |                sum over vectors of eight lines at one frequency.
+ |
+ |        Input:  L             - Number of lines, a multiple of 8
+ |                f_0           - Line center frequencies, in GHz
+ |                inv_f_0       - 1 / f_0
+ |                S             - Line strengths
+ |                delta_f       - Line widths, in GHz
+ |                delta         - Correction factors, or null for none
+ |                N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |
+ |      Outputs:  sums          - Sum of S_i * F_i at each frequency
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX512 static void LineSweep_AVX512(size_t L, const double* f_0, const double* inv_f_0, const double* S,
+    const double* delta_f, const double* delta, int N, const double* f__ghz, double* sums)
+{
+    for (int k = 0; k < N; k += 8)
+    {
+        // unused lanes repeat the last frequency
+        double f_lanes[8];
+        for (int l = 0; l < 8; l++)
+            f_lanes[l] = f__ghz[MIN(k + l, N - 1)];
+        __m512d f = _mm512_loadu_pd(f_lanes);
+
+        __m512d N_0 = _mm512_setzero_pd();
+        __m512d N_1 = _mm512_setzero_pd();
+        __m512d N_2 = _mm512_setzero_pd();
+        __m512d N_3 = _mm512_setzero_pd();
+        __m512d N_4 = _mm512_setzero_pd();
+        __m512d N_5 = _mm512_setzero_pd();
+        __m512d N_6 = _mm512_setzero_pd();
+        __m512d N_7 = _mm512_setzero_pd();
+        for (size_t i = 0; i < L; i += 8)
+        {
+            N_0 = LineTerm_AVX512(f, f_0, inv_f_0, S, delta_f, delta, i, N_0);
+            N_1 = LineTerm_AVX512(f, f_0, inv_f_0, S, delta_f, delta, i + 1, N_1);
+            N_2 = LineTerm_AVX512(f, f_0, inv_f_0, S, delta_f, delta, i + 2, N_2);
+            N_3 = LineTerm_AVX512(f, f_0, inv_f_0, S, delta_f, delta, i + 3, N_3);
+            N_4 = LineTerm_AVX512(f, f_0, inv_f_0, S, delta_f, delta, i + 4, N_4);
+            N_5 = LineTerm_AVX512(f, f_0, inv_f_0, S, delta_f, delta, i + 5, N_5);
+            N_6 = LineTerm_AVX512(f, f_0, inv_f_0, S, delta_f, delta, i + 6, N_6);
+            N_7 = LineTerm_AVX512(f, f_0, inv_f_0, S, delta_f, delta, i + 7, N_7);
+        }
+
+        __m512d sum = _mm512_add_pd(_mm512_add_pd(_mm512_add_pd(N_0, N_4), _mm512_add_pd(N_2, N_6)),
+            _mm512_add_pd(_mm512_add_pd(N_1, N_5), _mm512_add_pd(N_3, N_7)));
+
+        double sum_lanes[8];
+        _mm512_storeu_pd(sum_lanes, sum);
+        for (int l = 0; l < 8 && k + l < N; l++)
+            sums[k + l] = sum_lanes[l];
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the oxygen lines in Equation (2a), eight lines
+ |                at a time.
+ |
+ |        Input:  lines         - Line table
+ |                f__ghz        - Frequency, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Returns:  N             - Sum of S_i * F_i
+ |
+ *===========================================================================*/
+TARGET_AVX512 double OxygenLineSum_AVX512(const OxygenLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa)
+{
+    // terms shared by every line
+    __m512d f = _mm512_set1_pd(f__ghz);
+    OxygenState_AVX512 state = GetOxygenState_AVX512(theta, e__hPa, p__hPa);
+
+    __m512d N = _mm512_setzero_pd();
+    for (size_t i = 0; i < lines.f_0.size(); i += 8)
+    {
+        __m512d S_i, delta_f, delta;
+        OxygenLines_AVX512(lines, i, state, &S_i, &delta_f, &delta);
+
+        __m512d F_i = LineShapeFactor_AVX512(f, _mm512_loadu_pd(&lines.f_0[i]), _mm512_loadu_pd(&lines.inv_f_0[i]),
+            delta_f, delta);
+
+        N = _mm512_fmadd_pd(S_i, F_i, N);
+    }
+
+    return HorizontalSum_AVX512(N);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the water vapour lines in Equation (2b), eight
+ |                lines at a time.
+ |
+ |        Input:  lines         - Line table
+ |                f__ghz        - Frequency, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Returns:  N_w           - Sum of S_i * F_i
+ |
+ *===========================================================================*/
+TARGET_AVX512 double WaterVapourLineSum_AVX512(const WaterVapourLineTable& lines, double f__ghz, double theta, double e__hPa, double p__hPa)
+{
+    // terms shared by every line
+    __m512d f = _mm512_set1_pd(f__ghz);
+    WaterVapourState_AVX512 state = GetWaterVapourState_AVX512(theta, e__hPa, p__hPa);
+    __m512d zero = _mm512_setzero_pd();
+
+    __m512d N_w = _mm512_setzero_pd();
+    for (size_t i = 0; i < lines.f_0.size(); i += 8)
+    {
+        __m512d S_i, delta_f;
+        WaterVapourLines_AVX512(lines, i, state, &S_i, &delta_f);
+
+        __m512d F_i = LineShapeFactor_AVX512(f, _mm512_loadu_pd(&lines.f_0[i]), _mm512_loadu_pd(&lines.inv_f_0[i]),
+            delta_f, zero);
+
+        N_w = _mm512_fmadd_pd(S_i, F_i, N_w);
+    }
+
+    return HorizontalSum_AVX512(N_w);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the oxygen lines in Equation (2a) at several
+ |                frequencies.  The line strengths and widths are computed
+ |                once, eight lines at a time, and the line shapes eight
+ |                frequencies at a time.  Each sum is identical to
+ |                OxygenLineSum_AVX512() at its frequency.
+ |
+ |        Input:  lines         - Line table
+ |                N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Outputs:  sums          - Sum of S_i * F_i at each frequency
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX512 void OxygenLineSweep_AVX512(const OxygenLineTable& lines, int N, const double* f__ghz, double theta,
+    double e__hPa, double p__hPa, double* sums)
+{
+    OxygenState_AVX512 state = GetOxygenState_AVX512(theta, e__hPa, p__hPa);
+
+    size_t L = lines.f_0.size();
+    vector<double> S(L), delta_f(L), delta(L);
+    for (size_t i = 0; i < L; i += 8)
+    {
+        __m512d S_i, delta_f_i, delta_i;
+        OxygenLines_AVX512(lines, i, state, &S_i, &delta_f_i, &delta_i);
+
+        _mm512_storeu_pd(&S[i], S_i);
+        _mm512_storeu_pd(&delta_f[i], delta_f_i);
+        _mm512_storeu_pd(&delta[i], delta_i);
+    }
+
+    LineSweep_AVX512(L, lines.f_0.data(), lines.inv_f_0.data(), S.data(), delta_f.data(), delta.data(), N, f__ghz,
+        sums);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Summation of the water vapour lines in Equation (2b) at
+ |                several frequencies.  The line strengths and widths are
+ |                computed once, eight lines at a time, and the line shapes
+ |                eight frequencies at a time.  Each sum is identical to
+ |                WaterVapourLineSum_AVX512() at its frequency.
+ |
+ |        Input:  lines         - Line table
+ |                N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Outputs:  sums          - Sum of S_i * F_i at each frequency
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX512 void WaterVapourLineSweep_AVX512(const WaterVapourLineTable& lines, int N, const double* f__ghz,
+    double theta, double e__hPa, double p__hPa, double* sums)
+{
+    WaterVapourState_AVX512 state = GetWaterVapourState_AVX512(theta, e__hPa, p__hPa);
+
+    size_t L = lines.f_0.size();
+    vector<double> S(L), delta_f(L);
+    for (size_t i = 0; i < L; i += 8)
+    {
+        __m512d S_i, delta_f_i;
+        WaterVapourLines_AVX512(lines, i, state, &S_i, &delta_f_i);
+
+        _mm512_storeu_pd(&S[i], S_i);
+        _mm512_storeu_pd(&delta_f[i], delta_f_i);
+    }
+
+    LineSweep_AVX512(L, lines.f_0.data(), lines.inv_f_0.data(), S.data(), delta_f.data(), nullptr, N, f__ghz, sums);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
\ No newline at end of file
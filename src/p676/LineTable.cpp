@@ -0,0 +1,173 @@
+#include <math.h>
+#include "../../include/p676.h"
+
+/*=============================================================================
+ |
+ |  Description:  Builds an oxygen line table from the given lines of
+ |                OxygenData.  Lines past the end of the given lines are
+ |                padding, with zero strength.
+ |
+ |        Input:  indices       - Indices of the lines in OxygenData
+ |
+ |      Returns:  lines         - Oxygen line table
+ |
+ *===========================================================================*/
+OxygenLineTable BuildOxygenLineTable(const vector<int>& indices)
+{
+    OxygenLineTable lines;
+
+    int N = indices.size();
+    int N_padded = ((N + LINE_TABLE__PADDING - 1) / LINE_TABLE__PADDING) * LINE_TABLE__PADDING;
+
+    // padding lines are placed far from any frequency with unit widths, so they are finite
+    lines.f_0.assign(N_padded, 1e6);
+    lines.inv_f_0.assign(N_padded, 1e-6);
+    lines.S.assign(N_padded, 0);
+    lines.x_S.assign(N_padded, 0);
+    lines.W.assign(N_padded, 1);
+    lines.x_W.assign(N_padded, 0);
+    lines.d_0.assign(N_padded, 0);
+    lines.d_1.assign(N_padded, 0);
+
+    for (int j = 0; j < N; j++)
+    {
+        int i = indices[j];
+
+        lines.f_0[j] = OxygenData::f_0[i];
+        lines.inv_f_0[j] = 1 / OxygenData::f_0[i];
+        lines.S[j] = OxygenData::a_1[i] * 1e-7;             // Equation 3
+        lines.x_S[j] = OxygenData::a_2[i];                  // Equation 3
+        lines.W[j] = OxygenData::a_3[i] * 1e-4;             // Equation 6a
+        lines.x_W[j] = 0.8 - OxygenData::a_4[i];            // Equation 6a
+        lines.d_0[j] = OxygenData::a_5[i];                  // Equation 7
+        lines.d_1[j] = OxygenData::a_6[i];                  // Equation 7
+    }
+
+    return lines;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Builds a water vapour line table from the given lines of
+ |                WaterVapourData.  Lines past the end of the given lines
+ |                are padding, with zero strength.
+ |
+ |        Input:  indices       - Indices of the lines in WaterVapourData
+ |
+ |      Returns:  lines         - Water vapour line table
+ |
+ *===========================================================================*/
+WaterVapourLineTable BuildWaterVapourLineTable(const vector<int>& indices)
+{
+    WaterVapourLineTable lines;
+
+    int N = indices.size();
+    int N_padded = ((N + LINE_TABLE__PADDING - 1) / LINE_TABLE__PADDING) * LINE_TABLE__PADDING;
+
+    // padding lines are placed far from any frequency with unit widths, so they are finite
+    lines.f_0.assign(N_padded, 1e6);
+    lines.inv_f_0.assign(N_padded, 1e-6);
+    lines.S.assign(N_padded, 0);
+    lines.x_S.assign(N_padded, 0);
+    lines.W.assign(N_padded, 1);
+    lines.x_p.assign(N_padded, 0);
+    lines.W_e.assign(N_padded, 0);
+    lines.x_e.assign(N_padded, 0);
+    lines.D.assign(N_padded, 1);
+
+    for (int j = 0; j < N; j++)
+    {
+        int i = indices[j];
+
+        lines.f_0[j] = WaterVapourData::f_0[i];
+        lines.inv_f_0[j] = 1 / WaterVapourData::f_0[i];
+        lines.S[j] = 0.1 * WaterVapourData::b_1[i];         // Equation 3
+        lines.x_S[j] = WaterVapourData::b_2[i];             // Equation 3
+        lines.W[j] = 1e-4 * WaterVapourData::b_3[i];        // Equation 6a
+        lines.x_p[j] = WaterVapourData::b_4[i];             // Equation 6a
+        lines.W_e[j] = WaterVapourData::b_5[i];             // Equation 6a
+        lines.x_e[j] = WaterVapourData::b_6[i];             // Equation 6a
+        lines.D[j] = 2.1316e-12 * pow(WaterVapourData::f_0[i], 2);     // Equation 6b
+    }
+
+    return lines;
+}
+
+static vector<int> AllLines(int N)
+{
+    vector<int> indices(N);
+    for (int i = 0; i < N; i++)
+        indices[i] = i;
+
+    return indices;
+}
+
+const OxygenLineTable& GetOxygenLineTable()
+{
+    static const OxygenLineTable lines = BuildOxygenLineTable(AllLines(OxygenData::f_0.size()));
+    return lines;
+}
+
+const WaterVapourLineTable& GetWaterVapourLineTable()
+{
+    static const WaterVapourLineTable lines = BuildWaterVapourLineTable(AllLines(WaterVapourData::f_0.size()));
+    return lines;
+}
+
+/*=============================================================================
+ |
+ |  Description:  One term, S_i * F_i, of the oxygen summation in Equation
+ |                (2a), from a line table.
+ |
+ |        Input:  lines         - Oxygen line table
+ |                i             - Line of interest
+ |                f__ghz        - Frequency, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Returns:  S_i * F_i
+ |
+ *===========================================================================*/
+double OxygenLineTerm(const OxygenLineTable& lines, int i, double f__ghz, double theta, double e__hPa, double p__hPa)
+{
+    // Equation 3
+    double S_i = lines.S[i] * p__hPa * pow(theta, 3) * exp(lines.x_S[i] * (1 - theta));
+
+    // Equation 6a, then 6b for Zeeman splitting
+    double delta_f__ghz = lines.W[i] * (p__hPa * pow(theta, lines.x_W[i]) + 1.1 * e__hPa * theta);
+    delta_f__ghz = sqrt(pow(delta_f__ghz, 2) + 2.25e-6);
+
+    // Equation 7
+    double delta = (lines.d_0[i] + lines.d_1[i] * theta) * 1e-4 * (p__hPa + e__hPa) * pow(theta, 0.8);
+
+    return S_i * LineShapeFactor(f__ghz, lines.f_0[i], delta_f__ghz, delta);
+}
+
+/*=============================================================================
+ |
+ |  Description:  One term, S_i * F_i, of the water vapour summation in
+ |                Equation (2b), from a line table.
+ |
+ |        Input:  lines         - Water vapour line table
+ |                i             - Line of interest
+ |                f__ghz        - Frequency, in GHz
+ |                theta         - From Equation 3
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Returns:  S_i * F_i
+ |
+ *===========================================================================*/
+double WaterVapourLineTerm(const WaterVapourLineTable& lines, int i, double f__ghz, double theta, double e__hPa, double p__hPa)
+{
+    // Equation 3
+    double S_i = lines.S[i] * e__hPa * pow(theta, 3.5) * exp(lines.x_S[i] * (1 - theta));
+
+    // Equation 6a, then 6b for Doppler broadening
+    double delta_f__ghz = lines.W[i] * (p__hPa * pow(theta, lines.x_p[i]) + lines.W_e[i] * e__hPa * pow(theta, lines.x_e[i]));
+    double term1 = 0.217 * pow(delta_f__ghz, 2) + lines.D[i] / theta;
+    delta_f__ghz = 0.535 * delta_f__ghz + sqrt(term1);
+
+    return S_i * LineShapeFactor(f__ghz, lines.f_0[i], delta_f__ghz, 0);
+}
\ No newline at end of file
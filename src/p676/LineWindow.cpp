@@ -0,0 +1,223 @@
+#include <math.h>
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <shared_mutex>
+#include "../../include/p676.h"
+#include "../../include/p835.h"
+
+// Windowing is off until a tolerance is set
+static atomic<double> line_window_tolerance(0);
+
+static map<pair<double, double>, shared_ptr<const LineWindow>> line_window_cache;
+static deque<pair<double, double>> line_window_cache_order;     // insertion order, for eviction
+static shared_timed_mutex line_window_cache_mutex;
+
+void SetLineWindowTolerance(double tolerance)
+{
+    line_window_tolerance = tolerance;
+}
+
+double GetLineWindowTolerance()
+{
+    return line_window_tolerance;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Selects the lines to drop from a line sum.  Lines are
+ |                dropped in order of their largest relative contribution to
+ |                the sum, for as long as folding the dropped lines into the
+ |                kept sum as a factor of (1 + rho) keeps the relative error
+ |                within the tolerance at every sample.
+ |
+ |        Input:  terms         - Line terms, terms[i][k] for line i and
+ |                                sample k
+ |                tolerance     - Bound on the relative error of the sum
+ |
+ |      Outputs:  kept          - Indices of the lines kept
+ |                rho           - Residual factor of the dropped lines
+ |                error         - Largest relative error over the samples
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+static void SelectLines(const vector<vector<double>>& terms, double tolerance,
+    vector<int>* kept, double* rho, double* error)
+{
+    int N = terms.size();
+    int K = terms[0].size();
+
+    vector<double> total(K, 0);
+    for (int i = 0; i < N; i++)
+        for (int k = 0; k < K; k++)
+            total[k] += terms[i][k];
+
+    // order the lines from least to most important
+    vector<double> importance(N, 0);
+    for (int i = 0; i < N; i++)
+        for (int k = 0; k < K; k++)
+            importance[i] = MAX(importance[i], abs(terms[i][k] / total[k]));
+
+    vector<int> order(N);
+    for (int i = 0; i < N; i++)
+        order[i] = i;
+    sort(order.begin(), order.end(), [&](int a, int b) { return importance[a] < importance[b]; });
+
+    vector<bool> is_dropped(N, false);
+    vector<double> dropped(K, 0);
+    vector<double> trial(K);
+    vector<double> q(K);
+
+    *rho = 0;
+    *error = 0;
+
+    // always keep the most important line
+    for (int j = 0; j < N - 1; j++)
+    {
+        int i = order[j];
+
+        // ratio of the dropped to the kept sum at each sample
+        bool is_valid = true;
+        for (int k = 0; k < K; k++)
+        {
+            trial[k] = dropped[k] + terms[i][k];
+            q[k] = trial[k] / (total[k] - trial[k]);
+            if (!isfinite(q[k]))
+                is_valid = false;
+        }
+        if (!is_valid)
+            break;
+
+        // the residual factor is the mid-range of the ratios
+        double rho_trial = (*min_element(q.begin(), q.end()) + *max_element(q.begin(), q.end())) / 2;
+
+        // relative error of (1 + rho) * kept against the full sum
+        double error_trial = 0;
+        for (int k = 0; k < K; k++)
+            error_trial = MAX(error_trial, abs((rho_trial - q[k]) * (total[k] - trial[k]) / total[k]));
+
+        if (error_trial > tolerance)
+            break;
+
+        dropped = trial;
+        is_dropped[i] = true;
+        *rho = rho_trial;
+        *error = error_trial;
+    }
+
+    kept->clear();
+    for (int i = 0; i < N; i++)
+        if (!is_dropped[i])
+            kept->push_back(i);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Finds the oxygen and water vapour lines needed at a
+ |                frequency to keep each line sum within a relative error
+ |                tolerance.  The error is measured over the mean annual
+ |                global reference atmosphere, sampled every
+ |                LINE_WINDOW__H_STEP__KM up to LINE_WINDOW__H_MAX__KM.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |                tolerance     - Bound on the relative error of each sum
+ |
+ |      Outputs:  window        - Line window structure
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void ComputeLineWindow(double f__ghz, double tolerance, LineWindow* window)
+{
+    window->f__ghz = f__ghz;
+    window->tolerance = tolerance;
+
+    int K = (int)round(LINE_WINDOW__H_MAX__KM / LINE_WINDOW__H_STEP__KM) + 1;
+
+    const OxygenLineTable& oxygen = GetOxygenLineTable();
+    const WaterVapourLineTable& water_vapour = GetWaterVapourLineTable();
+
+    int N_o = OxygenData::f_0.size();
+    int N_w = WaterVapourData::f_0.size();
+
+    vector<vector<double>> terms_o(N_o, vector<double>(K));
+    vector<vector<double>> terms_w(N_w, vector<double>(K));
+
+    for (int k = 0; k < K; k++)
+    {
+        double h__km = k * LINE_WINDOW__H_STEP__KM;
+
+        double T__kelvin = GlobalTemperature(h__km);
+        double p__hPa = GlobalPressure(h__km);
+        double e__hPa = GlobalWetPressure(h__km);
+        double theta = 300 / T__kelvin;
+
+        for (int i = 0; i < N_o; i++)
+            terms_o[i][k] = OxygenLineTerm(oxygen, i, f__ghz, theta, e__hPa, p__hPa);
+        for (int i = 0; i < N_w; i++)
+            terms_w[i][k] = WaterVapourLineTerm(water_vapour, i, f__ghz, theta, e__hPa, p__hPa);
+    }
+
+    vector<int> kept;
+
+    SelectLines(terms_o, tolerance, &kept, &window->rho_o, &window->error_o);
+    window->oxygen = BuildOxygenLineTable(kept);
+
+    SelectLines(terms_w, tolerance, &kept, &window->rho_w, &window->error_w);
+    window->water_vapour = BuildWaterVapourLineTable(kept);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Returns the line window at a frequency, from a cache
+ |                shared across calls and threads.  The oldest window is
+ |                evicted once the cache holds LINE_WINDOW__CAPACITY
+ |                windows.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |                tolerance     - Bound on the relative error of each sum
+ |
+ |      Returns:  window        - Line window
+ |
+ *===========================================================================*/
+shared_ptr<const LineWindow> GetLineWindow(double f__ghz, double tolerance)
+{
+    // every layer of a ray trace asks for the same window
+    thread_local shared_ptr<const LineWindow> last;
+    if (last && last->f__ghz == f__ghz && last->tolerance == tolerance)
+        return last;
+
+    pair<double, double> key(f__ghz, tolerance);
+
+    {
+        shared_lock<shared_timed_mutex> lock(line_window_cache_mutex);
+
+        auto it = line_window_cache.find(key);
+        if (it != line_window_cache.end())
+            return last = it->second;
+    }
+
+    // compute outside of the lock, so other traces are not blocked
+    shared_ptr<LineWindow> window = make_shared<LineWindow>();
+    ComputeLineWindow(f__ghz, tolerance, window.get());
+
+    unique_lock<shared_timed_mutex> lock(line_window_cache_mutex);
+
+    // another thread may have added the same window in the meantime
+    auto it = line_window_cache.find(key);
+    if (it != line_window_cache.end())
+        return last = it->second;
+
+    while (line_window_cache.size() >= LINE_WINDOW__CAPACITY)
+    {
+        line_window_cache.erase(line_window_cache_order.front());
+        line_window_cache_order.pop_front();
+    }
+
+    line_window_cache[key] = window;
+    line_window_cache_order.push_back(key);
+
+    return last = window;
+}
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <math.h>
 #include "../../include/p676.h"
 #include "../../include/p835.h"
 
@@ -39,23 +40,42 @@ double LayerThickness(double m, int i)
 void RayTrace(double f__ghz, double h_1__km, double h_2__km, double beta_1__rad,
     RayTraceConfig config, SlantPathAttenuationResult* result)
 {
-    // Equations 16(a)-(c)
-    int i_lower = floor(100 * log(1e4 * h_1__km * (exp(1. / 100.) - 1) + 1) + 1);
-    int i_upper = ceil(100 * log(1e4 * h_2__km * (exp(1. / 100.) - 1) + 1) + 1);
-    double m = ((exp(2. / 100.) - exp(1. / 100.)) / (exp(i_upper / 100.) - exp(i_lower / 100.))) * (h_2__km - h_1__km);
+    // layers and their atmospheric properties, shared by every trace between these heights
+    shared_ptr<const LayerProfile> profile = GetLayerProfile(f__ghz, h_1__km, h_2__km, config);
+
+    RayTraceProfile(*profile, beta_1__rad, result, nullptr);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Traces a ray through the layers of a profile and computes
+ |                results such as atmospheric absorption loss and ray path
+ |                length.
+ |
+ |        Input:  profile       - Layers between the terminals
+ |                beta_1__rad   - Elevation angle (from zenith), in rad
+ |
+ |       Output:  result        - Ray trace result structure
+ |                layer_a__km   - Path length through each layer, in km,
+ |                                or null if not needed
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void RayTraceProfile(const LayerProfile& profile, double beta_1__rad, SlantPathAttenuationResult* result,
+    double* layer_a__km)
+{
+    int i_lower = profile.i_lower;
+    int i_upper = profile.i_upper;
 
     double gamma_i;
-    double gamma_ii;
     double n_i;
     double n_ii;
     double r_i__km;
     double r_ii__km;
-    double h_i__km;
-    double h_ii__km;
     double a_i__km;
     double alpha_i__rad = beta_1__rad;
     double delta_i__km;
-    double delta_ii__km;
     double beta_i__rad;
     double beta_ii__rad = beta_1__rad;
 
@@ -66,10 +86,9 @@ void RayTrace(double f__ghz, double h_1__km, double h_2__km, double beta_1__rad,
     result->delta_L__km = 0;
 
     // initialize starting layer
-    delta_i__km = LayerThickness(m, i_lower);
-    h_i__km = h_1__km + m * ((exp((i_lower - 1) / 100.) - exp((i_lower - 1) / 100.)) / (exp(1 / 100.) - 1));
-    GetLayerProperties(f__ghz, h_i__km + delta_i__km / 2, config, &n_i, &gamma_i);
-    r_i__km = a_0__km + h_i__km;
+    n_i = profile.n[0];
+    gamma_i = profile.gamma[0];
+    r_i__km = a_0__km + profile.h__km[0];
 
     // record bottom layer properties for alpha and beta calculations
     double r_1__km = r_i__km;
@@ -78,14 +97,12 @@ void RayTrace(double f__ghz, double h_1__km, double h_2__km, double beta_1__rad,
     // summation from Equation 13
     for (int i = i_lower; i <= i_upper - 1; i++)
     {
-        delta_ii__km = LayerThickness(m, i + 1);
-        h_ii__km = h_1__km + m * ((exp((i + 1 - 1) / 100.) - exp((i_lower - 1) / 100.)) / (exp(1 / 100.) - 1));
+        int j = i - i_lower;
 
-        GetLayerProperties(f__ghz, h_ii__km + delta_ii__km / 2, config, &n_ii, &gamma_ii);
+        n_ii = profile.n[j + 1];
+        r_ii__km = a_0__km + profile.h__km[j + 1];
 
-        r_ii__km = a_0__km + h_ii__km;
-
-        delta_i__km = LayerThickness(m, i);
+        delta_i__km = profile.delta__km[j];
 
         // Equation 19b
         beta_i__rad = asin(MIN(1, (n_1 * r_1__km) / (n_i * r_i__km) * sin(beta_1__rad)));
@@ -96,6 +113,9 @@ void RayTrace(double f__ghz, double h_1__km, double h_2__km, double beta_1__rad,
         // path length through ith layer, Equation 17
         a_i__km = -r_i__km * cos(beta_i__rad) + sqrt(pow(r_i__km, 2) * pow(cos(beta_i__rad), 2) + 2 * r_i__km * delta_i__km + pow(delta_i__km, 2));
 
+        if (layer_a__km != nullptr)
+            layer_a__km[j] = a_i__km;
+
         result->a__km += a_i__km;
         result->A_gas__db += a_i__km * gamma_i;
         result->delta_L__km += a_i__km * (n_i - 1);     // summation, Equation 23
@@ -108,9 +128,8 @@ void RayTrace(double f__ghz, double h_1__km, double h_2__km, double beta_1__rad,
             result->bending__rad += beta_ii__rad - alpha_i__rad;
 
         // shift for next loop
-        h_i__km = h_ii__km;
         n_i = n_ii;
-        gamma_i = gamma_ii;
+        gamma_i = profile.gamma[j + 1];
         r_i__km = r_ii__km;
     }
 
@@ -119,29 +138,101 @@ void RayTrace(double f__ghz, double h_1__km, double h_2__km, double beta_1__rad,
 
 /*=============================================================================
  |
- |  Description:  Determine the parameters for the ith layer
+ |  Description:  Traces several rays with the vector ray trace kernel, if
+ |                the processor supports it, RAY_TRACE__LANES rays at a
+ |                time.  Each ray has its own layer profile, which may be
+ |                shared with other rays.
  |
- |        Input:  f__ghz        - Frequency, in GHz
- |                h_i__km       - Height of the ith layer, in km
+ |        Input:  N             - Number of rays
+ |                profiles      - Layers of each ray
+ |                beta_1__rad   - Elevation angle (from zenith) of each ray,
+ |                                in rad
+ |
+ |       Output:  results       - Ray trace result structure of each ray
+ |                layer_a__km   - Path length through each layer of each
+ |                                ray, in km, or null if not needed
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void RayTraceLanes(int N, const LayerProfile* const* profiles, const double* beta_1__rad,
+    SlantPathAttenuationResult* results, double* const* layer_a__km)
+{
+#if defined(LINE_KERNEL__X86)
+    // the AVX2 kernel is also used with AVX-512, whose wider division and square root are no faster per lane
+    if (GetLineKernel() != LINE_KERNEL__SCALAR)
+    {
+        for (int i = 0; i < N; i += RAY_TRACE__LANES)
+            RayTraceLanes_AVX2(&profiles[i], &beta_1__rad[i], MIN(N - i, RAY_TRACE__LANES), &results[i],
+                (layer_a__km != nullptr) ? &layer_a__km[i] : nullptr);
+        return;
+    }
+#endif
+
+    for (int i = 0; i < N; i++)
+        RayTraceProfile(*profiles[i], beta_1__rad[i], &results[i],
+            (layer_a__km != nullptr) ? layer_a__km[i] : nullptr);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Gaseous absorption along a traced ray at several
+ |                frequencies.  The path length through each layer does
+ |                not depend on the frequency, so a ray traced once by
+ |                RayTraceLanes() is integrated against the specific
+ |                attenuation of its layers at each frequency, in the same
+ |                order and rounding as the kernel that traced it.  With
+ |                the full line-by-line attenuation, the spectral lines of
+ |                each layer are summed for all frequencies in one pass.
+ |
+ |        Input:  profile       - Layers of the traced ray
+ |                layer_a__km   - Path length through each layer, in km
+ |                N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
  |                config        - Structure containing atmospheric params
  |
- |       Output:  n             - Refractive index
- |                gamma         - Specific attenuation, in dB/km
+ |       Output:  A_gas__db     - Gaseous absorption at each frequency,
+ |                                in dB
  |
  |      Returns:  [void]
  |
  *===========================================================================*/
-void GetLayerProperties(double f__ghz, double h_i__km, RayTraceConfig config,
-    double* n, double* gamma)
+void LayerAbsorption(const LayerProfile& profile, const double* layer_a__km, int N, const double* f__ghz,
+    RayTraceConfig config, double* A_gas__db)
 {
-    // use function pointers to get atmospheric parameters
-    double T__kelvin = config.temperature(h_i__km);
-    double p__hPa = config.dry_pressure(h_i__km);
-    double e__hPa = config.wet_pressure(h_i__km);
+    int layers = MAX(profile.i_upper - profile.i_lower, 0);
 
-    // compute the refractive index for the current layer
-    *n = RefractiveIndex(p__hPa, T__kelvin, e__hPa);
+    // the vector kernel accumulates with fused multiply-adds
+    bool is_fused = false;
+#if defined(LINE_KERNEL__X86)
+    is_fused = (GetLineKernel() != LINE_KERNEL__SCALAR);
+#endif
 
-    // specific attenuation of layer
-    *gamma = SpecificAttenuation(f__ghz, T__kelvin, e__hPa, p__hPa);
+    // the spectral lines of each layer are summed for every frequency at once
+    bool is_sweep = (config.specific_attenuation == SpecificAttenuation);
+
+    for (int k = 0; k < N; k++)
+        A_gas__db[k] = 0;
+
+    vector<double> gamma(N);
+    for (int j = 0; j < layers; j++)
+    {
+        if (is_sweep)
+            SpecificAttenuationSweep(N, f__ghz, profile.T__kelvin[j], profile.e__hPa[j], profile.p__hPa[j],
+                gamma.data());
+        else
+        {
+            for (int k = 0; k < N; k++)
+                gamma[k] = config.specific_attenuation(f__ghz[k], profile.T__kelvin[j], profile.e__hPa[j],
+                    profile.p__hPa[j]);
+        }
+
+        for (int k = 0; k < N; k++)
+        {
+            if (is_fused)
+                A_gas__db[k] = fma(layer_a__km[j], gamma[k], A_gas__db[k]);
+            else
+                A_gas__db[k] += layer_a__km[j] * gamma[k];
+        }
+    }
 }
\ No newline at end of file
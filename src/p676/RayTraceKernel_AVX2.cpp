@@ -0,0 +1,210 @@
+#include <math.h>
+#include "../../include/p676.h"
+
+#if defined(LINE_KERNEL__X86)
+
+#include <immintrin.h>
+
+/*=============================================================================
+ |
+ |  Description:  Vector arcsine for 0 <= x <= 1, from the rational
+ |                approximations of the Cephes library, to within 1 ULP of
+ |                asin().  Arguments above 1 give NaN, as asin() does.
+ |
+ |        Input:  x             - Argument
+ |
+ |      Returns:  asin(x)
+ |
+ *===========================================================================*/
+TARGET_AVX2 static inline __m256d Asin_AVX2(__m256d x)
+{
+    // x <= 0.625: asin(x) = x + x * z * P(z) / Q(z), with z = x^2
+    __m256d z = _mm256_mul_pd(x, x);
+
+    __m256d p = _mm256_set1_pd(4.253011369004428248960e-3);
+    p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(-6.019598008014123785661e-1));
+    p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(5.444622390564711410273e0));
+    p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(-1.626247967210700244449e1));
+    p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(1.956261983317594739197e1));
+    p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(-8.198089802484824371615e0));
+
+    __m256d q = _mm256_add_pd(z, _mm256_set1_pd(-1.474091372988853791896e1));
+    q = _mm256_fmadd_pd(q, z, _mm256_set1_pd(7.049610280856842141659e1));
+    q = _mm256_fmadd_pd(q, z, _mm256_set1_pd(-1.471791292232726029859e2));
+    q = _mm256_fmadd_pd(q, z, _mm256_set1_pd(1.395105614657485689735e2));
+    q = _mm256_fmadd_pd(q, z, _mm256_set1_pd(-4.918853881490881290097e1));
+
+    __m256d asin_low = _mm256_fmadd_pd(x, _mm256_mul_pd(z, _mm256_div_pd(p, q)), x);
+
+    // x > 0.625: asin(x) = pi/2 - 2 * asin(sqrt((1 - x) / 2)), with w = 1 - x
+    __m256d w = _mm256_sub_pd(_mm256_set1_pd(1), x);
+
+    __m256d r = _mm256_set1_pd(2.967721961301243206100e-3);
+    r = _mm256_fmadd_pd(r, w, _mm256_set1_pd(-5.634242780008963776856e-1));
+    r = _mm256_fmadd_pd(r, w, _mm256_set1_pd(6.968710824104713396794e0));
+    r = _mm256_fmadd_pd(r, w, _mm256_set1_pd(-2.556901049652824852289e1));
+    r = _mm256_fmadd_pd(r, w, _mm256_set1_pd(2.853665548261061424989e1));
+
+    __m256d s = _mm256_add_pd(w, _mm256_set1_pd(-2.194779531642920639778e1));
+    s = _mm256_fmadd_pd(s, w, _mm256_set1_pd(1.470656354026814941758e2));
+    s = _mm256_fmadd_pd(s, w, _mm256_set1_pd(-3.838770957603691357202e2));
+    s = _mm256_fmadd_pd(s, w, _mm256_set1_pd(3.424398657913078477438e2));
+
+    // pi/4 is split in two parts, so the sum keeps its low bits
+    __m256d pi_4 = _mm256_set1_pd(7.85398163397448309616e-1);
+    __m256d v = _mm256_sqrt_pd(_mm256_add_pd(w, w));
+    __m256d t = _mm256_fmsub_pd(v, _mm256_mul_pd(w, _mm256_div_pd(r, s)), _mm256_set1_pd(6.123233995736765886130e-17));
+    __m256d asin_high = _mm256_add_pd(_mm256_sub_pd(_mm256_sub_pd(pi_4, v), t), pi_4);
+
+    return _mm256_blendv_pd(asin_low, asin_high, _mm256_cmp_pd(x, _mm256_set1_pd(0.625), _CMP_GT_OQ));
+}
+
+// Loads one value of each lane, from the lane's own array
+TARGET_AVX2 static inline __m256d Gather_AVX2(const double* const* values, const int* index)
+{
+    return _mm256_set_pd(values[3][index[3]], values[2][index[2]], values[1][index[1]], values[0][index[0]]);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Traces up to 4 rays in lockstep, one per vector lane,
+ |                with the same equations as RayTraceProfile().  Each ray
+ |                has its own layer profile.  A lane stops accumulating
+ |                once its ray reaches the top of its profile, so rays of
+ |                different lengths may share the kernel.
+ |
+ |        Input:  profiles      - Layers of each ray
+ |                beta_1__rad   - Elevation angle (from zenith) of each ray,
+ |                                in rad
+ |                lanes         - Number of rays, 1 to 4
+ |
+ |       Output:  results       - Ray trace result structure of each ray
+ |                layer_a__km   - Path length through each layer of each
+ |                                ray, in km, or null if not needed
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+TARGET_AVX2 void RayTraceLanes_AVX2(const LayerProfile* const* profiles, const double* beta_1__rad, int lanes,
+    SlantPathAttenuationResult* results, double* const* layer_a__km)
+{
+    // unused lanes repeat the first ray
+    const double* n[4];
+    const double* gamma[4];
+    const double* h__km[4];
+    const double* delta__km[4];
+    double beta[4];
+    double sin_beta_1[4];
+    int layers[4];
+    int layers_max = 0;
+
+    for (int l = 0; l < 4; l++)
+    {
+        int k = (l < lanes) ? l : 0;
+        const LayerProfile& profile = *profiles[k];
+
+        n[l] = profile.n.data();
+        gamma[l] = profile.gamma.data();
+        h__km[l] = profile.h__km.data();
+        delta__km[l] = profile.delta__km.data();
+        beta[l] = beta_1__rad[k];
+        sin_beta_1[l] = sin(beta_1__rad[k]);
+        layers[l] = MAX(profile.i_upper - profile.i_lower, 0);
+        layers_max = MAX(layers_max, layers[l]);
+    }
+
+    __m256d one = _mm256_set1_pd(1);
+    __m256d a_0 = _mm256_set1_pd(a_0__km);
+    __m256d sin_b = _mm256_loadu_pd(sin_beta_1);
+
+    __m256d A_gas = _mm256_setzero_pd();
+    __m256d bending = _mm256_setzero_pd();
+    __m256d a = _mm256_setzero_pd();
+    __m256d delta_L = _mm256_setzero_pd();
+    __m256d angle = _mm256_loadu_pd(beta);
+
+    // initialize starting layer
+    int index[4] = { 0, 0, 0, 0 };
+    __m256d n_i = Gather_AVX2(n, index);
+    __m256d gamma_i = Gather_AVX2(gamma, index);
+    __m256d r_i = _mm256_add_pd(a_0, Gather_AVX2(h__km, index));
+
+    __m256d n_1_r_1 = _mm256_mul_pd(n_i, r_i);
+
+    for (int j = 0; j < layers_max; j++)
+    {
+        // finished lanes reload their last layer, and their results are masked out
+        int index_i[4], index_ii[4];
+        for (int l = 0; l < 4; l++)
+        {
+            index_i[l] = MAX(MIN(j, layers[l] - 1), 0);
+            index_ii[l] = MIN(j + 1, layers[l]);
+        }
+        __m256d is_active = _mm256_castsi256_pd(_mm256_set_epi64x(
+            -(j < layers[3]), -(j < layers[2]), -(j < layers[1]), -(j < layers[0])));
+        __m256d is_bending = _mm256_castsi256_pd(_mm256_set_epi64x(
+            -(j < layers[3] - 1), -(j < layers[2] - 1), -(j < layers[1] - 1), -(j < layers[0] - 1)));
+
+        __m256d n_ii = Gather_AVX2(n, index_ii);
+        __m256d r_ii = _mm256_add_pd(a_0, Gather_AVX2(h__km, index_ii));
+        __m256d delta_i = Gather_AVX2(delta__km, index_i);
+
+        // Equation 19b, only needed through cos(beta_i)
+        __m256d sin_beta_i = _mm256_min_pd(one, _mm256_mul_pd(_mm256_div_pd(n_1_r_1, _mm256_mul_pd(n_i, r_i)), sin_b));
+        __m256d cos_beta_i = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(one, sin_beta_i), _mm256_add_pd(one, sin_beta_i)));
+
+        // entry angle into the layer interface, Equation 18a
+        __m256d sin_alpha_i = _mm256_min_pd(one, _mm256_mul_pd(_mm256_div_pd(n_1_r_1, _mm256_mul_pd(n_i, r_ii)), sin_b));
+        __m256d alpha_i = Asin_AVX2(sin_alpha_i);
+
+        // path length through ith layer, Equation 17, rationalized to avoid cancellation near the zenith
+        __m256d r_cos = _mm256_mul_pd(r_i, cos_beta_i);
+        __m256d c = _mm256_mul_pd(delta_i, _mm256_fmadd_pd(_mm256_set1_pd(2), r_i, delta_i));
+        __m256d a_i = _mm256_div_pd(c, _mm256_add_pd(r_cos, _mm256_sqrt_pd(_mm256_fmadd_pd(r_cos, r_cos, c))));
+        a_i = _mm256_and_pd(is_active, a_i);
+
+        if (layer_a__km != nullptr)
+        {
+            double a_lanes[4];
+            _mm256_storeu_pd(a_lanes, a_i);
+            for (int l = 0; l < lanes; l++)
+                if (j < layers[l])
+                    layer_a__km[l][j] = a_lanes[l];
+        }
+
+        a = _mm256_add_pd(a, a_i);
+        A_gas = _mm256_fmadd_pd(a_i, gamma_i, A_gas);
+        delta_L = _mm256_fmadd_pd(a_i, _mm256_sub_pd(n_i, one), delta_L);     // summation, Equation 23
+
+        __m256d beta_ii = Asin_AVX2(_mm256_mul_pd(_mm256_div_pd(n_i, n_ii), sin_alpha_i));
+
+        // summation of the bending angle, Equation 22a
+        // the summation only goes to i_max - 1
+        bending = _mm256_add_pd(bending, _mm256_and_pd(is_bending, _mm256_sub_pd(beta_ii, alpha_i)));
+
+        angle = _mm256_blendv_pd(angle, alpha_i, is_active);
+
+        // shift for next loop
+        n_i = n_ii;
+        gamma_i = Gather_AVX2(gamma, index_ii);
+        r_i = r_ii;
+    }
+
+    double values[5][4];
+    _mm256_storeu_pd(values[0], A_gas);
+    _mm256_storeu_pd(values[1], bending);
+    _mm256_storeu_pd(values[2], a);
+    _mm256_storeu_pd(values[3], angle);
+    _mm256_storeu_pd(values[4], delta_L);
+
+    for (int l = 0; l < lanes; l++)
+    {
+        results[l].A_gas__db = values[0][l];
+        results[l].bending__rad = values[1][l];
+        results[l].a__km = values[2][l];
+        results[l].angle__rad = values[3][l];
+        results[l].delta_L__km = values[4][l];
+    }
+}
+
+#endif
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <math.h>
 #include "../../include/p676.h"
 
 /*=============================================================================
@@ -19,6 +20,16 @@ double OxygenRefractivity(double f__ghz, double T__kelvin, double e__hPa, double
 
     double N = 0;
 
+    double tolerance = GetLineWindowTolerance();
+    if (tolerance > 0)
+    {
+        // only the lines needed at this frequency, with the rest folded into a residual
+        shared_ptr<const LineWindow> window = GetLineWindow(f__ghz, tolerance);
+        N = (1 + window->rho_o) * OxygenLineSum(window->oxygen, f__ghz, theta, e__hPa, p__hPa);
+    }
+    else if (GetLineKernel() != LINE_KERNEL__SCALAR)
+        N = OxygenLineSum(GetOxygenLineTable(), f__ghz, theta, e__hPa, p__hPa);
+    else
     for (int i = 0; i < OxygenData::f_0.size(); i++)
     {
         // Equation 3, for oxygen
@@ -67,6 +78,16 @@ double WaterVapourRefractivity(double f__ghz, double T__kelvin, double e__hPa, d
 
     double N_w = 0;
 
+    double tolerance = GetLineWindowTolerance();
+    if (tolerance > 0)
+    {
+        // only the lines needed at this frequency, with the rest folded into a residual
+        shared_ptr<const LineWindow> window = GetLineWindow(f__ghz, tolerance);
+        N_w = (1 + window->rho_w) * WaterVapourLineSum(window->water_vapour, f__ghz, theta, e__hPa, P__hPa);
+    }
+    else if (GetLineKernel() != LINE_KERNEL__SCALAR)
+        N_w = WaterVapourLineSum(GetWaterVapourLineTable(), f__ghz, theta, e__hPa, P__hPa);
+    else
     for (int i = 0; i < WaterVapourData::f_0.size(); i++)
     {
         // Equation 3, for water vapour
@@ -90,4 +111,122 @@ double WaterVapourRefractivity(double f__ghz, double T__kelvin, double e__hPa, d
     }
 
     return N_w;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Imaginary part of the frequency-dependent complex
+ |                refractivity due to oxygen, at several frequencies.  The
+ |                line strengths and widths, and the frequency-independent
+ |                terms of the Debye spectrum, are computed once.  Each
+ |                value is identical to OxygenRefractivity() at its
+ |                frequency, without line windows.
+ |
+ |        Input:  N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |                T__kelvin     - Temperature, in Kelvin
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Outputs:  N_o           - Refractivity at each frequency, in N-Units
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void OxygenRefractivitySweep(int N, const double* f__ghz, double T__kelvin, double e__hPa, double p__hPa,
+    double* N_o)
+{
+    double theta = 300 / T__kelvin;
+
+    if (GetLineKernel() != LINE_KERNEL__SCALAR)
+        OxygenLineSweep(GetOxygenLineTable(), N, f__ghz, theta, e__hPa, p__hPa, N_o);
+    else
+    {
+        int L = (int)OxygenData::f_0.size();
+        vector<double> S_i(L), delta_f__ghz(L), delta(L);
+        for (int i = 0; i < L; i++)
+        {
+            // Equation 3, for oxygen
+            S_i[i] = OxygenData::a_1[i] * 1e-7 * p__hPa * pow(theta, 3) * exp(OxygenData::a_2[i] * (1 - theta));
+
+            // Equation 6a, then 6b for Zeeman splitting
+            delta_f__ghz[i] = OxygenData::a_3[i] * 1e-4 * (p__hPa * pow(theta, (0.8 - OxygenData::a_4[i])) + 1.1  * e__hPa * theta);
+            delta_f__ghz[i] = sqrt(pow(delta_f__ghz[i], 2) + 2.25e-6);
+
+            // Equation 7, for oxygen
+            delta[i] = (OxygenData::a_5[i] + OxygenData::a_6[i] * theta) * 1e-4 * (p__hPa + e__hPa) * pow(theta, 0.8);
+        }
+
+        for (int k = 0; k < N; k++)
+        {
+            N_o[k] = 0;
+            for (int i = 0; i < L; i++)
+                N_o[k] += S_i[i] * LineShapeFactor(f__ghz[k], OxygenData::f_0[i], delta_f__ghz[i], delta[i]);
+        }
+    }
+
+    // frequency-independent terms of Equations 8 and 9
+    double d = 5.6e-4 * (p__hPa + e__hPa) * pow(theta, 0.8);
+    double numerator_2 = 1.4e-12 * p__hPa * pow(theta, 1.5);
+    double theta_2 = pow(theta, 2);
+
+    for (int k = 0; k < N; k++)
+    {
+        double frac_1 = 6.14e-5 / (d * (1 + pow(f__ghz[k] / d, 2)));
+        double frac_2 = numerator_2 / (1 + 1.9e-5 * pow(f__ghz[k], 1.5));
+        double N_D = f__ghz[k] * p__hPa * theta_2 * (frac_1 + frac_2);
+
+        N_o[k] = N_o[k] + N_D;
+    }
+}
+
+/*=============================================================================
+ |
+ |  Description:  Imaginary part of the frequency-dependent complex
+ |                refractivity due to water vapour, at several frequencies.
+ |                The line strengths and widths are computed once.  Each
+ |                value is identical to WaterVapourRefractivity() at its
+ |                frequency, without line windows.
+ |
+ |        Input:  N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |                T__kelvin     - Temperature, in Kelvin
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Outputs:  N_w           - Refractivity at each frequency, in N-Units
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void WaterVapourRefractivitySweep(int N, const double* f__ghz, double T__kelvin, double e__hPa, double P__hPa,
+    double* N_w)
+{
+    double theta = 300 / T__kelvin;
+
+    if (GetLineKernel() != LINE_KERNEL__SCALAR)
+    {
+        WaterVapourLineSweep(GetWaterVapourLineTable(), N, f__ghz, theta, e__hPa, P__hPa, N_w);
+        return;
+    }
+
+    int L = (int)WaterVapourData::f_0.size();
+    vector<double> S_i(L), delta_f__ghz(L);
+    for (int i = 0; i < L; i++)
+    {
+        // Equation 3, for water vapour
+        S_i[i] = 0.1 * WaterVapourData::b_1[i] * e__hPa * pow(theta, 3.5) * exp(WaterVapourData::b_2[i] * (1 - theta));
+
+        // Equation 6a, then 6b for Doppler broadening
+        delta_f__ghz[i] = 1e-4 * WaterVapourData::b_3[i] * (P__hPa * pow(theta, WaterVapourData::b_4[i]) + WaterVapourData::b_5[i] * e__hPa * pow(theta, WaterVapourData::b_6[i]));
+        double term1 = 0.217 * pow(delta_f__ghz[i], 2) + (2.1316e-12 * pow(WaterVapourData::f_0[i], 2) / theta);
+        delta_f__ghz[i] = 0.535 * delta_f__ghz[i] + sqrt(term1);
+    }
+
+    for (int k = 0; k < N; k++)
+    {
+        N_w[k] = 0;
+        for (int i = 0; i < L; i++)
+            N_w[k] += S_i[i] * LineShapeFactor(f__ghz[k], WaterVapourData::f_0[i], delta_f__ghz[i], 0);
+    }
 }
\ No newline at end of file
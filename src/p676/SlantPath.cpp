@@ -1,73 +1,608 @@
+#include <math.h>
+#include <float.h>
+#include <atomic>
 #include "../../include/p676.h"
 #include "../../include/p835.h"
 
-// Calculation the slant path attenuation due to atmospheric gases
-int SlantPathAttenuation(double f__ghz, double h_1__km, double h_2__km, double beta_1__rad,
-    SlantPathAttenuationResult* result)
+// The grazing height is found by the binary search of the reference until the exact search is selected
+static atomic<int> grazing_height_search(GRAZING_HEIGHT__BISECTION);
+
+void SetGrazingHeightSearch(int mode)
+{
+    grazing_height_search = mode;
+}
+
+int GetGrazingHeightSearch()
+{
+    return grazing_height_search;
+}
+
+// Atmospheric parameters of the slant path calculations
+static RayTraceConfig SlantPathConfig()
 {
     RayTraceConfig config;
     config.temperature = GlobalTemperature;
     config.dry_pressure = GlobalPressure;
     config.wet_pressure = GlobalWetPressure;
 
+    if (GetAttenuationEngine() == ATTENUATION_ENGINE__APPROXIMATE)
+        config.specific_attenuation = ApproximateSpecificAttenuation;
+    else
+        config.specific_attenuation = SpecificAttenuation;
+
+    return config;
+}
+
+// Specific attenuation of the layer profiles that are only traced for their geometry
+static double NoAttenuation(double /*f__ghz*/, double /*T__kelvin*/, double /*e__hPa*/, double /*p__hPa*/)
+{
+    return 0;
+}
+
+// Atmospheric parameters of the slant path calculations that do not need the absorption.  Their layer profiles
+//      skip the line-by-line spectroscopy and are cached once for every frequency
+static RayTraceConfig GeometryConfig()
+{
+    RayTraceConfig config = SlantPathConfig();
+    config.specific_attenuation = NoAttenuation;
+
+    return config;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Finds the height at which a ray with a negative elevation
+ |                angle grazes, to within GRAZING_HEIGHT__EXACT_TOLERANCE__KM.
+ |                See Section 2.2.2.  The grazing height is where
+ |                n(h_G) * (a_0 + h_G) falls to the invariant
+ |                n_1 * (a_0 + h_1) * sin(beta_1) of the ray, which is
+ |                bracketed by the surface and h_1 and found by Brent's
+ |                method: secant and inverse quadratic steps, which fall
+ |                back to bisection whenever they do not shrink the bracket
+ |                fast enough.  The atmosphere is only known through the
+ |                functions of config, so the method needs no derivatives
+ |                of it.  A ray that would reach the surface grazes at the
+ |                surface.
+ |
+ |        Input:  h_1__km       - Height of the terminal, in km
+ |                beta_1__rad   - Elevation angle (from zenith), in rad
+ |                config        - Structure containing atmospheric params
+ |
+ |      Returns:  h_G__km       - Grazing height, in km
+ |
+ *===========================================================================*/
+static double ExactGrazingHeight(double h_1__km, double beta_1__rad, const RayTraceConfig& config)
+{
+    // compute refractive index at h_1
+    double p__hPa = config.dry_pressure(h_1__km);
+    double T__kelvin = config.temperature(h_1__km);
+    double e__hPa = config.wet_pressure(h_1__km);
+
+    double n_1 = RefractiveIndex(p__hPa, T__kelvin, e__hPa);
+
+    double start_term = n_1 * (a_0__km + h_1__km) * sin(beta_1__rad);
+
+    auto diff = [&](double h_G__km)
+    {
+        double n_G = RefractiveIndex(config.dry_pressure(h_G__km), config.temperature(h_G__km),
+            config.wet_pressure(h_G__km));
+
+        double grazing_term = n_G * (a_0__km + h_G__km);
+
+        return grazing_term - start_term;
+    };
+
+    // the surface and h_1 bracket the grazing height
+    double a = 0;
+    double f_a = diff(a);
+    if (f_a >= 0)
+        return 0;
+
+    double b = h_1__km;
+    double f_b = n_1 * (a_0__km + h_1__km) - start_term;
+
+    // c is the other end of the bracket of b, and d and e the last two steps
+    double c = a;
+    double f_c = f_a;
+    double d = b - a;
+    double e = d;
+
+    for (int i = 0; i < GRAZING_HEIGHT__ITERATIONS; i++)
+    {
+        if ((f_b > 0) == (f_c > 0))
+        {
+            c = a;
+            f_c = f_a;
+            d = b - a;
+            e = d;
+        }
+
+        // b is the best estimate so far
+        if (abs(f_c) < abs(f_b))
+        {
+            a = b;
+            b = c;
+            c = a;
+            f_a = f_b;
+            f_b = f_c;
+            f_c = f_a;
+        }
+
+        double tol = 2 * DBL_EPSILON * abs(b) + GRAZING_HEIGHT__EXACT_TOLERANCE__KM / 2;
+        double m = (c - b) / 2;
+        if (abs(m) <= tol || f_b == 0)
+            break;
+
+        if (abs(e) >= tol && abs(f_a) > abs(f_b))
+        {
+            double s = f_b / f_a;
+            double p, q;
+            if (a == c)
+            {
+                // secant step
+                p = 2 * m * s;
+                q = 1 - s;
+            }
+            else
+            {
+                // inverse quadratic step
+                double q_a = f_a / f_c;
+                double r = f_b / f_c;
+                p = s * (2 * m * q_a * (q_a - r) - (b - a) * (r - 1));
+                q = (q_a - 1) * (r - 1) * (s - 1);
+            }
+
+            if (p > 0)
+                q = -q;
+            else
+                p = -p;
+
+            // take the step only if it stays well within the bracket, and the steps are shrinking
+            if (2 * p < MIN(3 * m * q - abs(tol * q), abs(e * q)))
+            {
+                e = d;
+                d = p / q;
+            }
+            else
+            {
+                d = m;
+                e = m;
+            }
+        }
+        else
+        {
+            d = m;
+            e = m;
+        }
+
+        a = b;
+        f_a = f_b;
+        if (abs(d) > tol)
+            b += d;
+        else
+            b += (m > 0) ? tol : -tol;
+
+        f_b = diff(b);
+    }
+
+    return b;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Finds the height at which a ray with a negative elevation
+ |                angle grazes, by binary search.  See Section 2.2.2.  The
+ |                search stops at the first step where n(h_G) * (a_0 + h_G)
+ |                is within GRAZING_HEIGHT__TOLERANCE of the invariant
+ |                n_1 * (a_0 + h_1) * sin(beta_1) of the ray.  Since that
+ |                term grows with height in the reference atmosphere, every
+ |                step below a height found to be under the tolerance band,
+ |                or above one found to be over it, moves the same way
+ |                without evaluating the atmosphere.  The atmosphere is
+ |                evaluated at heights interpolated just outside the band,
+ |                and only the steps between them are evaluated, so the
+ |                search returns the same height in fewer evaluations.  A ray
+ |                that would reach the surface grazes at the surface.
+ |
+ |        Input:  h_1__km       - Height of the terminal, in km
+ |                beta_1__rad   - Elevation angle (from zenith), in rad
+ |                config        - Structure containing atmospheric params
+ |
+ |      Returns:  h_G__km       - Grazing height, in km
+ |
+ *===========================================================================*/
+static double GrazingHeight(double h_1__km, double beta_1__rad, const RayTraceConfig& config)
+{
+    if (GetGrazingHeightSearch() == GRAZING_HEIGHT__EXACT)
+        return ExactGrazingHeight(h_1__km, beta_1__rad, config);
+
+    // compute refractive index at h_1
+    double p__hPa = config.dry_pressure(h_1__km);
+    double T__kelvin = config.temperature(h_1__km);
+    double e__hPa = config.wet_pressure(h_1__km);
+
+    double n_1 = RefractiveIndex(p__hPa, T__kelvin, e__hPa);
+
+    double start_term = n_1 * (a_0__km + h_1__km) * sin(beta_1__rad);
+
+    auto diff = [&](double h_G__km)
+    {
+        double n_G = RefractiveIndex(config.dry_pressure(h_G__km), config.temperature(h_G__km),
+            config.wet_pressure(h_G__km));
+
+        double grazing_term = n_G * (a_0__km + h_G__km);
+
+        return grazing_term - start_term;
+    };
+
+    // every step of the binary search lies strictly between the surface and h_1, so they bound the steps
+    double h_lo__km = 0;
+    double diff_lo = diff(h_lo__km);
+    double h_hi__km = h_1__km;
+    double diff_hi = n_1 * (a_0__km + h_1__km) - start_term;
+
+    // the binary search would approach the surface without end
+    if (diff_lo > GRAZING_HEIGHT__TOLERANCE)
+        return 0;
+
+    // set initial h_G at mid-point between h_1 and surface of the earth
+    // then binary search to converge
+    double h_G__km = h_1__km;
+    double delta = h_1__km / 2;
+    bool is_above = true;
+
+    for (int i = 0; i < GRAZING_HEIGHT__ITERATIONS; i++)
+    {
+        if (is_above)
+            h_G__km -= delta;
+        else
+            h_G__km += delta;
+        delta /= 2;
+
+        if (h_G__km <= h_lo__km)
+        {
+            is_above = false;
+            continue;
+        }
+        if (h_G__km >= h_hi__km)
+        {
+            is_above = true;
+            continue;
+        }
+
+        // unless the step is near the band, first evaluate where the line between the bounds leaves the band
+        double slope = (diff_hi - diff_lo) / (h_hi__km - h_lo__km);
+        double diff_guess = diff_lo + slope * (h_G__km - h_lo__km);
+        if (abs(diff_guess) > 4 * GRAZING_HEIGHT__TOLERANCE)
+        {
+            double target = (diff_guess > 0) ? 2 * GRAZING_HEIGHT__TOLERANCE : -2 * GRAZING_HEIGHT__TOLERANCE;
+            double h__km = h_lo__km + (target - diff_lo) / slope;
+
+            if (h__km > h_lo__km && h__km < h_hi__km)
+            {
+                double diff_h = diff(h__km);
+                if (diff_h < -GRAZING_HEIGHT__TOLERANCE)
+                {
+                    h_lo__km = h__km;
+                    diff_lo = diff_h;
+                }
+                else if (diff_h > GRAZING_HEIGHT__TOLERANCE)
+                {
+                    h_hi__km = h__km;
+                    diff_hi = diff_h;
+                }
+
+                if (h_G__km <= h_lo__km)
+                {
+                    is_above = false;
+                    continue;
+                }
+                if (h_G__km >= h_hi__km)
+                {
+                    is_above = true;
+                    continue;
+                }
+            }
+        }
+
+        double diff_G = diff(h_G__km);
+        if (abs(diff_G) <= GRAZING_HEIGHT__TOLERANCE)
+            break;
+
+        is_above = (diff_G > 0);
+        if (is_above)
+        {
+            h_hi__km = h_G__km;
+            diff_hi = diff_G;
+        }
+        else
+        {
+            h_lo__km = h_G__km;
+            diff_lo = diff_G;
+        }
+    }
+
+    return h_G__km;
+}
+
+// Calculation the slant path attenuation due to atmospheric gases
+int SlantPathAttenuation(double f__ghz, double h_1__km, double h_2__km, double beta_1__rad,
+    SlantPathAttenuationResult* result)
+{
+    return SlantPathAttenuationLanes(f__ghz, h_1__km, h_2__km, &beta_1__rad, 1, result);
+}
+
+/*=============================================================================
+ |
+ |  Description:  Calculation of the slant path attenuation due to
+ |                atmospheric gases for several rays between the same
+ |                terminals.  The rays are traced together by
+ |                RayTraceLanes(), so that rays leaving at different
+ |                elevation angles share the vector lanes of the kernel.
+ |
+ |        Input:  f__ghz        - Frequency, in GHz
+ |                h_1__km       - Height of the low terminal, in km
+ |                h_2__km       - Height of the high terminal, in km
+ |                beta_1__rad   - Elevation angle (from zenith) of each ray,
+ |                                in rad
+ |                N             - Number of rays
+ |
+ |       Output:  results       - Slant path result structure of each ray
+ |
+ |      Returns:  rtn           - 0
+ |
+ *===========================================================================*/
+int SlantPathAttenuationLanes(double f__ghz, double h_1__km, double h_2__km, const double* beta_1__rad, int N,
+    SlantPathAttenuationResult* results)
+{
+    RayTraceConfig config = SlantPathConfig();
+
+    // each ray is traced as one lane, or as two lanes from its grazing height.  lane[i] is the first lane of
+    //      ray i, or -1 if it was read from a horizon ray table.  With the horizon ray tables, a ray from its
+    //      grazing height is traced as one lane up to h_2, and the part down to h_1 is read from that lane
+    vector<int> lane(N);
+    vector<SlantPathAttenuationResult> lower(N);
+    vector<bool> is_prefix(N, false);
+    vector<shared_ptr<const LayerProfile>> profiles;
+    vector<double> beta_lanes__rad;
+    shared_ptr<const LayerProfile> profile_12;      // layers between the terminals, shared by upward rays
+
+    for (int i = 0; i < N; i++)
+    {
+        double beta__rad = beta_1__rad[i];
+
+        if (GetHorizonRayTables() && h_1__km == 0 && beta__rad == PI / 2 &&
+            h_2__km >= HORIZON_RAY__H_MIN__KM && h_2__km <= HORIZON_RAY__H_MAX__KM)
+        {
+            // a horizontal ray from the surface is a prefix of the tabulated ray
+            shared_ptr<const HorizonRayTable> table = GetHorizonRayTable(f__ghz, config);
+            HorizonRay(*table, h_2__km, &results[i]);
+
+            lane[i] = -1;
+            continue;
+        }
+
+        lane[i] = (int)profiles.size();
+
+        if (beta__rad > PI / 2)
+        {
+            // negative elevation angle
+            // find h_G and then trace in each direction with grazing angle
+            // see Section 2.2.2
+            double h_G__km = GrazingHeight(h_1__km, beta__rad, config);
+
+            if (GetHorizonRayTables())
+            {
+                // the horizontal ray from h_G to the lower terminal is a prefix of the ray to the upper
+                //      terminal, so only the layers up to h_2 are computed
+                profiles.push_back(GetLayerProfile(f__ghz, h_G__km, h_2__km, config));
+                beta_lanes__rad.push_back(PI / 2);
+
+                HorizonRayTable table;
+                TraceHorizonRay(profiles.back(), h_1__km, &table);
+                HorizonRay(table, h_1__km, &lower[i]);
+                is_prefix[i] = true;
+            }
+            else
+            {
+                profiles.push_back(GetLayerProfile(f__ghz, h_G__km, h_1__km, config));
+                profiles.push_back(GetLayerProfile(f__ghz, h_G__km, h_2__km, config));
+                beta_lanes__rad.push_back(PI / 2);
+                beta_lanes__rad.push_back(PI / 2);
+            }
+        }
+        else
+        {
+            if (profile_12 == nullptr)
+                profile_12 = GetLayerProfile(f__ghz, h_1__km, h_2__km, config);
+
+            profiles.push_back(profile_12);
+            beta_lanes__rad.push_back(beta__rad);
+        }
+    }
+
+    vector<const LayerProfile*> layers(profiles.size());
+    for (size_t k = 0; k < profiles.size(); k++)
+        layers[k] = profiles[k].get();
+
+    vector<SlantPathAttenuationResult> traced(profiles.size());
+    RayTraceLanes((int)profiles.size(), layers.data(), beta_lanes__rad.data(), traced.data(), nullptr);
+
+    for (int i = 0; i < N; i++)
+    {
+        if (lane[i] < 0)
+            continue;
+
+        if (beta_1__rad[i] > PI / 2)
+        {
+            const SlantPathAttenuationResult& result_1 = is_prefix[i] ? lower[i] : traced[lane[i]];
+            const SlantPathAttenuationResult& result_2 = is_prefix[i] ? traced[lane[i]] : traced[lane[i] + 1];
+
+            results[i].angle__rad = result_2.angle__rad;
+            results[i].A_gas__db = result_1.A_gas__db + result_2.A_gas__db;
+            results[i].a__km = result_1.a__km + result_2.a__km;
+            results[i].bending__rad = result_1.bending__rad + result_2.bending__rad;
+            results[i].delta_L__km = result_1.delta_L__km + result_2.delta_L__km;
+        }
+        else
+            results[i] = traced[lane[i]];
+    }
+
+    return 0;
+}
+
+/*=============================================================================
+ |
+ |  Description:  Calculation of the slant path attenuation due to
+ |                atmospheric gases for one ray at several frequencies.
+ |                The layers, refractive indices and ray geometry do not
+ |                depend on the frequency, so the ray is traced once, and
+ |                only the absorption is integrated at each frequency.
+ |                Results are identical to calling SlantPathAttenuation()
+ |                at each frequency, with the horizon ray tables disabled.
+ |
+ |        Input:  f__ghz        - Frequencies, in GHz
+ |                N             - Number of frequencies
+ |                h_1__km       - Height of the low terminal, in km
+ |                h_2__km       - Height of the high terminal, in km
+ |                beta_1__rad   - Elevation angle (from zenith), in rad
+ |
+ |       Output:  results       - Slant path result structure of each
+ |                                frequency
+ |
+ |      Returns:  rtn           - 0
+ |
+ *===========================================================================*/
+int SlantPathAttenuationSweep(const double* f__ghz, int N, double h_1__km, double h_2__km, double beta_1__rad,
+    SlantPathAttenuationResult* results)
+{
+    RayTraceConfig config = SlantPathConfig();
+    RayTraceConfig geometry = GeometryConfig();
+
+    // the profiles are only used for their layers, which do not depend on the frequency
+    vector<shared_ptr<const LayerProfile>> profiles;
+    vector<double> beta_lanes__rad;
+
     if (beta_1__rad > PI / 2)
     {
         // negative elevation angle
-        // find h_G and then trace in each direction
+        // find h_G and then trace in each direction with grazing angle
         // see Section 2.2.2
+        double h_G__km = GrazingHeight(h_1__km, beta_1__rad, config);
 
-        // compute refractive index at h_1
-        double p__hPa = config.dry_pressure(h_1__km);
-        double T__kelvin = config.temperature(h_1__km);
-        double e__hPa = config.wet_pressure(h_1__km);
+        profiles.push_back(GetLayerProfile(0, h_G__km, h_1__km, geometry));
+        profiles.push_back(GetLayerProfile(0, h_G__km, h_2__km, geometry));
+        beta_lanes__rad.push_back(PI / 2);
+        beta_lanes__rad.push_back(PI / 2);
+    }
+    else
+    {
+        profiles.push_back(GetLayerProfile(0, h_1__km, h_2__km, geometry));
+        beta_lanes__rad.push_back(beta_1__rad);
+    }
+
+    int lanes = (int)profiles.size();
+
+    vector<const LayerProfile*> layers(lanes);
+    vector<vector<double>> layer_a__km(lanes);
+    vector<double*> layer_a_lanes__km(lanes);
+    for (int k = 0; k < lanes; k++)
+    {
+        layers[k] = profiles[k].get();
+        layer_a__km[k].resize(profiles[k]->h__km.size());
+        layer_a_lanes__km[k] = layer_a__km[k].data();
+    }
 
-        double n_1 = RefractiveIndex(p__hPa, T__kelvin, e__hPa);
+    vector<SlantPathAttenuationResult> traced(lanes);
+    RayTraceLanes(lanes, layers.data(), beta_lanes__rad.data(), traced.data(), layer_a_lanes__km.data());
 
-        // set initial h_G at mid-point between h_1 and surface of the earth
-        // then binary search to converge
-        double h_G__km = h_1__km;
-        double delta = h_1__km / 2;
-        double diff = 100;
+    // absorption of each lane, at every frequency
+    vector<vector<double>> A_gas__db(lanes, vector<double>(N));
+    for (int k = 0; k < lanes; k++)
+        LayerAbsorption(*profiles[k], layer_a__km[k].data(), N, f__ghz, config, A_gas__db[k].data());
 
-        double n_G;
-        double grazing_term;
-        double start_term;
-        do
+    for (int i = 0; i < N; i++)
+    {
+        if (lanes == 2)
         {
-            if (diff > 0)
-                h_G__km -= delta;
-            else
-                h_G__km += delta;
-            delta /= 2;
+            const SlantPathAttenuationResult& result_1 = traced[0];
+            const SlantPathAttenuationResult& result_2 = traced[1];
 
-            p__hPa = config.dry_pressure(h_G__km);
-            T__kelvin = config.temperature(h_G__km);
-            e__hPa = config.wet_pressure(h_G__km);
+            results[i].angle__rad = result_2.angle__rad;
+            results[i].A_gas__db = A_gas__db[0][i] + A_gas__db[1][i];
+            results[i].a__km = result_1.a__km + result_2.a__km;
+            results[i].bending__rad = result_1.bending__rad + result_2.bending__rad;
+            results[i].delta_L__km = result_1.delta_L__km + result_2.delta_L__km;
+        }
+        else
+        {
+            results[i] = traced[0];
+            results[i].A_gas__db = A_gas__db[0][i];
+        }
+    }
 
-            n_G = RefractiveIndex(p__hPa, T__kelvin, e__hPa);
+    return 0;
+}
 
-            grazing_term = n_G * (a_0__km + h_G__km);
-            start_term = n_1 * (a_0__km + h_1__km) * sin(beta_1__rad);
+/*=============================================================================
+ |
+ |  Description:  Traces the geometry of a slant path, without the
+ |                atmospheric absorption.  The layers are taken from
+ |                profiles that skip the line-by-line spectroscopy, which
+ |                are shared by every frequency.  The ray length, bending
+ |                and angles are identical to SlantPathAttenuation(), away
+ |                from the horizon ray tables, and A_gas__db is zero.
+ |
+ |        Input:  h_1__km       - Height of the low terminal, in km
+ |                h_2__km       - Height of the high terminal, in km
+ |                beta_1__rad   - Elevation angle (from zenith), in rad
+ |
+ |       Output:  result        - Slant path result structure
+ |
+ |      Returns:  rtn           - 0
+ |
+ *===========================================================================*/
+int SlantPathGeometry(double h_1__km, double h_2__km, double beta_1__rad, SlantPathAttenuationResult* result)
+{
+    RayTraceConfig geometry = GeometryConfig();
 
-            diff = grazing_term - start_term;
-        } while (abs(diff) > 0.001);
+    shared_ptr<const LayerProfile> profiles[2];
+    double beta_lanes__rad[2] = { PI / 2, PI / 2 };
+    int lanes;
 
-        // converged on h_G.  Now call RayTrace in both directions with grazing angle
-        SlantPathAttenuationResult result_1, result_2;
-        double beta_graze__rad = PI / 2;
-        RayTrace(f__ghz, h_G__km, h_1__km, beta_graze__rad, config, &result_1);
-        RayTrace(f__ghz, h_G__km, h_2__km, beta_graze__rad, config, &result_2);
+    if (beta_1__rad > PI / 2)
+    {
+        // negative elevation angle
+        // find h_G and then trace in each direction with grazing angle
+        // see Section 2.2.2
+        double h_G__km = GrazingHeight(h_1__km, beta_1__rad, geometry);
 
-        result->angle__rad = result_2.angle__rad;
-        result->A_gas__db = result_1.A_gas__db + result_2.A_gas__db;
-        result->a__km = result_1.a__km + result_2.a__km;
-        result->bending__rad = result_1.bending__rad + result_2.bending__rad;
-        result->delta_L__km = result_1.delta_L__km + result_2.delta_L__km;
+        profiles[0] = GetLayerProfile(0, h_G__km, h_1__km, geometry);
+        profiles[1] = GetLayerProfile(0, h_G__km, h_2__km, geometry);
+        lanes = 2;
     }
     else
     {
-        RayTrace(f__ghz, h_1__km, h_2__km, beta_1__rad, config, result);
+        profiles[0] = GetLayerProfile(0, h_1__km, h_2__km, geometry);
+        beta_lanes__rad[0] = beta_1__rad;
+        lanes = 1;
+    }
+
+    const LayerProfile* layers[2] = { profiles[0].get(), profiles[1].get() };
+
+    SlantPathAttenuationResult traced[2];
+    RayTraceLanes(lanes, layers, beta_lanes__rad, traced, nullptr);
+
+    if (lanes == 2)
+    {
+        result->angle__rad = traced[1].angle__rad;
+        result->A_gas__db = traced[0].A_gas__db + traced[1].A_gas__db;
+        result->a__km = traced[0].a__km + traced[1].a__km;
+        result->bending__rad = traced[0].bending__rad + traced[1].bending__rad;
+        result->delta_L__km = traced[0].delta_L__km + traced[1].delta_L__km;
     }
+    else
+        *result = traced[0];
 
     return 0;
 }
\ No newline at end of file
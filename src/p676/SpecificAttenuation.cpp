@@ -66,4 +66,50 @@ double WaterVapourSpecificAttenuation(double f__ghz, double T__kelvin, double e_
     double gamma_w = 0.1820 * f__ghz * N_w;
 
     return gamma_w;
+}
+
+/*=============================================================================
+ |
+ |  Description:  The specific gaseous attenuation due to dry air and
+ |                water vapour at several frequencies, in dB/km.  The
+ |                spectral lines are summed for every frequency at once,
+ |                and each value is identical to SpecificAttenuation() at
+ |                its frequency.
+ |
+ |        Input:  N             - Number of frequencies
+ |                f__ghz        - Frequencies, in GHz
+ |                T__kelvin     - Temperature, in Kelvin
+ |                e__hPa        - Water vapour partial pressure, in hPa
+ |                p__hPa        - Dry air pressure, in hPa
+ |
+ |      Outputs:  gamma         - Specific gaseous attenuation at each
+ |                                frequency, in dB/km
+ |
+ |      Returns:  [void]
+ |
+ *===========================================================================*/
+void SpecificAttenuationSweep(int N, const double* f__ghz, double T__kelvin, double e__hPa, double p__hPa,
+    double* gamma)
+{
+    // line windows are chosen per frequency
+    if (GetLineWindowTolerance() > 0)
+    {
+        for (int k = 0; k < N; k++)
+            gamma[k] = SpecificAttenuation(f__ghz[k], T__kelvin, e__hPa, p__hPa);
+
+        return;
+    }
+
+    vector<double> N_o(N), N_w(N);
+    OxygenRefractivitySweep(N, f__ghz, T__kelvin, e__hPa, p__hPa, N_o.data());
+    WaterVapourRefractivitySweep(N, f__ghz, T__kelvin, e__hPa, p__hPa, N_w.data());
+
+    for (int k = 0; k < N; k++)
+    {
+        // partial Eqn 1
+        double gamma_o = 0.1820 * f__ghz[k] * N_o[k];
+        double gamma_w = 0.1820 * f__ghz[k] * N_w[k];
+
+        gamma[k] = gamma_o + gamma_w;   // [Eqn 1]
+    }
 }
\ No newline at end of file